@@ -28,6 +28,7 @@
 #ifndef MAP_H
 #define MAP_H
 
+#include <stddef.h>
 #include <stdint.h>
 
 #ifdef __cplusplus
@@ -75,6 +76,18 @@ typedef struct
   // Max distance at which we care about obstacles, for constructing
   // likelihood field
   double max_occ_dist;
+
+  // Gaussian likelihood exp(-occ_dist^2 / (2 sigma^2)) of a beam ending
+  // in each cell, kept apart from the cells so the sensor model reads
+  // 4 bytes per beam
+  float *likelihood;
+
+  // The sigma the likelihood field was built for; 0 if out of date
+  double likelihood_sigma;
+
+  // Cache file the cells and likelihood field are mapped from, if any
+  void *cache;
+  size_t cache_size;
   
 } map_t;
 
@@ -102,6 +115,35 @@ int map_load_occ(map_t *map, const char *filename, double scale, int negate);
 // Update the cspace distances
 void map_update_cspace(map_t *map, double max_occ_dist);
 
+// Update the cspace distances, splitting the work over num_threads threads
+void map_update_cspace_threads(map_t *map, double max_occ_dist, int num_threads);
+
+// Update the likelihood field from the cspace distances, if it was
+// not built for this sigma already
+void map_update_likelihood(map_t *map, double sigma_hit);
+
+
+/**************************************************************************
+ * Cache functions
+ **************************************************************************/
+
+// Key of the cspace and likelihood field of a map, for naming cache files
+uint64_t map_cache_key(map_t *map, double max_occ_dist, double sigma_hit);
+
+// Map the cspace distances, likelihood field and free cells of the map
+// from a cache file; the free cells are (i, j) pairs that stay valid
+// until the map is freed.  Returns 0 on success, -1 if the file is
+// missing or was built for another map or other parameters.
+int map_cache_load(map_t *map, const char *filename, double max_occ_dist, double sigma_hit,
+                   const int **free_space, int *free_count);
+
+// Write the cspace distances, likelihood field and free cells of the
+// map to a cache file.  Returns 0 on success, -1 on failure.
+int map_cache_save(map_t *map, const char *filename, const int *free_space, int free_count);
+
+// Does the pointer point into the cache file mapped by the map
+int map_cache_owns(map_t *map, const void *ptr);
+
 
 /**************************************************************************
  * Range functions
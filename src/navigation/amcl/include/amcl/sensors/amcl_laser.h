@@ -29,7 +29,11 @@
 #ifndef AMCL_LASER_H
 #define AMCL_LASER_H
 
+#include <vector>
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
 #include "amcl_sensor.h"
+#include "amcl_worker_pool.h"
 #include "../map/map.h"
 
 namespace amcl
@@ -86,6 +90,11 @@ class AMCLLaser : public AMCLSensor
 					   double beam_skip_threshold, 
 					   double beam_skip_error_threshold);
 
+  // Build the distance field and weight the samples of the likelihood
+  // field models on num_threads threads (the calling thread included);
+  // call before setting the model
+  public: void SetModelThreads(int num_threads);
+
   // Update the filter based on the sensor model.  Returns true if the
   // filter has been updated.
   public: virtual bool UpdateSensor(pf_t *pf, AMCLSensorData *data);
@@ -107,6 +116,35 @@ class AMCLLaser : public AMCLSensor
 
   private: void reallocTempData(int max_samples, int max_obs);
 
+  // Find the endpoints, in the laser frame, of the beams the likelihood
+  // field models use; returns the number of beams
+  private: int ComputeBeamEnds(AMCLLaserData *data, int step);
+
+  // Map cell hit by each beam for one pose, -1 if off the map
+  private: void ComputeBeamCells(const pf_vector_t& pose, int beam_count, int *cells);
+
+  // Scratch space and accumulators of the thread weighting one chunk of
+  // the samples
+  private: struct ParticleChunk
+  {
+    std::vector<int> beam_cells;
+    std::vector<int> obs_count;
+    double total_weight;
+  };
+
+  // Weights the samples [first, last) of a chunk
+  private: typedef boost::function<void(ParticleChunk&, int, int)> chunk_fn_t;
+
+  private: double RunChunks(int sample_count, const chunk_fn_t& fn);
+  private: void RunChunk(int sample_count, unsigned int chunk_count, const chunk_fn_t& fn,
+                         unsigned int chunk);
+
+  private: void LikelihoodFieldWeights(AMCLLaserData *data, pf_sample_set_t* set, int beam_count,
+                                       ParticleChunk& chunk, int first, int last);
+  private: void LikelihoodFieldProbWeights(AMCLLaserData *data, pf_sample_set_t* set, int beam_count,
+                                           bool do_beamskip, ParticleChunk& chunk, int first, int last);
+  private: void BeamSkipWeights(pf_sample_set_t* set, bool error, ParticleChunk& chunk, int first, int last);
+
   private: laser_model_t model_type;
 
   // Current data timestamp
@@ -134,6 +172,22 @@ class AMCLLaser : public AMCLSensor
   private: int max_obs;
   private: double **temp_obs;
 
+  // Beam endpoints in the laser frame and the index of each beam in
+  // the scan, kept between scans to avoid reallocating them
+  private: std::vector<double> beam_x;
+  private: std::vector<double> beam_y;
+  private: std::vector<int> beam_index;
+
+  // Beam skipping counts and mask, kept between scans
+  private: std::vector<int> obs_count;
+  private: std::vector<bool> obs_mask;
+
+  // Threads and per thread scratch for weighting the samples; copies of
+  // this laser share the threads
+  private: int model_threads;
+  private: boost::shared_ptr<AMCLWorkerPool> workers;
+  private: std::vector<ParticleChunk> chunks;
+
   // Laser model params
   //
   // Mixture params for the components of the model; must sum to 1
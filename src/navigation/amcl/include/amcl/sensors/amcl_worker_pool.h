@@ -0,0 +1,69 @@
+/*
+ *  Player - One Hell of a Robot Server
+ *  Copyright (C) 2000  Brian Gerkey et al.
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+///////////////////////////////////////////////////////////////////////////
+//
+// Desc: Fixed pool of threads that run indexed jobs for the sensor models
+//
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef AMCL_WORKER_POOL_H
+#define AMCL_WORKER_POOL_H
+
+#include <vector>
+#include <boost/function.hpp>
+#include <boost/thread.hpp>
+
+namespace amcl
+{
+
+// Runs job(i) for i in [0, count) on the pool threads and the calling
+// thread, so a pool of n threads uses up to n + 1 cores
+class AMCLWorkerPool
+{
+  // Spawn num_threads threads in addition to the calling thread
+  public: explicit AMCLWorkerPool(unsigned int num_threads);
+
+  // Join the threads
+  public: ~AMCLWorkerPool();
+
+  // Run every job and wait for all of them to finish; job must be safe
+  // to call concurrently with different indices
+  public: void Run(unsigned int count, const boost::function<void(unsigned int)>& job);
+
+  public: unsigned int GetNumThreads() const {return threads.size();}
+
+  private: void WorkerThread();
+
+  // Claim and execute jobs until none are left; called with lock held
+  private: void RunJobs(boost::unique_lock<boost::mutex>& lock);
+
+  private: std::vector<boost::thread*> threads;
+  private: boost::mutex mutex;
+  private: boost::condition_variable work_available;
+  private: boost::condition_variable work_done;
+
+  private: const boost::function<void(unsigned int)>* job;
+  private: unsigned int count, next, pending;
+  private: unsigned int generation;
+  private: bool shutdown;
+};
+
+}
+
+#endif
@@ -30,6 +30,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include <sys/mman.h>
 
 #include "map.h"
 
@@ -52,6 +53,13 @@ map_t *map_alloc(void)
   
   // Allocate storage for main map
   map->cells = (map_cell_t*) NULL;
+
+  map->likelihood = (float*) NULL;
+  map->likelihood_sigma = 0;
+  map->max_occ_dist = 0;
+
+  map->cache = NULL;
+  map->cache_size = 0;
   
   return map;
 }
@@ -60,12 +68,42 @@ map_t *map_alloc(void)
 // Destroy a map
 void map_free(map_t *map)
 {
-  free(map->cells);
+  if (!map_cache_owns(map, map->cells))
+    free(map->cells);
+  if (!map_cache_owns(map, map->likelihood))
+    free(map->likelihood);
+  if (map->cache)
+    munmap(map->cache, map->cache_size);
   free(map);
   return;
 }
 
 
+// Update the likelihood field
+void map_update_likelihood(map_t *map, double sigma_hit)
+{
+  int i, n;
+  double z, z_hit_denom;
+
+  if (map->likelihood && map->likelihood_sigma == sigma_hit)
+    return;
+
+  n = map->size_x * map->size_y;
+  if (!map_cache_owns(map, map->likelihood))
+    free(map->likelihood);
+  map->likelihood = (float*) malloc(sizeof(float) * n);
+
+  z_hit_denom = 2 * sigma_hit * sigma_hit;
+  for (i = 0; i < n; i++)
+  {
+    z = map->cells[i].occ_dist;
+    map->likelihood[i] = (float) exp(-(z * z) / z_hit_denom);
+  }
+  map->likelihood_sigma = sigma_hit;
+  return;
+}
+
+
 // Get the cell at the given point
 map_cell_t *map_get_cell(map_t *map, double ox, double oy, double oa)
 {
@@ -0,0 +1,225 @@
+/*
+ *  Player - One Hell of a Robot Server
+ *  Copyright (C) 2000  Brian Gerkey   &  Kasper Stoy
+ *                      gerkey@usc.edu    kaspers@robotics.usc.edu
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+/**************************************************************************
+ * Desc: Cache of the cspace distances and likelihood field on disk
+**************************************************************************/
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "map.h"
+
+#define MAP_CACHE_MAGIC 0x454843414c434d41ULL  // "AMCLCACHE" truncated
+#define MAP_CACHE_VERSION 1
+
+// File layout: this header, the cells, the likelihood field, then
+// free_count (i, j) pairs of free cells
+typedef struct
+{
+  uint64_t magic;
+  uint32_t version;
+  uint32_t cell_bytes;
+  uint64_t key;
+  int32_t size_x, size_y;
+  double scale;
+  double max_occ_dist;
+  double sigma_hit;
+  int32_t free_count;
+  int32_t reserved;
+} map_cache_header_t;
+
+
+static uint64_t hash_bytes(uint64_t hash, const void *data, size_t size)
+{
+  const unsigned char *bytes = (const unsigned char*) data;
+  size_t i;
+
+  // 64 bit FNV-1a
+  for (i = 0; i < size; i++)
+  {
+    hash ^= bytes[i];
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+
+static size_t cache_size(int size_x, int size_y, int free_count)
+{
+  size_t n = (size_t) size_x * size_y;
+  return sizeof(map_cache_header_t) + n * sizeof(map_cell_t) + n * sizeof(float) +
+    (size_t) free_count * 2 * sizeof(int);
+}
+
+
+// Key of the cspace and likelihood field of a map
+uint64_t map_cache_key(map_t *map, double max_occ_dist, double sigma_hit)
+{
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  int i, n;
+  signed char state;
+
+  hash = hash_bytes(hash, &map->size_x, sizeof(map->size_x));
+  hash = hash_bytes(hash, &map->size_y, sizeof(map->size_y));
+  hash = hash_bytes(hash, &map->scale, sizeof(map->scale));
+  hash = hash_bytes(hash, &map->origin_x, sizeof(map->origin_x));
+  hash = hash_bytes(hash, &map->origin_y, sizeof(map->origin_y));
+  hash = hash_bytes(hash, &max_occ_dist, sizeof(max_occ_dist));
+  hash = hash_bytes(hash, &sigma_hit, sizeof(sigma_hit));
+
+  n = map->size_x * map->size_y;
+  for (i = 0; i < n; i++)
+  {
+    state = (signed char) map->cells[i].occ_state;
+    hash = hash_bytes(hash, &state, 1);
+  }
+  return hash;
+}
+
+
+// Does ptr point into the cache file mapped by the map
+int map_cache_owns(map_t *map, const void *ptr)
+{
+  const char *begin = (const char*) map->cache;
+  return map->cache && (const char*) ptr >= begin && (const char*) ptr < begin + map->cache_size;
+}
+
+
+// Map the cells, likelihood field and free cells from a cache file
+int map_cache_load(map_t *map, const char *filename, double max_occ_dist, double sigma_hit,
+                   const int **free_space, int *free_count)
+{
+  int fd;
+  struct stat st;
+  void *data;
+  const map_cache_header_t *header;
+  char *cells;
+  size_t n;
+
+  if (map->cache)
+    return -1;
+
+  fd = open(filename, O_RDONLY);
+  if (fd < 0)
+    return -1;
+
+  if (fstat(fd, &st) != 0 || (size_t) st.st_size < sizeof(map_cache_header_t))
+  {
+    close(fd);
+    return -1;
+  }
+
+  // Private, so that updating the cspace later does not touch the file
+  data = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED)
+    return -1;
+
+  header = (const map_cache_header_t*) data;
+  if (header->magic != MAP_CACHE_MAGIC ||
+      header->version != MAP_CACHE_VERSION ||
+      header->cell_bytes != sizeof(map_cell_t) ||
+      header->key != map_cache_key(map, max_occ_dist, sigma_hit) ||
+      header->size_x != map->size_x || header->size_y != map->size_y ||
+      header->scale != map->scale ||
+      header->max_occ_dist != max_occ_dist ||
+      header->sigma_hit != sigma_hit ||
+      header->free_count < 0 ||
+      (size_t) st.st_size != cache_size(header->size_x, header->size_y, header->free_count))
+  {
+    munmap(data, st.st_size);
+    return -1;
+  }
+
+  n = (size_t) map->size_x * map->size_y;
+  cells = (char*) data + sizeof(map_cache_header_t);
+
+  free(map->cells);
+  free(map->likelihood);
+  map->cache = data;
+  map->cache_size = st.st_size;
+  map->cells = (map_cell_t*) cells;
+  map->likelihood = (float*) (cells + n * sizeof(map_cell_t));
+  map->max_occ_dist = max_occ_dist;
+  map->likelihood_sigma = sigma_hit;
+
+  *free_space = (const int*) (cells + n * (sizeof(map_cell_t) + sizeof(float)));
+  *free_count = header->free_count;
+  return 0;
+}
+
+
+// Write the cells, likelihood field and free cells to a cache file
+int map_cache_save(map_t *map, const char *filename, const int *free_space, int free_count)
+{
+  map_cache_header_t header;
+  char *tmpname;
+  FILE *file;
+  size_t n;
+  int ok;
+
+  if (!map->likelihood || map->likelihood_sigma == 0)
+    return -1;
+
+  memset(&header, 0, sizeof(header));
+  header.magic = MAP_CACHE_MAGIC;
+  header.version = MAP_CACHE_VERSION;
+  header.cell_bytes = sizeof(map_cell_t);
+  header.key = map_cache_key(map, map->max_occ_dist, map->likelihood_sigma);
+  header.size_x = map->size_x;
+  header.size_y = map->size_y;
+  header.scale = map->scale;
+  header.max_occ_dist = map->max_occ_dist;
+  header.sigma_hit = map->likelihood_sigma;
+  header.free_count = free_count;
+
+  // Write to a temporary file and rename it, so that a reader never
+  // sees a partly written cache
+  tmpname = (char*) malloc(strlen(filename) + 32);
+  sprintf(tmpname, "%s.%d.tmp", filename, (int) getpid());
+  file = fopen(tmpname, "wb");
+  if (!file)
+  {
+    free(tmpname);
+    return -1;
+  }
+
+  n = (size_t) map->size_x * map->size_y;
+  ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+    fwrite(map->cells, sizeof(map_cell_t), n, file) == n &&
+    fwrite(map->likelihood, sizeof(float), n, file) == n &&
+    (free_count == 0 || fwrite(free_space, 2 * sizeof(int), free_count, file) == (size_t) free_count);
+  ok = (fclose(file) == 0) && ok;
+
+  if (!ok || rename(tmpname, filename) != 0)
+  {
+    unlink(tmpname);
+    free(tmpname);
+    return -1;
+  }
+  free(tmpname);
+  return 0;
+}
@@ -19,160 +19,137 @@
  *
  */
 
-#include <queue>
+#include <algorithm>
+#include <vector>
 #include <math.h>
 #include <stdlib.h>
 #include <string.h>
+#include <boost/bind.hpp>
+#include <boost/function.hpp>
+#include <boost/thread.hpp>
 #include "map.h"
 
-class CellData
+// Call fn(first, last) on num_threads disjoint ranges covering [0, count)
+static void run_ranges(int count, int num_threads, const boost::function<void(int, int)>& fn)
 {
-  public:
-    map_t* map_;
-    unsigned int i_, j_;
-    unsigned int src_i_, src_j_;
-};
-
-class CachedDistanceMap
-{
-  public:
-    CachedDistanceMap(double scale, double max_dist) : 
-      distances_(NULL), scale_(scale), max_dist_(max_dist) 
-    {
-      cell_radius_ = max_dist / scale;
-      distances_ = new double *[cell_radius_+2];
-      for(int i=0; i<=cell_radius_+1; i++)
-      {
-	distances_[i] = new double[cell_radius_+2];
-        for(int j=0; j<=cell_radius_+1; j++)
-	{
-	  distances_[i][j] = sqrt(i*i + j*j);
-	}
-      }
-    }
-    ~CachedDistanceMap()
-    {
-      if(distances_)
-      {
-	for(int i=0; i<=cell_radius_+1; i++)
-	  delete[] distances_[i];
-	delete[] distances_;
-      }
-    }
-    double** distances_;
-    double scale_;
-    double max_dist_;
-    int cell_radius_;
-};
-
+  if(num_threads <= 1 || count < num_threads)
+  {
+    fn(0, count);
+    return;
+  }
 
-bool operator<(const CellData& a, const CellData& b)
-{
-  return a.map_->cells[MAP_INDEX(a.map_, a.i_, a.j_)].occ_dist > a.map_->cells[MAP_INDEX(b.map_, b.i_, b.j_)].occ_dist;
+  boost::thread_group threads;
+  for(int t = 1; t < num_threads; t++)
+    threads.create_thread(boost::bind(fn, (long)count * t / num_threads, (long)count * (t + 1) / num_threads));
+  fn(0, count / num_threads);
+  threads.join_all();
 }
 
-CachedDistanceMap*
-get_distance_map(double scale, double max_dist)
+// Distance along j from each cell of the columns [first, last) to the
+// nearest obstacle in the same column, capped at cap
+static void column_distances(map_t* map, int* g, int cap, int first, int last)
 {
-  static CachedDistanceMap* cdm = NULL;
+  int i, j;
 
-  if(!cdm || (cdm->scale_ != scale) || (cdm->max_dist_ != max_dist))
+  for(j = 0; j < map->size_y; j++)
   {
-    if(cdm)
-      delete cdm;
-    cdm = new CachedDistanceMap(scale, max_dist);
+    for(i = first; i < last; i++)
+    {
+      if(map->cells[MAP_INDEX(map, i, j)].occ_state == +1)
+        g[MAP_INDEX(map, i, j)] = 0;
+      else if(j == 0)
+        g[MAP_INDEX(map, i, j)] = cap;
+      else
+        g[MAP_INDEX(map, i, j)] = std::min(g[MAP_INDEX(map, i, j - 1)] + 1, cap);
+    }
+  }
+  for(j = map->size_y - 2; j >= 0; j--)
+  {
+    for(i = first; i < last; i++)
+    {
+      if(g[MAP_INDEX(map, i, j + 1)] < g[MAP_INDEX(map, i, j)])
+        g[MAP_INDEX(map, i, j)] = g[MAP_INDEX(map, i, j + 1)] + 1;
+    }
   }
-
-  return cdm;
 }
 
-void enqueue(map_t* map, unsigned int i, unsigned int j, 
-	     unsigned int src_i, unsigned int src_j,
-	     std::priority_queue<CellData>& Q,
-	     CachedDistanceMap* cdm,
-	     unsigned char* marked)
+// Squared distance to the nearest obstacle for the rows [first, last),
+// from the lower envelope of the parabolas (i - k)^2 + g(k)^2 of each row
+// (Felzenszwalb and Huttenlocher, "Distance Transforms of Sampled
+// Functions"). Sets occ_dist, clamped to max_occ_dist beyond cell_radius.
+static void row_distances(map_t* map, const int* g, int cell_radius, int first, int last)
 {
-  if(marked[MAP_INDEX(map, i, j)])
-    return;
-
-  unsigned int di = abs(i - src_i);
-  unsigned int dj = abs(j - src_j);
-  double distance = cdm->distances_[di][dj];
+  int n = map->size_x;
+  std::vector<double> f(n), z(n + 1);
+  std::vector<int> v(n);
+  int i, j, k;
+  double s, d;
 
-  if(distance > cdm->cell_radius_)
-    return;
-
-  map->cells[MAP_INDEX(map, i, j)].occ_dist = distance * map->scale;
-
-  CellData cell;
-  cell.map_ = map;
-  cell.i_ = i;
-  cell.j_ = j;
-  cell.src_i_ = src_i;
-  cell.src_j_ = src_j;
-
-  Q.push(cell);
+  for(j = first; j < last; j++)
+  {
+    const int* row = g + MAP_INDEX(map, 0, j);
+    for(i = 0; i < n; i++)
+      f[i] = (double)row[i] * row[i];
+
+    k = 0;
+    v[0] = 0;
+    z[0] = -HUGE_VAL;
+    z[1] = HUGE_VAL;
+    for(i = 1; i < n; i++)
+    {
+      s = ((f[i] + (double)i * i) - (f[v[k]] + (double)v[k] * v[k])) / (2.0 * (i - v[k]));
+      while(s <= z[k])
+      {
+        k--;
+        s = ((f[i] + (double)i * i) - (f[v[k]] + (double)v[k] * v[k])) / (2.0 * (i - v[k]));
+      }
+      k++;
+      v[k] = i;
+      z[k] = s;
+      z[k + 1] = HUGE_VAL;
+    }
 
-  marked[MAP_INDEX(map, i, j)] = 1;
+    k = 0;
+    for(i = 0; i < n; i++)
+    {
+      while(z[k + 1] < i)
+        k++;
+      d = sqrt((double)(i - v[k]) * (i - v[k]) + f[v[k]]);
+      if(d > cell_radius)
+        map->cells[MAP_INDEX(map, i, j)].occ_dist = map->max_occ_dist;
+      else
+        map->cells[MAP_INDEX(map, i, j)].occ_dist = d * map->scale;
+    }
+  }
 }
 
 // Update the cspace distance values
 void map_update_cspace(map_t *map, double max_occ_dist)
 {
-  unsigned char* marked;
-  std::priority_queue<CellData> Q;
-
-  marked = new unsigned char[map->size_x*map->size_y];
-  memset(marked, 0, sizeof(unsigned char) * map->size_x*map->size_y);
+  map_update_cspace_threads(map, max_occ_dist, 1);
+}
 
+// Update the cspace distance values with an exact Euclidean distance
+// transform, separated into a pass over the columns and one over the rows
+void map_update_cspace_threads(map_t *map, double max_occ_dist, int num_threads)
+{
   map->max_occ_dist = max_occ_dist;
+  map->likelihood_sigma = 0;
 
-  CachedDistanceMap* cdm = get_distance_map(map->scale, map->max_occ_dist);
+  if(map->size_x <= 0 || map->size_y <= 0)
+    return;
 
-  // Enqueue all the obstacle cells
-  CellData cell;
-  cell.map_ = map;
-  for(int i=0; i<map->size_x; i++)
-  {
-    cell.src_i_ = cell.i_ = i;
-    for(int j=0; j<map->size_y; j++)
-    {
-      if(map->cells[MAP_INDEX(map, i, j)].occ_state == +1)
-      {
-	map->cells[MAP_INDEX(map, i, j)].occ_dist = 0.0;
-	cell.src_j_ = cell.j_ = j;
-	marked[MAP_INDEX(map, i, j)] = 1;
-	Q.push(cell);
-      }
-      else
-	map->cells[MAP_INDEX(map, i, j)].occ_dist = max_occ_dist;
-    }
-  }
+  // Cells further away than this are left at max_occ_dist
+  int cell_radius = max_occ_dist / map->scale;
 
-  while(!Q.empty())
-  {
-    CellData current_cell = Q.top();
-    if(current_cell.i_ > 0)
-      enqueue(map, current_cell.i_-1, current_cell.j_, 
-	      current_cell.src_i_, current_cell.src_j_,
-	      Q, cdm, marked);
-    if(current_cell.j_ > 0)
-      enqueue(map, current_cell.i_, current_cell.j_-1, 
-	      current_cell.src_i_, current_cell.src_j_,
-	      Q, cdm, marked);
-    if((int)current_cell.i_ < map->size_x - 1)
-      enqueue(map, current_cell.i_+1, current_cell.j_, 
-	      current_cell.src_i_, current_cell.src_j_,
-	      Q, cdm, marked);
-    if((int)current_cell.j_ < map->size_y - 1)
-      enqueue(map, current_cell.i_, current_cell.j_+1, 
-	      current_cell.src_i_, current_cell.src_j_,
-	      Q, cdm, marked);
-
-    Q.pop();
-  }
+  // Capping the column distances just beyond the radius keeps the
+  // squared distances small and leaves every distance within it exact
+  std::vector<int> g(map->size_x * map->size_y);
 
-  delete[] marked;
+  run_ranges(map->size_x, num_threads,
+             boost::bind(column_distances, map, &g[0], cell_radius + 1, _1, _2));
+  run_ranges(map->size_y, num_threads,
+             boost::bind(row_distances, map, &g[0], cell_radius, _1, _2));
 }
 
 #if 0
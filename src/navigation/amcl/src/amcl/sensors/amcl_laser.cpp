@@ -32,6 +32,7 @@
 #include <stdlib.h>
 #include <assert.h>
 #include <unistd.h>
+#include <boost/bind.hpp>
 
 #include "amcl_laser.h"
 
@@ -41,7 +42,7 @@ using namespace amcl;
 // Default constructor
 AMCLLaser::AMCLLaser(size_t max_beams, map_t* map) : AMCLSensor(), 
 						     max_samples(0), max_obs(0), 
-						     temp_obs(NULL)
+						     temp_obs(NULL), model_threads(1)
 {
   this->time = 0.0;
 
@@ -91,7 +92,11 @@ AMCLLaser::SetModelLikelihoodField(double z_hit,
   this->z_rand = z_rand;
   this->sigma_hit = sigma_hit;
 
-  map_update_cspace(this->map, max_occ_dist);
+  // A field loaded from a cache file is kept if it was built for these parameters
+  if (!this->map->likelihood || this->map->likelihood_sigma != sigma_hit ||
+      this->map->max_occ_dist != max_occ_dist)
+    map_update_cspace_threads(this->map, max_occ_dist, this->model_threads);
+  map_update_likelihood(this->map, sigma_hit);
 }
 
 void 
@@ -112,7 +117,11 @@ AMCLLaser::SetModelLikelihoodFieldProb(double z_hit,
   this->beam_skip_distance = beam_skip_distance;
   this->beam_skip_threshold = beam_skip_threshold;
   this->beam_skip_error_threshold = beam_skip_error_threshold;
-  map_update_cspace(this->map, max_occ_dist);
+  // A field loaded from a cache file is kept if it was built for these parameters
+  if (!this->map->likelihood || this->map->likelihood_sigma != sigma_hit ||
+      this->map->max_occ_dist != max_occ_dist)
+    map_update_cspace_threads(this->map, max_occ_dist, this->model_threads);
+  map_update_likelihood(this->map, sigma_hit);
 }
 
 
@@ -210,78 +219,167 @@ double AMCLLaser::BeamModel(AMCLLaserData *data, pf_sample_set_t* set)
   return(total_weight);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// The beams used do not depend on the particle, so their endpoints are
+// found once per scan and only rotated into each particle's pose
+int AMCLLaser::ComputeBeamEnds(AMCLLaserData *data, int step)
+{
+  int i, beam_ind, count;
+  double obs_range, obs_bearing;
+
+  this->beam_x.resize(data->range_count);
+  this->beam_y.resize(data->range_count);
+  this->beam_index.resize(data->range_count);
+
+  count = 0;
+  for (i = 0, beam_ind = 0; i < data->range_count; i += step, beam_ind++)
+  {
+    obs_range = data->ranges[i][0];
+    obs_bearing = data->ranges[i][1];
+
+    // This model ignores max range readings
+    if(obs_range >= data->range_max)
+      continue;
+
+    // Check for NaN
+    if(obs_range != obs_range)
+      continue;
+
+    this->beam_x[count] = obs_range * cos(obs_bearing);
+    this->beam_y[count] = obs_range * sin(obs_bearing);
+    this->beam_index[count] = beam_ind;
+    count++;
+  }
+  return count;
+}
+
+void AMCLLaser::ComputeBeamCells(const pf_vector_t& pose, int beam_count, int *cells)
+{
+  map_t *map = this->map;
+  double c = cos(pose.v[2]);
+  double s = sin(pose.v[2]);
+  const double *bx = &this->beam_x[0];
+  const double *by = &this->beam_y[0];
+
+  // Free of branches on the data so it can be vectorized
+  for (int i = 0; i < beam_count; i++)
+  {
+    // Compute the endpoint of the beam
+    double hx = pose.v[0] + c * bx[i] - s * by[i];
+    double hy = pose.v[1] + s * bx[i] + c * by[i];
+
+    // Convert to map grid coords.
+    int mi = MAP_GXWX(map, hx);
+    int mj = MAP_GYWY(map, hy);
+    cells[i] = MAP_VALID(map, mi, mj) ? MAP_INDEX(map, mi, mj) : -1;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Split the samples into one contiguous chunk per thread and run fn on
+// each; returns the sum of the chunks' total_weight
+double AMCLLaser::RunChunks(int sample_count, const chunk_fn_t& fn)
+{
+  unsigned int chunk_count = this->workers ? this->workers->GetNumThreads() + 1 : 1;
+  if(this->chunks.size() != chunk_count)
+    this->chunks.resize(chunk_count);
+
+  for(unsigned int c = 0; c < chunk_count; c++)
+    this->chunks[c].total_weight = 0.0;
+
+  boost::function<void(unsigned int)> job =
+    boost::bind(&AMCLLaser::RunChunk, this, sample_count, chunk_count, boost::cref(fn), _1);
+  if(this->workers)
+    this->workers->Run(chunk_count, job);
+  else
+    job(0);
+
+  double total_weight = 0.0;
+  for(unsigned int c = 0; c < chunk_count; c++)
+    total_weight += this->chunks[c].total_weight;
+  return total_weight;
+}
+
+void AMCLLaser::RunChunk(int sample_count, unsigned int chunk_count, const chunk_fn_t& fn,
+                         unsigned int chunk)
+{
+  int first = (long)sample_count * chunk / chunk_count;
+  int last = (long)sample_count * (chunk + 1) / chunk_count;
+  fn(this->chunks[chunk], first, last);
+}
+
+void AMCLLaser::SetModelThreads(int num_threads)
+{
+  this->model_threads = num_threads;
+  if(num_threads > 1)
+    this->workers.reset(new AMCLWorkerPool(num_threads - 1));
+  else
+    this->workers.reset();
+}
+
 double AMCLLaser::LikelihoodFieldModel(AMCLLaserData *data, pf_sample_set_t* set)
 {
   AMCLLaser *self;
-  int i, j, step;
-  double z, pz;
-  double p;
-  double obs_range, obs_bearing;
-  double total_weight;
-  pf_sample_t *sample;
-  pf_vector_t pose;
-  pf_vector_t hit;
+  int step, beam_count;
 
   self = (AMCLLaser*) data->sensor;
 
-  total_weight = 0.0;
+  step = (data->range_count - 1) / (self->max_beams - 1);
 
-  // Compute the sample weights
-  for (j = 0; j < set->sample_count; j++)
-  {
-    sample = set->samples + j;
-    pose = sample->pose;
+  // Step size must be at least 1
+  if(step < 1)
+    step = 1;
 
-    // Take account of the laser pose relative to the robot
-    pose = pf_vector_coord_add(self->laser_pose, pose);
+  beam_count = self->ComputeBeamEnds(data, step);
 
-    p = 1.0;
+  // Compute the sample weights
+  return self->RunChunks(set->sample_count,
+                         boost::bind(&AMCLLaser::LikelihoodFieldWeights, self, data, set, beam_count, _1, _2, _3));
+}
 
-    // Pre-compute a couple of things
-    double z_hit_denom = 2 * self->sigma_hit * self->sigma_hit;
-    double z_rand_mult = 1.0/data->range_max;
+void AMCLLaser::LikelihoodFieldWeights(AMCLLaserData *data, pf_sample_set_t* set, int beam_count,
+                                       ParticleChunk& chunk, int first, int last)
+{
+  int i, j;
+  double pz;
+  double p;
+  pf_sample_t *sample;
+  pf_vector_t pose;
 
-    step = (data->range_count - 1) / (self->max_beams - 1);
+  // Pre-compute a couple of things
+  double z_hit_denom = 2 * this->sigma_hit * this->sigma_hit;
+  double z_rand_mult = 1.0/data->range_max;
 
-    // Step size must be at least 1
-    if(step < 1)
-      step = 1;
+  // Off-map penalized as max distance
+  double max_dist_prob = exp(-(this->map->max_occ_dist * this->map->max_occ_dist) / z_hit_denom);
+  const float *likelihood = this->map->likelihood;
 
-    for (i = 0; i < data->range_count; i += step)
-    {
-      obs_range = data->ranges[i][0];
-      obs_bearing = data->ranges[i][1];
+  chunk.beam_cells.resize(beam_count + 1);
+  int *cells = &chunk.beam_cells[0];
 
-      // This model ignores max range readings
-      if(obs_range >= data->range_max)
-        continue;
+  for (j = first; j < last; j++)
+  {
+    sample = set->samples + j;
+    pose = sample->pose;
 
-      // Check for NaN
-      if(obs_range != obs_range)
-        continue;
+    // Take account of the laser pose relative to the robot
+    pose = pf_vector_coord_add(this->laser_pose, pose);
 
-      pz = 0.0;
+    this->ComputeBeamCells(pose, beam_count, cells);
 
-      // Compute the endpoint of the beam
-      hit.v[0] = pose.v[0] + obs_range * cos(pose.v[2] + obs_bearing);
-      hit.v[1] = pose.v[1] + obs_range * sin(pose.v[2] + obs_bearing);
+    p = 1.0;
 
-      // Convert to map grid coords.
-      int mi, mj;
-      mi = MAP_GXWX(self->map, hit.v[0]);
-      mj = MAP_GYWY(self->map, hit.v[1]);
-      
-      // Part 1: Get distance from the hit to closest obstacle.
-      // Off-map penalized as max distance
-      if(!MAP_VALID(self->map, mi, mj))
-        z = self->map->max_occ_dist;
-      else
-        z = self->map->cells[MAP_INDEX(self->map,mi,mj)].occ_dist;
-      // Gaussian model
+    for (i = 0; i < beam_count; i++)
+    {
+      // Part 1: Gaussian model of the distance from the hit to the
+      // closest obstacle, precomputed per cell
       // NOTE: this should have a normalization of 1/(sqrt(2pi)*sigma)
-      pz += self->z_hit * exp(-(z * z) / z_hit_denom);
+      if(cells[i] < 0)
+        pz = this->z_hit * max_dist_prob;
+      else
+        pz = this->z_hit * likelihood[cells[i]];
       // Part 2: random measurements
-      pz += self->z_rand * z_rand_mult;
+      pz += this->z_rand * z_rand_mult;
 
       // TODO: outlier rejection for short readings
 
@@ -294,46 +392,31 @@ double AMCLLaser::LikelihoodFieldModel(AMCLLaserData *data, pf_sample_set_t* set
     }
 
     sample->weight *= p;
-    total_weight += sample->weight;
+    chunk.total_weight += sample->weight;
   }
-
-  return(total_weight);
 }
 
 double AMCLLaser::LikelihoodFieldModelProb(AMCLLaserData *data, pf_sample_set_t* set)
 {
   AMCLLaser *self;
-  int i, j, step;
-  double z, pz;
-  double log_p;
-  double obs_range, obs_bearing;
+  int step, beam_count;
   double total_weight;
-  pf_sample_t *sample;
-  pf_vector_t pose;
-  pf_vector_t hit;
 
   self = (AMCLLaser*) data->sensor;
 
-  total_weight = 0.0;
-
   step = ceil((data->range_count) / static_cast<double>(self->max_beams)); 
   
   // Step size must be at least 1
   if(step < 1)
     step = 1;
 
-  // Pre-compute a couple of things
-  double z_hit_denom = 2 * self->sigma_hit * self->sigma_hit;
-  double z_rand_mult = 1.0/data->range_max;
-
-  double max_dist_prob = exp(-(self->map->max_occ_dist * self->map->max_occ_dist) / z_hit_denom);
+  beam_count = self->ComputeBeamEnds(data, step);
 
   //Beam skipping - ignores beams for which a majoirty of particles do not agree with the map
   //prevents correct particles from getting down weighted because of unexpected obstacles 
   //such as humans 
 
   bool do_beamskip = self->do_beamskip;
-  double beam_skip_distance = self->beam_skip_distance;
   double beam_skip_threshold = self->beam_skip_threshold;
   
   //we only do beam skipping if the filter has converged 
@@ -341,14 +424,6 @@ double AMCLLaser::LikelihoodFieldModelProb(AMCLLaserData *data, pf_sample_set_t*
     do_beamskip = false;
   }
 
-  //we need a count the no of particles for which the beam agreed with the map 
-  int *obs_count = new int[self->max_beams]();
-
-  //we also need a mask of which observations to integrate (to decide which beams to integrate to all particles) 
-  bool *obs_mask = new bool[self->max_beams]();
-  
-  int beam_ind = 0;
-  
   //realloc indicates if we need to reallocate the temp data structure needed to do beamskipping 
   bool realloc = false; 
 
@@ -367,64 +442,111 @@ double AMCLLaser::LikelihoodFieldModelProb(AMCLLaserData *data, pf_sample_set_t*
     }
   }
 
-  // Compute the sample weights
-  for (j = 0; j < set->sample_count; j++)
+  // Compute the sample weights, or only the beam probabilities if we skip beams
+  total_weight = self->RunChunks(set->sample_count,
+                                 boost::bind(&AMCLLaser::LikelihoodFieldProbWeights, self, data, set, beam_count,
+                                             do_beamskip, _1, _2, _3));
+
+  if(do_beamskip){
+    //we need a count the no of particles for which the beam agreed with the map,
+    //summed over the counts of each chunk
+    self->obs_count.assign(self->max_beams, 0);
+    for(unsigned int c = 0; c < self->chunks.size(); c++){
+      for (int beam_ind = 0; beam_ind < self->max_beams; beam_ind++){
+	self->obs_count[beam_ind] += self->chunks[c].obs_count[beam_ind];
+      }
+    }
+
+    //we also need a mask of which observations to integrate (to decide which beams to integrate to all particles) 
+    self->obs_mask.resize(self->max_beams);
+
+    int skipped_beam_count = 0; 
+    int beam_ind;
+    for (beam_ind = 0; beam_ind < self->max_beams; beam_ind++){
+      if((self->obs_count[beam_ind] / static_cast<double>(set->sample_count)) > beam_skip_threshold){
+	self->obs_mask[beam_ind] = true;
+      }
+      else{
+	self->obs_mask[beam_ind] = false;
+	skipped_beam_count++; 
+      }
+    }
+
+    //we check if there is at least a critical number of beams that agreed with the map 
+    //otherwise it probably indicates that the filter converged to a wrong solution
+    //if that's the case we integrate all the beams and hope the filter might converge to 
+    //the right solution
+    bool error = false; 
+
+    if(skipped_beam_count >= (beam_ind * self->beam_skip_error_threshold)){
+      fprintf(stderr, "Over %f%% of the observations were not in the map - pf may have converged to wrong pose - integrating all observations\n", (100 * self->beam_skip_error_threshold));
+      error = true; 
+    }
+
+    total_weight = self->RunChunks(set->sample_count,
+                                   boost::bind(&AMCLLaser::BeamSkipWeights, self, set, error, _1, _2, _3));
+  }
+
+  return(total_weight);
+}
+
+void AMCLLaser::LikelihoodFieldProbWeights(AMCLLaserData *data, pf_sample_set_t* set, int beam_count,
+                                           bool do_beamskip, ParticleChunk& chunk, int first, int last)
+{
+  int i, j, beam_ind;
+  double z, pz;
+  double log_p;
+  pf_sample_t *sample;
+  pf_vector_t pose;
+
+  // Pre-compute a couple of things
+  double z_hit_denom = 2 * this->sigma_hit * this->sigma_hit;
+  double z_rand_mult = 1.0/data->range_max;
+
+  double max_dist_prob = exp(-(this->map->max_occ_dist * this->map->max_occ_dist) / z_hit_denom);
+  const float *likelihood = this->map->likelihood;
+  double beam_skip_distance = this->beam_skip_distance;
+
+  chunk.beam_cells.resize(beam_count + 1);
+  int *cells = &chunk.beam_cells[0];
+  chunk.obs_count.assign(this->max_beams, 0);
+
+  for (j = first; j < last; j++)
   {
     sample = set->samples + j;
     pose = sample->pose;
 
     // Take account of the laser pose relative to the robot
-    pose = pf_vector_coord_add(self->laser_pose, pose);
-
-    log_p = 0;
-    
-    beam_ind = 0;
-    
-    for (i = 0; i < data->range_count; i += step, beam_ind++)
-    {
-      obs_range = data->ranges[i][0];
-      obs_bearing = data->ranges[i][1];
+    pose = pf_vector_coord_add(this->laser_pose, pose);
 
-      // This model ignores max range readings
-      if(obs_range >= data->range_max){
-        continue;
-      }
+    this->ComputeBeamCells(pose, beam_count, cells);
 
-      // Check for NaN
-      if(obs_range != obs_range){
-        continue;
-      }
+    log_p = 0;
 
+    for (i = 0; i < beam_count; i++)
+    {
+      beam_ind = this->beam_index[i];
       pz = 0.0;
 
-      // Compute the endpoint of the beam
-      hit.v[0] = pose.v[0] + obs_range * cos(pose.v[2] + obs_bearing);
-      hit.v[1] = pose.v[1] + obs_range * sin(pose.v[2] + obs_bearing);
-
-      // Convert to map grid coords.
-      int mi, mj;
-      mi = MAP_GXWX(self->map, hit.v[0]);
-      mj = MAP_GYWY(self->map, hit.v[1]);
-      
       // Part 1: Get distance from the hit to closest obstacle.
       // Off-map penalized as max distance
       
-      if(!MAP_VALID(self->map, mi, mj)){
-	pz += self->z_hit * max_dist_prob;
+      if(cells[i] < 0){
+	pz += this->z_hit * max_dist_prob;
       }
       else{
-	z = self->map->cells[MAP_INDEX(self->map,mi,mj)].occ_dist;
+	z = this->map->cells[cells[i]].occ_dist;
 	if(z < beam_skip_distance){
-	  obs_count[beam_ind] += 1;
+	  chunk.obs_count[beam_ind] += 1;
 	}
-	pz += self->z_hit * exp(-(z * z) / z_hit_denom);
+	pz += this->z_hit * likelihood[cells[i]];
       }
        
       // Gaussian model
       // NOTE: this should have a normalization of 1/(sqrt(2pi)*sigma)
       
       // Part 2: random measurements
-      pz += self->z_rand * z_rand_mult;
+      pz += this->z_rand * z_rand_mult;
 
       assert(pz <= 1.0); 
       assert(pz >= 0.0);
@@ -435,60 +557,38 @@ double AMCLLaser::LikelihoodFieldModelProb(AMCLLaserData *data, pf_sample_set_t*
 	log_p += log(pz);
       }
       else{
-	self->temp_obs[j][beam_ind] = pz; 
+	this->temp_obs[j][beam_ind] = pz; 
       }
     }
     if(!do_beamskip){
       sample->weight *= exp(log_p);
-      total_weight += sample->weight;
+      chunk.total_weight += sample->weight;
     }
   }
-  
-  if(do_beamskip){
-    int skipped_beam_count = 0; 
-    for (beam_ind = 0; beam_ind < self->max_beams; beam_ind++){
-      if((obs_count[beam_ind] / static_cast<double>(set->sample_count)) > beam_skip_threshold){
-	obs_mask[beam_ind] = true;
-      }
-      else{
-	obs_mask[beam_ind] = false;
-	skipped_beam_count++; 
-      }
-    }
+}
 
-    //we check if there is at least a critical number of beams that agreed with the map 
-    //otherwise it probably indicates that the filter converged to a wrong solution
-    //if that's the case we integrate all the beams and hope the filter might converge to 
-    //the right solution
-    bool error = false; 
+void AMCLLaser::BeamSkipWeights(pf_sample_set_t* set, bool error, ParticleChunk& chunk, int first, int last)
+{
+  int j, beam_ind;
+  double log_p;
+  pf_sample_t *sample;
 
-    if(skipped_beam_count >= (beam_ind * self->beam_skip_error_threshold)){
-      fprintf(stderr, "Over %f%% of the observations were not in the map - pf may have converged to wrong pose - integrating all observations\n", (100 * self->beam_skip_error_threshold));
-      error = true; 
-    }
+  for (j = first; j < last; j++)
+  {
+    sample = set->samples + j;
 
-    for (j = 0; j < set->sample_count; j++)
-      {
-	sample = set->samples + j;
-	pose = sample->pose;
+    log_p = 0;
 
-	log_p = 0;
+    for (beam_ind = 0; beam_ind < this->max_beams; beam_ind++){
+      if(error || this->obs_mask[beam_ind]){
+	log_p += log(this->temp_obs[j][beam_ind]);
+      }
+    }
 
-	for (beam_ind = 0; beam_ind < self->max_beams; beam_ind++){
-	  if(error || obs_mask[beam_ind]){
-	    log_p += log(self->temp_obs[j][beam_ind]);
-	  }
-	}
-	
-	sample->weight *= exp(log_p);
-	
-	total_weight += sample->weight;
-      }      
-  }
+    sample->weight *= exp(log_p);
 
-  delete [] obs_count; 
-  delete [] obs_mask;
-  return(total_weight);
+    chunk.total_weight += sample->weight;
+  }
 }
 
 void AMCLLaser::reallocTempData(int new_max_samples, int new_max_obs){
@@ -0,0 +1,109 @@
+/*
+ *  Player - One Hell of a Robot Server
+ *  Copyright (C) 2000  Brian Gerkey   &  Kasper Stoy
+ *                      gerkey@usc.edu    kaspers@robotics.usc.edu
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+///////////////////////////////////////////////////////////////////////////
+//
+// Desc: Fixed pool of threads that run indexed jobs for the sensor models
+//
+///////////////////////////////////////////////////////////////////////////
+
+#include "amcl_worker_pool.h"
+
+using namespace amcl;
+
+AMCLWorkerPool::AMCLWorkerPool(unsigned int num_threads) :
+  job(NULL), count(0), next(0), pending(0), generation(0), shutdown(false)
+{
+  for(unsigned int i = 0; i < num_threads; i++)
+    threads.push_back(new boost::thread(boost::bind(&AMCLWorkerPool::WorkerThread, this)));
+}
+
+AMCLWorkerPool::~AMCLWorkerPool()
+{
+  {
+    boost::unique_lock<boost::mutex> lock(mutex);
+    shutdown = true;
+  }
+  work_available.notify_all();
+
+  for(unsigned int i = 0; i < threads.size(); i++)
+  {
+    threads[i]->join();
+    delete threads[i];
+  }
+}
+
+void AMCLWorkerPool::Run(unsigned int count, const boost::function<void(unsigned int)>& job)
+{
+  // Nothing to share, don't pay for the wakeups
+  if(threads.empty() || count <= 1)
+  {
+    for(unsigned int i = 0; i < count; i++)
+      job(i);
+    return;
+  }
+
+  boost::unique_lock<boost::mutex> lock(mutex);
+  this->job = &job;
+  this->count = count;
+  this->next = 0;
+  this->pending = count;
+  this->generation++;
+  work_available.notify_all();
+
+  RunJobs(lock);
+
+  while(this->pending > 0)
+    work_done.wait(lock);
+  this->job = NULL;
+}
+
+void AMCLWorkerPool::RunJobs(boost::unique_lock<boost::mutex>& lock)
+{
+  while(next < count)
+  {
+    unsigned int i = next++;
+    const boost::function<void(unsigned int)>& current_job = *job;
+
+    lock.unlock();
+    current_job(i);
+    lock.lock();
+
+    if(--pending == 0)
+      work_done.notify_all();
+  }
+}
+
+void AMCLWorkerPool::WorkerThread()
+{
+  unsigned int seen_generation = 0;
+  boost::unique_lock<boost::mutex> lock(mutex);
+  while(true)
+  {
+    while(!shutdown && seen_generation == generation)
+      work_available.wait(lock);
+
+    if(shutdown)
+      return;
+
+    seen_generation = generation;
+    RunJobs(lock);
+  }
+}
@@ -229,6 +229,8 @@ class AmclNode
     ros::Timer check_laser_timer_;
 
     int max_beams_, min_particles_, max_particles_;
+    int laser_model_threads_;
+    std::string likelihood_field_cache_dir_;
     double alpha1_, alpha2_, alpha3_, alpha4_, alpha5_;
     double alpha_slow_, alpha_fast_;
     double z_hit_, z_short_, z_max_, z_rand_, sigma_hit_, lambda_short_;
@@ -311,6 +313,8 @@ AmclNode::AmclNode() :
   private_nh_.param("laser_min_range", laser_min_range_, -1.0);
   private_nh_.param("laser_max_range", laser_max_range_, -1.0);
   private_nh_.param("laser_max_beams", max_beams_, 30);
+  private_nh_.param("laser_model_threads", laser_model_threads_, 1);
+  private_nh_.param("likelihood_field_cache_dir", likelihood_field_cache_dir_, std::string(""));
   private_nh_.param("min_particles", min_particles_, 100);
   private_nh_.param("max_particles", max_particles_, 5000);
   private_nh_.param("kld_err", pf_err_, 0.01);
@@ -531,6 +535,7 @@ void AmclNode::reconfigureCB(AMCLConfig &config, uint32_t level)
   delete laser_;
   laser_ = new AMCLLaser(max_beams_, map_);
   ROS_ASSERT(laser_);
+  laser_->SetModelThreads(laser_model_threads_);
   if(laser_model_type_ == LASER_MODEL_BEAM)
     laser_->SetModelBeam(z_hit_, z_short_, z_max_, z_rand_,
                          sigma_hit_, lambda_short_, 0.0);
@@ -690,13 +695,42 @@ AmclNode::handleMapMessage(const nav_msgs::OccupancyGrid& msg)
 
   map_ = convertMap(msg);
 
+  // The likelihood field and free space index of a map seen before are
+  // mapped from the cache file instead of being rebuilt
+  std::string cache_file;
+  bool cache_loaded = false;
+  if(!likelihood_field_cache_dir_.empty() && laser_model_type_ != LASER_MODEL_BEAM)
+  {
+    char key[32];
+    snprintf(key, sizeof(key), "%016llx",
+             (unsigned long long)map_cache_key(map_, laser_likelihood_max_dist_, sigma_hit_));
+    cache_file = likelihood_field_cache_dir_ + "/amcl_" + key + ".cache";
+
+    const int* free_space;
+    int free_count;
+    if(map_cache_load(map_, cache_file.c_str(), laser_likelihood_max_dist_, sigma_hit_,
+                      &free_space, &free_count) == 0)
+    {
+      ROS_INFO("Loaded the likelihood field from %s", cache_file.c_str());
+      cache_loaded = true;
 #if NEW_UNIFORM_SAMPLING
-  // Index of free space
-  free_space_indices.resize(0);
-  for(int i = 0; i < map_->size_x; i++)
-    for(int j = 0; j < map_->size_y; j++)
-      if(map_->cells[MAP_INDEX(map_,i,j)].occ_state == -1)
-        free_space_indices.push_back(std::make_pair(i,j));
+      free_space_indices.resize(free_count);
+      for(int i = 0; i < free_count; i++)
+        free_space_indices[i] = std::make_pair(free_space[2*i], free_space[2*i+1]);
+#endif
+    }
+  }
+
+#if NEW_UNIFORM_SAMPLING
+  if(!cache_loaded)
+  {
+    // Index of free space
+    free_space_indices.resize(0);
+    for(int i = 0; i < map_->size_x; i++)
+      for(int j = 0; j < map_->size_y; j++)
+        if(map_->cells[MAP_INDEX(map_,i,j)].occ_state == -1)
+          free_space_indices.push_back(std::make_pair(i,j));
+  }
 #endif
   // Create the particle filter
   pf_ = pf_alloc(min_particles_, max_particles_,
@@ -729,6 +763,7 @@ AmclNode::handleMapMessage(const nav_msgs::OccupancyGrid& msg)
   delete laser_;
   laser_ = new AMCLLaser(max_beams_, map_);
   ROS_ASSERT(laser_);
+  laser_->SetModelThreads(laser_model_threads_);
   if(laser_model_type_ == LASER_MODEL_BEAM)
     laser_->SetModelBeam(z_hit_, z_short_, z_max_, z_rand_,
                          sigma_hit_, lambda_short_, 0.0);
@@ -748,6 +783,24 @@ AmclNode::handleMapMessage(const nav_msgs::OccupancyGrid& msg)
     ROS_INFO("Done initializing likelihood field model.");
   }
 
+  if(!cache_file.empty() && !cache_loaded)
+  {
+    std::vector<int> free_space;
+#if NEW_UNIFORM_SAMPLING
+    free_space.reserve(2 * free_space_indices.size());
+    for(unsigned int i = 0; i < free_space_indices.size(); i++)
+    {
+      free_space.push_back(free_space_indices[i].first);
+      free_space.push_back(free_space_indices[i].second);
+    }
+#endif
+    if(map_cache_save(map_, cache_file.c_str(), free_space.empty() ? NULL : &free_space[0],
+                      free_space.size() / 2) == 0)
+      ROS_INFO("Saved the likelihood field to %s", cache_file.c_str());
+    else
+      ROS_WARN("Failed to save the likelihood field to %s", cache_file.c_str());
+  }
+
   // In case the initial pose message arrived before the first map,
   // try to apply the initial pose now that the map has arrived.
   applyInitialPose();
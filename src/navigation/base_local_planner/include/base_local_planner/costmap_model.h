@@ -73,6 +73,18 @@ namespace base_local_planner {
       virtual double footprintCost(const geometry_msgs::Point& position, const std::vector<geometry_msgs::Point>& footprint,
           double inscribed_radius, double circumscribed_radius);
 
+      /**
+       * @brief  Checks a footprint given relative to the robot at a pose. The radii are not used by this model,
+       *         so each corner is oriented as its edges are rasterized instead of building an oriented copy.
+       * @param  x The x position of the robot in world coordinates
+       * @param  y The y position of the robot in world coordinates
+       * @param  theta The orientation of the robot
+       * @param  footprint_spec The footprint of the robot relative to its position
+       * @return Positive if all the points lie outside the footprint, negative otherwise
+       */
+      virtual double footprintCost(double x, double y, double theta, const std::vector<geometry_msgs::Point>& footprint_spec,
+          double inscribed_radius = 0.0, double circumscribed_radius = 0.0);
+
     private:
       /**
        * @brief  Rasterizes a line in the costmap grid and checks for collisions
@@ -0,0 +1,106 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef FOOTPRINT_CACHE_H_
+#define FOOTPRINT_CACHE_H_
+
+#include <vector>
+#include <geometry_msgs/Point.h>
+#include <costmap_2d/costmap_2d.h>
+
+namespace base_local_planner {
+
+/**
+ * @class FootprintCache
+ * @brief The cells under the outline of a footprint, relative to the cell of
+ * the robot, rasterized once for each of a number of evenly spaced headings
+ * and of SUBCELLS x SUBCELLS parts of the cell of the robot.
+ *
+ * Checking a footprint then reads the costmap at those offsets instead of
+ * transforming and rasterizing the outline again, as CostmapModel does. A
+ * pose is rounded to the nearest heading and to the part of the cell it is
+ * in, so each outline covers every cell the outline of any pose rounded to
+ * it can cover. The cost is never below the one CostmapModel gives, and a
+ * footprint CostmapModel finds illegal is never legal, but a legal one can
+ * be reported illegal.
+ */
+class FootprintCache {
+public:
+  FootprintCache();
+
+  /**
+   * @brief  Rasterize the outline of the footprint, unless it was already done
+   * for the same footprint, resolution and number of headings
+   * @param footprint_spec The footprint of the robot, relative to its center
+   * @param resolution The resolution of the costmap
+   * @param num_headings The number of headings to rasterize the footprint for
+   */
+  void update(const std::vector<geometry_msgs::Point>& footprint_spec, double resolution,
+      unsigned int num_headings);
+
+  /**
+   * @brief  The highest cost under the outline of the footprint
+   * @param costmap The costmap to read the costs from
+   * @param x The x position of the robot in world coordinates
+   * @param y The y position of the robot in world coordinates
+   * @param theta The heading of the robot
+   * @return The highest cost, or -1 if any cell under the outline is lethal,
+   * unknown or off the costmap
+   */
+  double footprintCost(const costmap_2d::Costmap2D& costmap, double x, double y, double theta) const;
+
+  bool empty() const {
+    return begin_.empty();
+  }
+
+private:
+  static const int SUBCELLS = 4;
+
+  void rasterize(double min_theta, double max_theta, double min_sub_x, double max_sub_x, double min_sub_y,
+      double max_sub_y);
+
+  std::vector<geometry_msgs::Point> footprint_spec_;
+  double resolution_;
+  unsigned int num_headings_;
+
+  // the offsets of pose i are [begin_[i], begin_[i + 1]), sorted by row
+  std::vector<int> offsets_x_, offsets_y_;
+  std::vector<unsigned int> begin_;
+  // bounding box of the offsets of each pose
+  std::vector<int> min_x_, max_x_, min_y_, max_y_;
+};
+
+} /* namespace base_local_planner */
+#endif /* FOOTPRINT_CACHE_H_ */
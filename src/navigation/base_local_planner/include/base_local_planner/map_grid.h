@@ -149,9 +149,11 @@ namespace base_local_planner{
        * @brief  Used to update the distance of a cell in path distance computation
        * @param  current_cell The cell we're currently in 
        * @param  check_cell The cell to be updated
+       * @param  costs The cost array of the costmap
+       * @param  costmap_size_x The width of the costmap
        */
       inline bool updatePathCell(MapCell* current_cell, MapCell* check_cell,
-          const costmap_2d::Costmap2D& costmap);
+          const unsigned char* costs, unsigned int costmap_size_x);
 
       /**
        * increase global plan resolution to match that of the costmap by adding points linearly between global plan points
@@ -191,9 +193,18 @@ namespace base_local_planner{
       unsigned int size_x_, size_y_; ///< @brief The dimensions of the grid
 
     private:
+      /**
+       * @brief  Compute the distance from each cell in the local map grid to the cells in dist_queue_
+       *
+       * The queue is a vector kept between calls, which is only appended to while it is walked,
+       * so filling in the distances does not allocate once it has grown to the size of the grid.
+       */
+      void computeTargetDistance(const costmap_2d::Costmap2D& costmap);
 
       std::vector<MapCell> map_; ///< @brief Storage for the MapCells
 
+      std::vector<MapCell*> dist_queue_; ///< @brief Cells whose neighbors are still to be updated, in the order they were reached
+
   };
 };
 
@@ -100,6 +100,8 @@ public:
 
   double scoreTrajectory(Trajectory &traj);
 
+  bool isThreadSafe() {return true;}
+
   /**
    * return a value that indicates cell is in obstacle
    */
@@ -41,6 +41,7 @@
 #include <base_local_planner/trajectory_cost_function.h>
 
 #include <base_local_planner/costmap_model.h>
+#include <base_local_planner/footprint_cache.h>
 #include <costmap_2d/costmap_2d.h>
 
 namespace base_local_planner {
@@ -58,12 +59,20 @@ public:
 
   bool prepare();
   double scoreTrajectory(Trajectory &traj);
+  bool isThreadSafe() {return true;}
 
   void setSumScores(bool score_sums){ sum_scores_=score_sums; }
 
   void setParams(double max_trans_vel, double max_scaling_factor, double scaling_speed);
   void setFootprint(std::vector<geometry_msgs::Point> footprint_spec);
 
+  /**
+   * Check the footprint with outlines rasterized in advance for num_headings
+   * headings, rather than rasterizing it at every point of a trajectory.
+   * 0 (the default) rasterizes it at every point.
+   */
+  void setFootprintHeadings(unsigned int num_headings) { footprint_headings_ = num_headings; }
+
   // helper functions, made static for easy unit testing
   static double getScalingFactor(Trajectory &traj, double scaling_speed, double max_trans_vel, double max_scaling_factor);
   static double footprintCost(
@@ -71,11 +80,13 @@ public:
       const double& y,
       const double& th,
       double scale,
-      std::vector<geometry_msgs::Point> footprint_spec,
+      const std::vector<geometry_msgs::Point>& footprint_spec,
       costmap_2d::Costmap2D* costmap,
       base_local_planner::WorldModel* world_model);
 
 private:
+  double cachedFootprintCost(double x, double y, double th, double scale);
+
   costmap_2d::Costmap2D* costmap_;
   std::vector<geometry_msgs::Point> footprint_spec_;
   base_local_planner::WorldModel* world_model_;
@@ -83,6 +94,8 @@ private:
   bool sum_scores_;
   //footprint scaling with velocity;
   double max_scaling_factor_, scaling_speed_;
+  unsigned int footprint_headings_;
+  FootprintCache footprint_cache_;
 };
 
 } /* namespace base_local_planner */
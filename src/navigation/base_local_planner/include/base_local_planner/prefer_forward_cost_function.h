@@ -52,6 +52,8 @@ public:
 
   bool prepare() {return true;};
 
+  bool isThreadSafe() {return true;};
+
   void setPenalty(double penalty) {
     penalty_ = penalty;
   }
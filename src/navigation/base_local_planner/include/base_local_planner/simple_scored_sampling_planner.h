@@ -39,7 +39,11 @@
 #define SIMPLE_SCORED_SAMPLING_PLANNER_H_
 
 #include <vector>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <costmap_2d/worker_pool.h>
 #include <base_local_planner/trajectory.h>
+#include <base_local_planner/trajectory_batch.h>
 #include <base_local_planner/trajectory_cost_function.h>
 #include <base_local_planner/trajectory_sample_generator.h>
 #include <base_local_planner/trajectory_search.h>
@@ -93,12 +97,40 @@ public:
    */
   bool findBestTrajectory(Trajectory& traj, std::vector<Trajectory>* all_explored = 0);
 
+  /**
+   * As above, but collects all trajectories in a batch that is cleared first.
+   * Reusing the batch across cycles avoids allocating a copy of each trajectory.
+   */
+  bool findBestTrajectory(Trajectory& traj, TrajectoryBatch& all_explored);
+
+  /**
+   * Score the samples of a generator on num_threads threads, 0 or 1 to score
+   * them in the calling thread. The samples are then generated before any is
+   * scored, and only if all critics are thread safe. The best trajectory is the
+   * same as the one found serially, though the costs in all_explored of
+   * trajectories abandoned as worse than the best may differ.
+   */
+  void setNumThreads(unsigned int num_threads);
+
 
 private:
+  bool findBestTrajectory(Trajectory& traj, std::vector<Trajectory>* all_explored, TrajectoryBatch* explored_batch);
+
+  /**
+   * scores one of num_chunks equal parts of the first num_samples samples_,
+   * against the best cost found by any thread so far
+   */
+  void scoreChunk(unsigned int chunk, unsigned int num_chunks, unsigned int num_samples,
+      double* best_traj_cost, boost::mutex* mutex);
+
   std::vector<TrajectorySampleGenerator*> gen_list_;
   std::vector<TrajectoryCostFunction*> critics_;
 
   int max_samples_;
+
+  boost::shared_ptr<costmap_2d::WorkerPool> workers_;
+  std::vector<Trajectory> samples_; ///< @brief samples of the generator being scored in parallel, kept to reuse their points
+  Trajectory loop_traj_, best_traj_; ///< @brief scratch trajectories of the serial search, kept to reuse their points
 };
 
 
@@ -0,0 +1,102 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+#ifndef TRAJECTORY_ROLLOUT_TRAJECTORY_BATCH_H_
+#define TRAJECTORY_ROLLOUT_TRAJECTORY_BATCH_H_
+
+#include <vector>
+#include <base_local_planner/trajectory.h>
+
+namespace base_local_planner {
+  /**
+   * @class TrajectoryBatch
+   * @brief Holds the trajectories of a planning cycle, each field of all of them in one array
+   *
+   * The points of all trajectories are stored one after the other in shared x, y and theta
+   * arrays. Clearing the batch keeps its storage, so filling it again in the next cycle
+   * does not allocate once it has grown to the number of points of a cycle.
+   */
+  class TrajectoryBatch {
+    public:
+      TrajectoryBatch();
+
+      /**
+       * @brief  Remove all trajectories, keeping the storage for the next cycle
+       */
+      void clear();
+
+      /**
+       * @brief  Append a copy of a trajectory
+       * @param traj The trajectory to copy, including its cost
+       * @return The index of the trajectory in the batch
+       */
+      unsigned int add(const Trajectory& traj);
+
+      /**
+       * @brief  Copy a trajectory of the batch into traj, reusing the points of traj
+       * @param index The index of the trajectory
+       * @param traj The trajectory to copy into
+       */
+      void getTrajectory(unsigned int index, Trajectory& traj) const;
+
+      /**
+       * @brief  Return the number of trajectories in the batch
+       */
+      unsigned int size() const { return xv_.size(); }
+
+      unsigned int getPointsSize(unsigned int index) const { return begin_[index + 1] - begin_[index]; }
+
+      /**
+       * @brief  The x, y and theta positions of the points of a trajectory, each getPointsSize() long
+       */
+      const double* getXPoints(unsigned int index) const { return x_pts_.empty() ? 0 : &x_pts_[0] + begin_[index]; }
+      const double* getYPoints(unsigned int index) const { return y_pts_.empty() ? 0 : &y_pts_[0] + begin_[index]; }
+      const double* getThPoints(unsigned int index) const { return th_pts_.empty() ? 0 : &th_pts_[0] + begin_[index]; }
+
+      double getXV(unsigned int index) const { return xv_[index]; }
+      double getYV(unsigned int index) const { return yv_[index]; }
+      double getThetaV(unsigned int index) const { return thetav_[index]; }
+
+      double getCost(unsigned int index) const { return cost_[index]; }
+      void setCost(unsigned int index, double cost) { cost_[index] = cost; }
+
+    private:
+      std::vector<double> xv_, yv_, thetav_; ///< @brief The velocities of each trajectory
+      std::vector<double> cost_; ///< @brief The cost of each trajectory
+      std::vector<double> time_delta_; ///< @brief The time gap between points of each trajectory
+
+      std::vector<unsigned int> begin_; ///< @brief The points of trajectory i are [begin_[i], begin_[i + 1])
+      std::vector<double> x_pts_, y_pts_, th_pts_; ///< @brief The points of all trajectories
+  };
+};
+#endif
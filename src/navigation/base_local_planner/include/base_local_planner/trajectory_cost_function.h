@@ -64,6 +64,15 @@ public:
    */
   virtual double scoreTrajectory(Trajectory &traj) = 0;
 
+  /**
+   * Whether scoreTrajectory may be called for different trajectories from
+   * several threads at once between two calls of prepare. Cost functions
+   * that change their state while scoring must not override this.
+   */
+  virtual bool isThreadSafe() {
+    return false;
+  }
+
   double getScale() {
     return scale_;
   }
@@ -106,6 +106,61 @@ namespace base_local_planner {
 
   }
 
+  double CostmapModel::footprintCost(double x, double y, double theta, const std::vector<geometry_msgs::Point>& footprint_spec,
+      double inscribed_radius, double circumscribed_radius){
+
+    //used to put things into grid coordinates
+    unsigned int cell_x, cell_y;
+
+    //get the cell coord of the center point of the robot
+    if(!costmap_.worldToMap(x, y, cell_x, cell_y))
+      return -1.0;
+
+    //if number of points in the footprint is less than 3, we'll just assume a circular robot
+    if(footprint_spec.size() < 3){
+      unsigned char cost = costmap_.getCost(cell_x, cell_y);
+      if(cost == LETHAL_OBSTACLE || cost == INSCRIBED_INFLATED_OBSTACLE || cost == NO_INFORMATION)
+        return -1.0;
+      return cost;
+    }
+
+    double cos_th = cos(theta);
+    double sin_th = sin(theta);
+    unsigned int first_x = 0, first_y = 0, x0 = 0, y0 = 0, x1, y1;
+    double line_cost = 0.0;
+    double footprint_cost = 0.0;
+
+    //orient each corner as it is reached and rasterize the line to it from the previous corner
+    for(unsigned int i = 0; i < footprint_spec.size(); ++i){
+      double wx = x + (footprint_spec[i].x * cos_th - footprint_spec[i].y * sin_th);
+      double wy = y + (footprint_spec[i].x * sin_th + footprint_spec[i].y * cos_th);
+      if(!costmap_.worldToMap(wx, wy, x1, y1))
+        return -1.0;
+
+      if(i == 0){
+        first_x = x1;
+        first_y = y1;
+      }
+      else{
+        line_cost = lineCost(x0, x1, y0, y1);
+        footprint_cost = std::max(line_cost, footprint_cost);
+        if(line_cost < 0)
+          return -1.0;
+      }
+      x0 = x1;
+      y0 = y1;
+    }
+
+    //we also need to connect the last point in the footprint to the first point
+    line_cost = lineCost(x0, first_x, y0, first_y);
+    footprint_cost = std::max(line_cost, footprint_cost);
+
+    if(line_cost < 0)
+      return -1.0;
+
+    return footprint_cost;
+  }
+
   //calculate the cost of a ray-traced line
   double CostmapModel::lineCost(int x0, int x1, 
       int y0, int y1){
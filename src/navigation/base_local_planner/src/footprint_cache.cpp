@@ -0,0 +1,182 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <base_local_planner/footprint_cache.h>
+#include <base_local_planner/line_iterator.h>
+#include <costmap_2d/cost_values.h>
+#include <algorithm>
+#include <cmath>
+
+namespace base_local_planner {
+
+FootprintCache::FootprintCache() : resolution_(0.0), num_headings_(0) {}
+
+void FootprintCache::update(const std::vector<geometry_msgs::Point>& footprint_spec, double resolution,
+    unsigned int num_headings) {
+  bool same = resolution == resolution_ && num_headings == num_headings_ &&
+      footprint_spec.size() == footprint_spec_.size();
+  for (unsigned int i = 0; same && i < footprint_spec.size(); ++i) {
+    same = footprint_spec[i].x == footprint_spec_[i].x && footprint_spec[i].y == footprint_spec_[i].y;
+  }
+  if (same) {
+    return;
+  }
+
+  footprint_spec_ = footprint_spec;
+  resolution_ = resolution;
+  num_headings_ = num_headings;
+  offsets_x_.clear();
+  offsets_y_.clear();
+  begin_.clear();
+  min_x_.clear();
+  max_x_.clear();
+  min_y_.clear();
+  max_y_.clear();
+  if (num_headings == 0 || footprint_spec.size() < 3) {
+    return;
+  }
+
+  // every pose is rounded to the nearest heading, and down to the subcell it is in
+  begin_.push_back(0);
+  double bin = 2 * M_PI / num_headings;
+  for (unsigned int i = 0; i < num_headings; ++i) {
+    for (int sub_y = 0; sub_y < SUBCELLS; ++sub_y) {
+      for (int sub_x = 0; sub_x < SUBCELLS; ++sub_x) {
+        rasterize((i - 0.5) * bin, (i + 0.5) * bin, double(sub_x) / SUBCELLS, double(sub_x + 1) / SUBCELLS,
+            double(sub_y) / SUBCELLS, double(sub_y + 1) / SUBCELLS);
+        begin_.push_back(offsets_x_.size());
+      }
+    }
+  }
+}
+
+void FootprintCache::rasterize(double min_theta, double max_theta, double min_sub_x, double max_sub_x,
+    double min_sub_y, double max_sub_y) {
+  // The cells each corner can be in, for the robot anywhere in [min_sub_x, max_sub_x] x [min_sub_y, max_sub_y]
+  // within cell (0, 0) and any heading in [min_theta, max_theta]. They are widened by a little for the
+  // rounding of the world coordinates CostmapModel starts from.
+  const double slack = 1e-6;
+  unsigned int num_corners = footprint_spec_.size();
+  std::vector<int> corner_min_x(num_corners), corner_max_x(num_corners);
+  std::vector<int> corner_min_y(num_corners), corner_max_y(num_corners);
+  for (unsigned int i = 0; i < num_corners; ++i) {
+    double radius = hypot(footprint_spec_[i].x, footprint_spec_[i].y) / resolution_;
+    double angle = atan2(footprint_spec_[i].y, footprint_spec_[i].x);
+    double lo = min_theta + angle, hi = max_theta + angle;
+    double min_cos = std::min(cos(lo), cos(hi)), max_cos = std::max(cos(lo), cos(hi));
+    double min_sin = std::min(sin(lo), sin(hi)), max_sin = std::max(sin(lo), sin(hi));
+    // the extremes the corner passes on its way from lo to hi
+    for (int k = (int)ceil(lo / M_PI_2); k * M_PI_2 <= hi; ++k) {
+      switch (((k % 4) + 4) % 4) {
+        case 0: max_cos = 1.0; break;
+        case 1: max_sin = 1.0; break;
+        case 2: min_cos = -1.0; break;
+        case 3: min_sin = -1.0; break;
+      }
+    }
+    corner_min_x[i] = (int)floor(min_sub_x + radius * min_cos - slack);
+    corner_max_x[i] = (int)floor(max_sub_x + radius * max_cos + slack);
+    corner_min_y[i] = (int)floor(min_sub_y + radius * min_sin - slack);
+    corner_max_y[i] = (int)floor(max_sub_y + radius * max_sin + slack);
+  }
+
+  // a line never leaves the box of its ends, so neither does the outline leave the box of the corners
+  int min_x = *std::min_element(corner_min_x.begin(), corner_min_x.end());
+  int max_x = *std::max_element(corner_max_x.begin(), corner_max_x.end());
+  int min_y = *std::min_element(corner_min_y.begin(), corner_min_y.end());
+  int max_y = *std::max_element(corner_max_y.begin(), corner_max_y.end());
+  int width = max_x - min_x + 1;
+  std::vector<bool> covered(width * (max_y - min_y + 1), false);
+
+  // the outlines between every combination of cells of the corners, in the order CostmapModel rasterizes them
+  for (unsigned int i = 0; i < num_corners; ++i) {
+    unsigned int j = (i + 1) % num_corners;
+    for (int ay = corner_min_y[i]; ay <= corner_max_y[i]; ++ay) {
+      for (int ax = corner_min_x[i]; ax <= corner_max_x[i]; ++ax) {
+        for (int by = corner_min_y[j]; by <= corner_max_y[j]; ++by) {
+          for (int bx = corner_min_x[j]; bx <= corner_max_x[j]; ++bx) {
+            for (LineIterator line(ax, ay, bx, by); line.isValid(); line.advance()) {
+              covered[(line.getY() - min_y) * width + line.getX() - min_x] = true;
+            }
+          }
+        }
+      }
+    }
+  }
+
+  for (unsigned int i = 0; i < covered.size(); ++i) {
+    if (covered[i]) {
+      offsets_x_.push_back(min_x + i % width);
+      offsets_y_.push_back(min_y + i / width);
+    }
+  }
+  min_x_.push_back(min_x);
+  max_x_.push_back(max_x);
+  min_y_.push_back(min_y);
+  max_y_.push_back(max_y);
+}
+
+double FootprintCache::footprintCost(const costmap_2d::Costmap2D& costmap, double x, double y, double theta) const {
+  int heading = (int)floor(theta / (2 * M_PI) * num_headings_ + 0.5) % (int)num_headings_;
+  if (heading < 0) {
+    heading += num_headings_;
+  }
+
+  double map_x = (x - costmap.getOriginX()) / costmap.getResolution();
+  double map_y = (y - costmap.getOriginY()) / costmap.getResolution();
+  int cell_x = (int)floor(map_x), cell_y = (int)floor(map_y);
+  int sub_x = std::min((int)((map_x - cell_x) * SUBCELLS), SUBCELLS - 1);
+  int sub_y = std::min((int)((map_y - cell_y) * SUBCELLS), SUBCELLS - 1);
+  int pose = (heading * SUBCELLS + sub_y) * SUBCELLS + sub_x;
+
+  int size_x = costmap.getSizeInCellsX(), size_y = costmap.getSizeInCellsY();
+  if (cell_x + min_x_[pose] < 0 || cell_x + max_x_[pose] >= size_x ||
+      cell_y + min_y_[pose] < 0 || cell_y + max_y_[pose] >= size_y) {
+    return -1.0;
+  }
+
+  const unsigned char* center = costmap.getCharMap() + cell_y * size_x + cell_x;
+  unsigned char footprint_cost = 0;
+  for (unsigned int i = begin_[pose]; i < begin_[pose + 1]; ++i) {
+    unsigned char cost = center[offsets_y_[i] * size_x + offsets_x_[i]];
+    if (cost == costmap_2d::LETHAL_OBSTACLE || cost == costmap_2d::NO_INFORMATION) {
+      return -1.0;
+    }
+    footprint_cost = std::max(footprint_cost, cost);
+  }
+  return footprint_cost;
+}
+
+} /* namespace base_local_planner */
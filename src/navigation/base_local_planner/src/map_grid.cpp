@@ -101,11 +101,11 @@ namespace base_local_planner{
 
 
   inline bool MapGrid::updatePathCell(MapCell* current_cell, MapCell* check_cell,
-      const costmap_2d::Costmap2D& costmap){
+      const unsigned char* costs, unsigned int costmap_size_x){
 
     //if the cell is an obstacle set the max path distance
-    unsigned char cost = costmap.getCost(check_cell->cx, check_cell->cy);
-    if(! getCell(check_cell->cx, check_cell->cy).within_robot &&
+    unsigned char cost = costs[costmap_size_x * check_cell->cy + check_cell->cx];
+    if(! check_cell->within_robot &&
         (cost == costmap_2d::LETHAL_OBSTACLE ||
          cost == costmap_2d::INSCRIBED_INFLATED_OBSTACLE ||
          cost == costmap_2d::NO_INFORMATION)){
@@ -175,7 +175,7 @@ namespace base_local_planner{
 
     bool started_path = false;
 
-    queue<MapCell*> path_dist_queue;
+    dist_queue_.clear();
 
     std::vector<geometry_msgs::PoseStamped> adjusted_global_plan;
     adjustPlanResolution(global_plan, adjusted_global_plan, costmap.getResolution());
@@ -192,7 +192,7 @@ namespace base_local_planner{
         MapCell& current = getCell(map_x, map_y);
         current.target_dist = 0.0;
         current.target_mark = true;
-        path_dist_queue.push(&current);
+        dist_queue_.push_back(&current);
         started_path = true;
       } else if (started_path) {
           break;
@@ -204,7 +204,7 @@ namespace base_local_planner{
       return;
     }
 
-    computeTargetDistance(path_dist_queue, costmap);
+    computeTargetDistance(costmap);
   }
 
   //mark the point of the costmap as local goal where global_plan first leaves the area (or its last point)
@@ -239,38 +239,48 @@ namespace base_local_planner{
       return;
     }
 
-    queue<MapCell*> path_dist_queue;
+    dist_queue_.clear();
     if (local_goal_x >= 0 && local_goal_y >= 0) {
       MapCell& current = getCell(local_goal_x, local_goal_y);
       costmap.mapToWorld(local_goal_x, local_goal_y, goal_x_, goal_y_);
       current.target_dist = 0.0;
       current.target_mark = true;
-      path_dist_queue.push(&current);
+      dist_queue_.push_back(&current);
     }
 
-    computeTargetDistance(path_dist_queue, costmap);
+    computeTargetDistance(costmap);
   }
 
 
 
   void MapGrid::computeTargetDistance(queue<MapCell*>& dist_queue, const costmap_2d::Costmap2D& costmap){
+    dist_queue_.clear();
+    while(!dist_queue.empty()){
+      dist_queue_.push_back(dist_queue.front());
+      dist_queue.pop();
+    }
+    computeTargetDistance(costmap);
+  }
+
+  void MapGrid::computeTargetDistance(const costmap_2d::Costmap2D& costmap){
     MapCell* current_cell;
     MapCell* check_cell;
     unsigned int last_col = size_x_ - 1;
     unsigned int last_row = size_y_ - 1;
-    while(!dist_queue.empty()){
-      current_cell = dist_queue.front();
-
-
-      dist_queue.pop();
+    //read the costs directly, this is called for every neighbor of every cell
+    const unsigned char* costs = costmap.getCharMap();
+    unsigned int costmap_size_x = costmap.getSizeInCellsX();
+    //cells are appended while the queue is walked, so its size is read on every step
+    for(unsigned int next = 0; next < dist_queue_.size(); ++next){
+      current_cell = dist_queue_[next];
 
       if(current_cell->cx > 0){
         check_cell = current_cell - 1;
         if(!check_cell->target_mark){
           //mark the cell as visisted
           check_cell->target_mark = true;
-          if(updatePathCell(current_cell, check_cell, costmap)) {
-            dist_queue.push(check_cell);
+          if(updatePathCell(current_cell, check_cell, costs, costmap_size_x)) {
+            dist_queue_.push_back(check_cell);
           }
         }
       }
@@ -279,8 +289,8 @@ namespace base_local_planner{
         check_cell = current_cell + 1;
         if(!check_cell->target_mark){
           check_cell->target_mark = true;
-          if(updatePathCell(current_cell, check_cell, costmap)) {
-            dist_queue.push(check_cell);
+          if(updatePathCell(current_cell, check_cell, costs, costmap_size_x)) {
+            dist_queue_.push_back(check_cell);
           }
         }
       }
@@ -289,8 +299,8 @@ namespace base_local_planner{
         check_cell = current_cell - size_x_;
         if(!check_cell->target_mark){
           check_cell->target_mark = true;
-          if(updatePathCell(current_cell, check_cell, costmap)) {
-            dist_queue.push(check_cell);
+          if(updatePathCell(current_cell, check_cell, costs, costmap_size_x)) {
+            dist_queue_.push_back(check_cell);
           }
         }
       }
@@ -299,8 +309,8 @@ namespace base_local_planner{
         check_cell = current_cell + size_x_;
         if(!check_cell->target_mark){
           check_cell->target_mark = true;
-          if(updatePathCell(current_cell, check_cell, costmap)) {
-            dist_queue.push(check_cell);
+          if(updatePathCell(current_cell, check_cell, costs, costmap_size_x)) {
+            dist_queue_.push_back(check_cell);
           }
         }
       }
@@ -43,7 +43,7 @@
 namespace base_local_planner {
 
 ObstacleCostFunction::ObstacleCostFunction(costmap_2d::Costmap2D* costmap) 
-    : costmap_(costmap), sum_scores_(false) {
+    : costmap_(costmap), sum_scores_(false), footprint_headings_(0) {
   if (costmap != NULL) {
     world_model_ = new base_local_planner::CostmapModel(*costmap_);
   }
@@ -68,6 +68,9 @@ void ObstacleCostFunction::setFootprint(std::vector<geometry_msgs::Point> footpr
 }
 
 bool ObstacleCostFunction::prepare() {
+  if (footprint_headings_ > 0) {
+    footprint_cache_.update(footprint_spec_, costmap_->getResolution(), footprint_headings_);
+  }
   return true;
 }
 
@@ -81,11 +84,17 @@ double ObstacleCostFunction::scoreTrajectory(Trajectory &traj) {
     return -9;
   }
 
+  bool cached = footprint_headings_ > 0 && !footprint_cache_.empty();
   for (unsigned int i = 0; i < traj.getPointsSize(); ++i) {
     traj.getPoint(i, px, py, pth);
-    double f_cost = footprintCost(px, py, pth,
-        scale, footprint_spec_,
-        costmap_, world_model_);
+    double f_cost;
+    if (cached) {
+      f_cost = cachedFootprintCost(px, py, pth, scale);
+    } else {
+      f_cost = footprintCost(px, py, pth,
+          scale, footprint_spec_,
+          costmap_, world_model_);
+    }
 
     if(f_cost < 0){
         return f_cost;
@@ -99,6 +108,22 @@ double ObstacleCostFunction::scoreTrajectory(Trajectory &traj) {
   return cost;
 }
 
+double ObstacleCostFunction::cachedFootprintCost(double x, double y, double th, double scale) {
+  // same costs as footprintCost, whose off the map check is made by the world model
+  unsigned int cell_x, cell_y;
+  if ( ! costmap_->worldToMap(x, y, cell_x, cell_y)) {
+    return -6.0;
+  }
+
+  // the cached outline covers the exact one and more, so it can only be wrong about a collision
+  double footprint_cost = footprint_cache_.footprintCost(*costmap_, x, y, th);
+  if (footprint_cost < 0) {
+    return footprintCost(x, y, th, scale, footprint_spec_, costmap_, world_model_);
+  }
+
+  return std::max(footprint_cost, double(costmap_->getCost(cell_x, cell_y)));
+}
+
 double ObstacleCostFunction::getScalingFactor(Trajectory &traj, double scaling_speed, double max_trans_vel, double max_scaling_factor) {
   double vmag = hypot(traj.xv_, traj.yv_);
 
@@ -118,7 +143,7 @@ double ObstacleCostFunction::footprintCost (
     const double& y,
     const double& th,
     double scale,
-    std::vector<geometry_msgs::Point> footprint_spec,
+    const std::vector<geometry_msgs::Point>& footprint_spec,
     costmap_2d::Costmap2D* costmap,
     base_local_planner::WorldModel* world_model) {
 
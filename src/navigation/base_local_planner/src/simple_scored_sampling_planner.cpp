@@ -38,6 +38,8 @@
 #include <base_local_planner/simple_scored_sampling_planner.h>
 
 #include <ros/console.h>
+#include <boost/bind.hpp>
+#include <algorithm>
 
 namespace base_local_planner {
   
@@ -78,47 +80,145 @@ namespace base_local_planner {
     return traj_cost;
   }
 
+  void SimpleScoredSamplingPlanner::setNumThreads(unsigned int num_threads) {
+    if (num_threads <= 1) {
+      workers_.reset();
+    } else if (!workers_ || workers_->getNumThreads() != num_threads - 1) {
+      // the calling thread scores samples too
+      workers_.reset(new costmap_2d::WorkerPool(num_threads - 1));
+    }
+  }
+
+  void SimpleScoredSamplingPlanner::scoreChunk(unsigned int chunk, unsigned int num_chunks, unsigned int num_samples,
+      double* best_traj_cost, boost::mutex* mutex) {
+    double best_cost;
+    {
+      boost::mutex::scoped_lock l(*mutex);
+      best_cost = *best_traj_cost;
+    }
+
+    // abandoning trajectories worse than some best so far never abandons one
+    // with the lowest cost, so the serial choice is kept
+    for (unsigned int i = chunk * num_samples / num_chunks; i < (chunk + 1) * num_samples / num_chunks; ++i) {
+      double cost = scoreTrajectory(samples_[i], best_cost);
+      samples_[i].cost_ = cost;
+      if (cost >= 0 && (best_cost < 0 || cost < best_cost)) {
+        best_cost = cost;
+      }
+    }
+
+    boost::mutex::scoped_lock l(*mutex);
+    if (best_cost >= 0 && (*best_traj_cost < 0 || best_cost < *best_traj_cost)) {
+      *best_traj_cost = best_cost;
+    }
+  }
+
   bool SimpleScoredSamplingPlanner::findBestTrajectory(Trajectory& traj, std::vector<Trajectory>* all_explored) {
-    Trajectory loop_traj;
-    Trajectory best_traj;
+    return findBestTrajectory(traj, all_explored, NULL);
+  }
+
+  bool SimpleScoredSamplingPlanner::findBestTrajectory(Trajectory& traj, TrajectoryBatch& all_explored) {
+    all_explored.clear();
+    return findBestTrajectory(traj, NULL, &all_explored);
+  }
+
+  bool SimpleScoredSamplingPlanner::findBestTrajectory(Trajectory& traj, std::vector<Trajectory>* all_explored,
+      TrajectoryBatch* explored_batch) {
+    Trajectory& loop_traj = loop_traj_;
+    Trajectory& best_traj = best_traj_;
     double loop_traj_cost, best_traj_cost = -1;
     bool gen_success;
     int count, count_valid;
+    bool parallel = workers_.get() != NULL;
     for (std::vector<TrajectoryCostFunction*>::iterator loop_critic = critics_.begin(); loop_critic != critics_.end(); ++loop_critic) {
       TrajectoryCostFunction* loop_critic_p = *loop_critic;
       if (loop_critic_p->prepare() == false) {
         ROS_WARN("A scoring function failed to prepare");
         return false;
       }
+      if (loop_critic_p->getScale() != 0 && !loop_critic_p->isThreadSafe()) {
+        parallel = false;
+      }
     }
 
     for (std::vector<TrajectorySampleGenerator*>::iterator loop_gen = gen_list_.begin(); loop_gen != gen_list_.end(); ++loop_gen) {
       count = 0;
       count_valid = 0;
       TrajectorySampleGenerator* gen_ = *loop_gen;
-      while (gen_->hasMoreTrajectories()) {
-        gen_success = gen_->nextTrajectory(loop_traj);
-        if (gen_success == false) {
-          // TODO use this for debugging
-          continue;
+      if (parallel) {
+        // generate all samples, then score them across the workers
+        unsigned int num_samples = 0;
+        while (gen_->hasMoreTrajectories()) {
+          if (num_samples == samples_.size()) {
+            samples_.resize(num_samples + 1);
+          }
+          if (gen_->nextTrajectory(samples_[num_samples]) == false) {
+            continue;
+          }
+          num_samples++;
+          if (max_samples_ > 0 && (int)num_samples >= max_samples_) {
+            break;
+          }
         }
-        loop_traj_cost = scoreTrajectory(loop_traj, best_traj_cost);
-        if (all_explored != NULL) {
-          loop_traj.cost_ = loop_traj_cost;
-          all_explored->push_back(loop_traj);
+
+        // a few chunks per thread, so that threads which finish early take more
+        boost::mutex mutex;
+        unsigned int num_chunks = std::min(num_samples, 4 * (workers_->getNumThreads() + 1));
+        workers_->run(num_chunks, boost::bind(&SimpleScoredSamplingPlanner::scoreChunk, this, _1, num_chunks,
+            num_samples, &best_traj_cost, &mutex));
+
+        best_traj_cost = -1;
+        int best_index = -1;
+        for (unsigned int i = 0; i < num_samples; ++i) {
+          loop_traj_cost = samples_[i].cost_;
+          if (all_explored != NULL) {
+            all_explored->push_back(samples_[i]);
+          }
+          if (explored_batch != NULL) {
+            explored_batch->add(samples_[i]);
+          }
+          if (loop_traj_cost >= 0) {
+            count_valid++;
+            if (best_traj_cost < 0 || loop_traj_cost < best_traj_cost) {
+              best_traj_cost = loop_traj_cost;
+              best_index = i;
+            }
+          }
+          count++;
+        }
+        if (best_index >= 0) {
+          best_traj = samples_[best_index];
         }
+      } else {
+        while (gen_->hasMoreTrajectories()) {
+          gen_success = gen_->nextTrajectory(loop_traj);
+          if (gen_success == false) {
+            // TODO use this for debugging
+            continue;
+          }
+          loop_traj_cost = scoreTrajectory(loop_traj, best_traj_cost);
+          if (all_explored != NULL || explored_batch != NULL) {
+            loop_traj.cost_ = loop_traj_cost;
+          }
+          if (all_explored != NULL) {
+            all_explored->push_back(loop_traj);
+          }
+          if (explored_batch != NULL) {
+            explored_batch->add(loop_traj);
+          }
 
-        if (loop_traj_cost >= 0) {
-          count_valid++;
-          if (best_traj_cost < 0 || loop_traj_cost < best_traj_cost) {
-            best_traj_cost = loop_traj_cost;
-            best_traj = loop_traj;
+          if (loop_traj_cost >= 0) {
+            count_valid++;
+            if (best_traj_cost < 0 || loop_traj_cost < best_traj_cost) {
+              best_traj_cost = loop_traj_cost;
+              best_traj = loop_traj;
+            }
           }
+          count++;
+          if (max_samples_ > 0 && count >= max_samples_) {
+            break;
+          }        
         }
-        count++;
-        if (max_samples_ > 0 && count >= max_samples_) {
-          break;
-        }        
       }
       if (best_traj_cost >= 0) {
         traj.xv_ = best_traj.xv_;
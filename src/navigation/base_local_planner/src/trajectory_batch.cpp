@@ -0,0 +1,84 @@
+/*********************************************************************
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+#include <base_local_planner/trajectory_batch.h>
+
+namespace base_local_planner {
+  TrajectoryBatch::TrajectoryBatch()
+    : begin_(1, 0)
+  {
+  }
+
+  void TrajectoryBatch::clear(){
+    xv_.clear();
+    yv_.clear();
+    thetav_.clear();
+    cost_.clear();
+    time_delta_.clear();
+    begin_.resize(1);
+    x_pts_.clear();
+    y_pts_.clear();
+    th_pts_.clear();
+  }
+
+  unsigned int TrajectoryBatch::add(const Trajectory& traj){
+    xv_.push_back(traj.xv_);
+    yv_.push_back(traj.yv_);
+    thetav_.push_back(traj.thetav_);
+    cost_.push_back(traj.cost_);
+    time_delta_.push_back(traj.time_delta_);
+
+    double x, y, th;
+    for(unsigned int i = 0; i < traj.getPointsSize(); ++i){
+      traj.getPoint(i, x, y, th);
+      x_pts_.push_back(x);
+      y_pts_.push_back(y);
+      th_pts_.push_back(th);
+    }
+    begin_.push_back(x_pts_.size());
+    return xv_.size() - 1;
+  }
+
+  void TrajectoryBatch::getTrajectory(unsigned int index, Trajectory& traj) const {
+    traj.xv_ = xv_[index];
+    traj.yv_ = yv_[index];
+    traj.thetav_ = thetav_[index];
+    traj.cost_ = cost_[index];
+    traj.time_delta_ = time_delta_[index];
+
+    traj.resetPoints();
+    for(unsigned int i = begin_[index]; i < begin_[index + 1]; ++i){
+      traj.addPoint(x_pts_[i], y_pts_[i], th_pts_[i]);
+    }
+  }
+};
@@ -0,0 +1,91 @@
+/*
+ * footprint_cache_test.cpp
+ */
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include <base_local_planner/costmap_model.h>
+#include <base_local_planner/footprint_cache.h>
+#include <costmap_2d/cost_values.h>
+
+namespace base_local_planner {
+
+static std::vector<geometry_msgs::Point> makeFootprint() {
+  // an irregular pentagon, so that corners rarely fall on cell borders
+  double corners[][2] = {{0.337, 0.0}, {0.121, 0.263}, {-0.243, 0.218}, {-0.243, -0.218}, {0.121, -0.263}};
+  std::vector<geometry_msgs::Point> footprint;
+  for (unsigned int i = 0; i < 5; ++i) {
+    geometry_msgs::Point p;
+    p.x = corners[i][0];
+    p.y = corners[i][1];
+    footprint.push_back(p);
+  }
+  return footprint;
+}
+
+TEST(FootprintCacheTest, matchesCostmapModel) {
+  costmap_2d::Costmap2D costmap(100, 100, 0.05, 0.0, 0.0);
+  srand(1);
+  for (unsigned int i = 0; i < 100; ++i) {
+    for (unsigned int j = 0; j < 100; ++j) {
+      int r = rand() % 100;
+      costmap.setCost(i, j, r < 2 ? costmap_2d::LETHAL_OBSTACLE : r < 3 ? costmap_2d::NO_INFORMATION : r);
+    }
+  }
+
+  std::vector<geometry_msgs::Point> footprint = makeFootprint();
+  unsigned int num_headings = 72;
+  FootprintCache cache;
+  cache.update(footprint, costmap.getResolution(), num_headings);
+  CostmapModel model(costmap);
+
+  // robot anywhere in the cells at any heading: the outline it is rounded to covers the exact one
+  unsigned int legal = 0;
+  for (unsigned int i = 0; i < 10000; ++i) {
+    double wx = rand() * 5.0 / RAND_MAX, wy = rand() * 5.0 / RAND_MAX;
+    double theta = rand() * 4 * M_PI / RAND_MAX - 2 * M_PI;
+    double expected = model.footprintCost(wx, wy, theta, footprint);
+    double cost = cache.footprintCost(costmap, wx, wy, theta);
+    if (expected < 0) {
+      EXPECT_LT(cost, 0) << "at " << wx << ", " << wy << ", " << theta;
+    } else if (cost >= 0) {
+      EXPECT_GE(cost, expected) << "at " << wx << ", " << wy << ", " << theta;
+      legal++;
+    }
+  }
+  // the covering outlines are not so wide that nothing is left legal
+  EXPECT_GT(legal, 0u);
+}
+
+TEST(FootprintCacheTest, headingsWrapAround) {
+  costmap_2d::Costmap2D costmap(40, 40, 0.05, 0.0, 0.0);
+  std::vector<geometry_msgs::Point> footprint = makeFootprint();
+  FootprintCache cache;
+  cache.update(footprint, costmap.getResolution(), 36);
+
+  // the nose of the footprint points at an obstacle ahead, however theta is wrapped
+  costmap.setCost(27, 20, costmap_2d::LETHAL_OBSTACLE);
+  double x = 1.025, y = 1.025;
+  EXPECT_EQ(-1.0, cache.footprintCost(costmap, x, y, 0.0));
+  EXPECT_EQ(-1.0, cache.footprintCost(costmap, x, y, 2 * M_PI));
+  EXPECT_EQ(-1.0, cache.footprintCost(costmap, x, y, -2 * M_PI + 0.01));
+  EXPECT_EQ(0.0, cache.footprintCost(costmap, x, y, M_PI));
+  EXPECT_EQ(0.0, cache.footprintCost(costmap, x, y, -M_PI));
+
+  // off the costmap
+  EXPECT_EQ(-1.0, cache.footprintCost(costmap, 0.1, y, 0.0));
+}
+
+TEST(FootprintCacheTest, circularFootprintIsNotCached) {
+  std::vector<geometry_msgs::Point> footprint = makeFootprint();
+  footprint.resize(2);
+  FootprintCache cache;
+  cache.update(footprint, 0.05, 36);
+  EXPECT_TRUE(cache.empty());
+}
+
+}
@@ -0,0 +1,152 @@
+/*
+ * simple_scored_sampling_planner_test.cpp
+ */
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include <base_local_planner/simple_scored_sampling_planner.h>
+
+namespace base_local_planner {
+
+// samples xv_ = 0 .. num_samples - 1, with a point each
+class CountingGenerator : public TrajectorySampleGenerator {
+public:
+  CountingGenerator(int num_samples) : next_(0), num_samples_(num_samples) {}
+
+  bool hasMoreTrajectories() {
+    return next_ < num_samples_;
+  }
+
+  bool nextTrajectory(Trajectory &traj) {
+    traj.resetPoints();
+    traj.xv_ = next_++;
+    traj.addPoint(traj.xv_, 0, 0);
+    return true;
+  }
+
+  int next_, num_samples_;
+};
+
+// a cost that repeats every period samples, invalid for every invalid-th sample
+class ModuloCostFunction : public TrajectoryCostFunction {
+public:
+  ModuloCostFunction(int factor, int period, int invalid, bool thread_safe) :
+    factor_(factor), period_(period), invalid_(invalid), thread_safe_(thread_safe) {}
+
+  bool prepare() {
+    return true;
+  }
+
+  double scoreTrajectory(Trajectory &traj) {
+    int i = traj.xv_;
+    if (invalid_ > 0 && i % invalid_ == 0) {
+      return -1.0;
+    }
+    return (i * factor_) % period_;
+  }
+
+  bool isThreadSafe() {
+    return thread_safe_;
+  }
+
+  int factor_, period_, invalid_;
+  bool thread_safe_;
+};
+
+static Trajectory findBest(std::vector<TrajectoryCostFunction*>& critics, unsigned int num_threads,
+    int num_samples, std::vector<Trajectory>* all_explored = NULL) {
+  CountingGenerator generator(num_samples);
+  std::vector<TrajectorySampleGenerator*> generators;
+  generators.push_back(&generator);
+  SimpleScoredSamplingPlanner planner(generators, critics);
+  planner.setNumThreads(num_threads);
+  Trajectory traj;
+  traj.cost_ = -1;
+  planner.findBestTrajectory(traj, all_explored);
+  return traj;
+}
+
+TEST(SimpleScoredSamplingPlannerTest, parallelMatchesSerial) {
+  ModuloCostFunction first(37, 101, 7, true), second(13, 29, 0, true);
+  std::vector<TrajectoryCostFunction*> critics;
+  critics.push_back(&first);
+  critics.push_back(&second);
+
+  // costs repeat, so the first of several equally good samples has to be picked
+  Trajectory serial = findBest(critics, 0, 8000);
+  EXPECT_GE(serial.cost_, 0);
+  for (unsigned int num_threads = 2; num_threads <= 5; ++num_threads) {
+    Trajectory parallel = findBest(critics, num_threads, 8000);
+    EXPECT_EQ(serial.xv_, parallel.xv_);
+    EXPECT_EQ(serial.cost_, parallel.cost_);
+    EXPECT_EQ(serial.getPointsSize(), parallel.getPointsSize());
+  }
+}
+
+TEST(SimpleScoredSamplingPlannerTest, parallelExplored) {
+  ModuloCostFunction first(37, 101, 7, true);
+  std::vector<TrajectoryCostFunction*> critics;
+  critics.push_back(&first);
+
+  std::vector<Trajectory> serial, parallel;
+  findBest(critics, 0, 500, &serial);
+  findBest(critics, 4, 500, &parallel);
+  ASSERT_EQ(serial.size(), parallel.size());
+  for (unsigned int i = 0; i < serial.size(); ++i) {
+    EXPECT_EQ(serial[i].xv_, parallel[i].xv_);
+    EXPECT_EQ(serial[i].cost_ < 0, parallel[i].cost_ < 0);
+  }
+}
+
+TEST(SimpleScoredSamplingPlannerTest, unsafeCriticScoresSerially) {
+  ModuloCostFunction first(37, 101, 7, true), second(13, 29, 0, false);
+  std::vector<TrajectoryCostFunction*> critics;
+  critics.push_back(&first);
+  critics.push_back(&second);
+
+  Trajectory serial = findBest(critics, 0, 1000);
+  Trajectory parallel = findBest(critics, 4, 1000);
+  EXPECT_EQ(serial.xv_, parallel.xv_);
+  EXPECT_EQ(serial.cost_, parallel.cost_);
+}
+
+TEST(SimpleScoredSamplingPlannerTest, noValidSample) {
+  ModuloCostFunction first(1, 10, 1, true);
+  std::vector<TrajectoryCostFunction*> critics;
+  critics.push_back(&first);
+
+  EXPECT_LT(findBest(critics, 4, 100).cost_, 0);
+}
+
+TEST(SimpleScoredSamplingPlannerTest, exploredBatchMatchesVector) {
+  ModuloCostFunction first(37, 101, 7, true);
+  std::vector<TrajectoryCostFunction*> critics;
+  critics.push_back(&first);
+
+  for (unsigned int num_threads = 0; num_threads <= 4; num_threads += 4) {
+    std::vector<Trajectory> explored;
+    findBest(critics, num_threads, 300, &explored);
+
+    CountingGenerator generator(300);
+    std::vector<TrajectorySampleGenerator*> generators;
+    generators.push_back(&generator);
+    SimpleScoredSamplingPlanner planner(generators, critics);
+    planner.setNumThreads(num_threads);
+    Trajectory traj;
+    TrajectoryBatch batch;
+    batch.add(traj);
+    planner.findBestTrajectory(traj, batch);
+
+    ASSERT_EQ(explored.size(), batch.size());
+    for (unsigned int i = 0; i < batch.size(); ++i) {
+      EXPECT_EQ(explored[i].xv_, batch.getXV(i));
+      EXPECT_EQ(explored[i].cost_, batch.getCost(i));
+      ASSERT_EQ(1u, batch.getPointsSize(i));
+      EXPECT_EQ(explored[i].xv_, batch.getXPoints(i)[0]);
+    }
+  }
+}
+
+}
@@ -0,0 +1,75 @@
+/*
+ * trajectory_batch_test.cpp
+ */
+
+#include <gtest/gtest.h>
+
+#include <base_local_planner/trajectory_batch.h>
+
+namespace base_local_planner {
+
+static Trajectory makeTrajectory(double xv, unsigned int num_points) {
+  Trajectory traj(xv, 0.5, -0.25, 0.1, 0);
+  traj.cost_ = xv * 2;
+  for (unsigned int i = 0; i < num_points; ++i) {
+    traj.addPoint(xv + i, xv - i, 0.1 * i);
+  }
+  return traj;
+}
+
+TEST(TrajectoryBatchTest, roundTrip) {
+  TrajectoryBatch batch;
+  EXPECT_EQ(0u, batch.size());
+  for (unsigned int i = 0; i < 10; ++i) {
+    EXPECT_EQ(i, batch.add(makeTrajectory(i, i % 4)));
+  }
+  EXPECT_EQ(10u, batch.size());
+
+  Trajectory traj;
+  for (unsigned int i = 0; i < 10; ++i) {
+    Trajectory expected = makeTrajectory(i, i % 4);
+    batch.getTrajectory(i, traj);
+    EXPECT_EQ(expected.xv_, traj.xv_);
+    EXPECT_EQ(expected.yv_, traj.yv_);
+    EXPECT_EQ(expected.thetav_, traj.thetav_);
+    EXPECT_EQ(expected.cost_, traj.cost_);
+    EXPECT_EQ(expected.time_delta_, traj.time_delta_);
+    EXPECT_EQ(expected.xv_, batch.getXV(i));
+    EXPECT_EQ(expected.cost_, batch.getCost(i));
+    ASSERT_EQ(expected.getPointsSize(), traj.getPointsSize());
+    ASSERT_EQ(expected.getPointsSize(), batch.getPointsSize(i));
+    for (unsigned int j = 0; j < traj.getPointsSize(); ++j) {
+      double x, y, th, ex, ey, eth;
+      traj.getPoint(j, x, y, th);
+      expected.getPoint(j, ex, ey, eth);
+      EXPECT_EQ(ex, x);
+      EXPECT_EQ(ey, y);
+      EXPECT_EQ(eth, th);
+      EXPECT_EQ(ex, batch.getXPoints(i)[j]);
+      EXPECT_EQ(ey, batch.getYPoints(i)[j]);
+      EXPECT_EQ(eth, batch.getThPoints(i)[j]);
+    }
+  }
+
+  batch.setCost(3, -1.0);
+  EXPECT_EQ(-1.0, batch.getCost(3));
+}
+
+TEST(TrajectoryBatchTest, clearKeepsStorage) {
+  TrajectoryBatch batch;
+  for (unsigned int i = 0; i < 20; ++i) {
+    batch.add(makeTrajectory(i, 5));
+  }
+  const double* points = batch.getXPoints(0);
+
+  batch.clear();
+  EXPECT_EQ(0u, batch.size());
+  for (unsigned int i = 0; i < 20; ++i) {
+    batch.add(makeTrajectory(i + 100, 5));
+  }
+  EXPECT_EQ(20u, batch.size());
+  EXPECT_EQ(points, batch.getXPoints(0));
+  EXPECT_EQ(119.0, batch.getXPoints(19)[0]);
+}
+
+}
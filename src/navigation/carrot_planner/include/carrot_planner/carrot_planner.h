@@ -90,6 +90,7 @@ namespace carrot_planner{
       double step_size_, min_dist_from_robot_;
       costmap_2d::Costmap2D* costmap_;
       base_local_planner::WorldModel* world_model_; ///< @brief The world model that the controller will use
+      boost::shared_ptr<const costmap_2d::Costmap2D> costmap_snapshot_; ///< @brief The costmap the world model checks footprints against
 
       /**
        * @brief  Checks the legality of the robot footprint at a position and orientation using the world model
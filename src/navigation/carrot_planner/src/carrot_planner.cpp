@@ -97,6 +97,11 @@ namespace carrot_planner {
     plan.clear();
     costmap_ = costmap_ros_->getCostmap();
 
+    //check footprints against the costmap as of its last update, so that planning does not hold up updates
+    costmap_snapshot_ = costmap_ros_->getCostmapSnapshot();
+    delete world_model_;
+    world_model_ = new base_local_planner::CostmapModel(*costmap_snapshot_);
+
     if(goal.header.frame_id != costmap_ros_->getGlobalFrameID()){
       ROS_ERROR("This planner as configured will only accept goals in the %s frame, but a goal was sent in the %s frame.", 
           costmap_ros_->getGlobalFrameID().c_str(), goal.header.frame_id.c_str());
@@ -0,0 +1,110 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+#ifndef COSTMAP_2D_CHANGED_TILES_H_
+#define COSTMAP_2D_CHANGED_TILES_H_
+
+#include <climits>
+#include <stdint.h>
+#include <vector>
+
+namespace costmap_2d
+{
+
+/**
+ * @class ChangedTiles
+ * @brief Tracks the values last sent for a grid in square tiles, and finds the rectangles of
+ *        tiles whose values changed since
+ *
+ * Tiles are marked dirty as the grid is updated. Only the dirty tiles are compared against the
+ * values last sent, and those that differ are merged into rectangles: along each row of tiles,
+ * then down into the next row where a rectangle just as wide lies under it.
+ */
+class ChangedTiles
+{
+public:
+  static const unsigned int TILE_SIZE = 32;  ///< Side of the tiles, in cells
+
+  struct Rect
+  {
+    unsigned int x0, xn, y0, yn;  ///< In cells, with xn and yn one past the end
+  };
+
+  ChangedTiles();
+
+  /**
+   * @brief  Start over from the values just sent, with every tile clean
+   * @param size_x The width of the grid, in cells
+   * @param size_y The height of the grid, in cells
+   * @param values The values sent, size_x per row
+   */
+  void reset(unsigned int size_x, unsigned int size_y, const std::vector<int8_t>& values);
+
+  /** @brief Whether the tiles were laid out for a grid of this size by the last reset(). */
+  bool matches(unsigned int size_x, unsigned int size_y) const
+  {
+    return size_x == size_x_ && size_y == size_y_;
+  }
+
+  /** @brief Mark the tiles the given bounds, in cells, overlap. */
+  void markDirty(unsigned int x0, unsigned int xn, unsigned int y0, unsigned int yn);
+
+  /**
+   * @brief  Compare the dirty tiles against the values last sent, and mark every tile clean
+   * @param data The grid as it is now, size_x per row
+   * @param translation The value sent for each of the 256 values of data
+   * @param rects Set to the rectangles covering exactly the tiles whose values changed, or if there
+   *              would be more than max_rects of them, to the one rectangle bounding them
+   * @param max_rects The most rectangles to set rects to
+   */
+  void collect(const unsigned char* data, const char* translation, std::vector<Rect>& rects,
+               unsigned int max_rects = UINT_MAX);
+
+  /** @brief The values last sent, with the changes found by collect(), size_x per row. */
+  const std::vector<int8_t>& getValues() const
+  {
+    return values_;
+  }
+
+private:
+  unsigned int size_x_, size_y_;
+  unsigned int tiles_x_, tiles_y_;
+  std::vector<unsigned char> dirty_;  ///< Tiles changed since the last collect(), tiles_x_ per row
+  std::vector<int8_t> values_;
+  std::vector<Rect> open_rects_, row_rects_;
+};
+
+}  // namespace costmap_2d
+
+#endif  // COSTMAP_2D_CHANGED_TILES_H_
@@ -40,6 +40,8 @@
 
 #include <vector>
 #include <queue>
+#include <algorithm>
+#include <cstring>
 #include <geometry_msgs/Point.h>
 #include <boost/thread.hpp>
 
@@ -297,6 +299,47 @@ public:
     return access_;
   }
 
+  /**
+   * @brief  Move the contents of a map in place for an origin that moves by a number of cells,
+   *         so that the cell at (dx, dy) ends up at (0, 0)
+   * @param map The map
+   * @param size_x The x size of the map
+   * @param size_y The y size of the map
+   * @param dx The number of cells the origin moves along x
+   * @param dy The number of cells the origin moves along y
+   * @param fill The value of the cells that come into view
+   */
+  template<typename data_type>
+    static void shiftMap(data_type* map, unsigned int size_x, unsigned int size_y, int dx, int dy, data_type fill)
+    {
+      int sx = size_x, sy = size_y;
+      if (dx <= -sx || dx >= sx || dy <= -sy || dy >= sy)
+      {
+        std::fill(map, map + size_x * size_y, fill);
+        return;
+      }
+
+      // the part of each row that stays in view, where it is taken from and where it goes
+      unsigned int width = dx < 0 ? sx + dx : sx - dx;
+      unsigned int from_x = dx < 0 ? 0 : dx;
+      unsigned int to_x = dx < 0 ? -dx : 0;
+
+      // each row is taken from dy rows further on, so start from the side rows are taken from
+      for (int i = 0; i < sy; ++i)
+      {
+        int y = dy >= 0 ? i : sy - 1 - i;
+        data_type* row = map + y * size_x;
+        if (y + dy < 0 || y + dy >= sy)
+        {
+          std::fill(row, row + size_x, fill);
+          continue;
+        }
+        memmove(row + to_x, map + (y + dy) * size_x + from_x, width * sizeof(data_type));
+        std::fill(row, row + to_x, fill);
+        std::fill(row + to_x + width, row + size_x, fill);
+      }
+    }
+
 protected:
   /**
    * @brief  Copy a region of a source map into a destination map
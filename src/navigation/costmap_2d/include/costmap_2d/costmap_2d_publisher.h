@@ -39,15 +39,22 @@
 #define COSTMAP_2D_COSTMAP_2D_PUBLISHER_H_
 #include <ros/ros.h>
 #include <costmap_2d/costmap_2d.h>
+#include <costmap_2d/changed_tiles.h>
 #include <nav_msgs/OccupancyGrid.h>
 #include <map_msgs/OccupancyGridUpdate.h>
 #include <tf/transform_datatypes.h>
+#include <vector>
 
 namespace costmap_2d
 {
 /**
  * @class Costmap2DPublisher
  * @brief A tool to periodically publish visualization data from a Costmap2D
+ *
+ * Between full grids, the changes are published on the "_updates" topic as one
+ * OccupancyGridUpdate per changed rectangle of tiles, holding only the tiles whose
+ * published values differ from what was last sent. With single_update, they are
+ * sent as one rectangle bounding all the changes, for subscribers that expect that.
  */
 class Costmap2DPublisher
 {
@@ -56,21 +63,15 @@ public:
    * @brief  Constructor for the Costmap2DPublisher
    */
   Costmap2DPublisher(ros::NodeHandle * ros_node, Costmap2D* costmap, std::string global_frame,
-                     std::string topic_name, bool always_send_full_costmap = false);
+                     std::string topic_name, bool always_send_full_costmap = false, bool single_update = false);
 
   /**
    * @brief  Destructor
    */
   ~Costmap2DPublisher();
 
-  /** @brief Include the given bounds in the changed-rectangle. */
-  void updateBounds(unsigned int x0, unsigned int xn, unsigned int y0, unsigned int yn)
-  {
-    x0_ = std::min(x0, x0_);
-    xn_ = std::max(xn, xn_);
-    y0_ = std::min(y0, y0_);
-    yn_ = std::max(yn, yn_);
-  }
+  /** @brief Include the given bounds in the changed-rectangle, and mark the tiles they cover. */
+  void updateBounds(unsigned int x0, unsigned int xn, unsigned int y0, unsigned int yn);
 
   /**
    * @brief  Publishes the visualization data over ROS
@@ -93,6 +94,20 @@ private:
   /** @brief Publish the latest full costmap to the new subscriber. */
   void onNewSubscription(const ros::SingleSubscriberPublisher& pub);
 
+  /** @brief Publish the bounding rectangle of the changes as a single update. */
+  void publishSingleUpdate();
+
+  /**
+   * @brief Publish the changed cells of the dirty tiles, one update per rectangle of changed tiles, or
+   *        a single update bounding them if there are more rectangles than the update queue holds.
+   */
+  void publishTileUpdates();
+
+  /** @brief Publish the last sent values of a rectangle as an update. */
+  void publishUpdate(const ChangedTiles::Rect& rect, const ros::Time& stamp);
+
+  static const unsigned int UPDATE_QUEUE_SIZE = 100;  ///< The most updates one publication can be
+
   ros::NodeHandle* node;
   Costmap2D* costmap_;
   std::string global_frame_;
@@ -100,6 +115,9 @@ private:
   double saved_origin_x_, saved_origin_y_;
   bool active_;
   bool always_send_full_costmap_;
+  bool single_update_;
+  ChangedTiles tiles_;  ///< Values of each cell as last sent to the subscribers of the update topic
+  std::vector<ChangedTiles::Rect> rects_;
   ros::Publisher costmap_pub_;
   ros::Publisher costmap_update_pub_;
   nav_msgs::OccupancyGrid grid_;
@@ -43,6 +43,7 @@
 #include <costmap_2d/costmap_2d_publisher.h>
 #include <costmap_2d/Costmap2DConfig.h>
 #include <costmap_2d/footprint.h>
+#include <costmap_2d/GetUpdateProfile.h>
 #include <geometry_msgs/Polygon.h>
 #include <geometry_msgs/PolygonStamped.h>
 #include <dynamic_reconfigure/server.h>
@@ -152,6 +153,14 @@ public:
       return layered_costmap_;
     }
 
+  /** @brief Return the master costmap as of its last update, which no one writes to.
+   *
+   * Same as calling getLayeredCostmap()->getSnapshot(). */
+  boost::shared_ptr<const Costmap2D> getCostmapSnapshot(unsigned int* version = NULL)
+    {
+      return layered_costmap_->getSnapshot(version);
+    }
+
   /** @brief Returns the current padded footprint as a geometry_msgs::Polygon. */
   geometry_msgs::Polygon getRobotFootprintPolygon()
   {
@@ -233,6 +242,11 @@ private:
   void reconfigureCB(costmap_2d::Costmap2DConfig &config, uint32_t level);
   void movementCB(const ros::TimerEvent &event);
   void mapUpdateLoop(double frequency);
+
+  /** @brief Summarize the updates profiled since the last call on the diagnostics topic. */
+  void publishDiagnostics(double frequency);
+
+  bool dumpProfileService(costmap_2d::GetUpdateProfile::Request& req, costmap_2d::GetUpdateProfile::Response& resp);
   bool map_update_thread_shutdown_;
   bool stop_updates_, initialized_, stopped_, robot_stopped_;
   boost::thread* map_update_thread_;  ///< @brief A thread for updating the map
@@ -242,6 +256,10 @@ private:
   pluginlib::ClassLoader<Layer> plugin_loader_;
   tf::Stamped<tf::Pose> old_pose_;
   Costmap2DPublisher* publisher_;
+  ros::Publisher diagnostics_pub_;
+  ros::ServiceServer profile_service_;
+  ros::Time last_diagnostics_;
+  unsigned int diagnosed_cycles_;  ///< @brief Updates profiled before the last diagnostics
   dynamic_reconfigure::Server<costmap_2d::Costmap2DConfig> *dsrv_;
 
   boost::recursive_mutex configuration_mutex_;
@@ -0,0 +1,127 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+#ifndef COSTMAP_2D_DISTANCE_LAYER_H_
+#define COSTMAP_2D_DISTANCE_LAYER_H_
+
+#include <ros/ros.h>
+#include <costmap_2d/layer.h>
+#include <costmap_2d/layered_costmap.h>
+#include <costmap_2d/DistancePluginConfig.h>
+#include <dynamic_reconfigure/server.h>
+#include <boost/thread.hpp>
+#include <vector>
+
+namespace costmap_2d
+{
+
+/**
+ * @class DistanceLayer
+ * @brief Keeps the exact Euclidean distance from each cell to the nearest lethal cell of the master grid
+ *
+ * The layer does not change any costs. Put it after the layers that mark obstacles, and query it
+ * from a planner that needs clearances, rather than recovering them from the inflated costs.
+ * Distances are exact up to max_distance, cells farther from any obstacle report max_distance.
+ */
+class DistanceLayer : public Layer
+{
+public:
+  DistanceLayer();
+  virtual ~DistanceLayer();
+
+  virtual void onInitialize();
+  virtual void updateCosts(costmap_2d::Costmap2D& master_grid, int min_i, int min_j, int max_i, int max_j);
+  virtual void matchSize();
+  virtual void reset() { onInitialize(); }
+
+  /**
+   * @brief  Get the distance from a point to the center of the nearest lethal cell
+   * @param  wx The x coordinate of the point in the global frame
+   * @param  wy The y coordinate of the point in the global frame
+   * @param  distance Set to the distance in meters, at most getMaxDistance()
+   * @param  gradient_x Set to the x component of the unit vector pointing away from the obstacle,
+   *         0 inside an obstacle or farther than getMaxDistance() from any
+   * @param  gradient_y Likewise for the y component
+   * @return False if the layer is disabled or the point is off the map
+   */
+  bool getDistance(double wx, double wy, double& distance, double& gradient_x, double& gradient_y) const;
+
+  /** @brief Same as above, without the gradient. */
+  bool getDistance(double wx, double wy, double& distance) const
+  {
+    double gradient_x, gradient_y;
+    return getDistance(wx, wy, distance, gradient_x, gradient_y);
+  }
+
+  double getMaxDistance() const
+  {
+    return max_distance_;
+  }
+
+private:
+  /**
+   * @brief  Find the nearest lethal cell of each cell in [out_min_i, out_max_i) x [out_min_j, out_max_j)
+   *         from the lethal cells in [min_i, max_i) x [min_j, max_j), which has to contain all cells
+   *         within cell_max_distance_ of the output window, with the separable transform of
+   *         Felzenszwalb and Huttenlocher
+   */
+  void computeNearest(const unsigned char* master_array, unsigned int size_x, int min_i, int min_j, int max_i, int max_j,
+                      int out_min_i, int out_min_j, int out_max_i, int out_max_j);
+
+  void reconfigureCB(costmap_2d::DistancePluginConfig &config, uint32_t level);
+
+  mutable boost::shared_mutex access_;
+
+  double max_distance_;
+  unsigned int cell_max_distance_;
+  bool need_recompute_;  ///< Whether the whole map has to be recomputed on the next update
+
+  // the geometry of the master grid nearest_ was computed for, queries use it rather than the master grid
+  double origin_x_, origin_y_, resolution_;
+  unsigned int size_x_, size_y_;
+
+  std::vector<unsigned int> nearest_;  ///< Index of the nearest lethal cell of each cell, NO_SOURCE if it is too far
+
+  // scratch space of computeNearest(), kept between updates
+  std::vector<int> nearest_row_;  ///< Row of the nearest lethal cell in the same column, for each cell of the window
+  std::vector<int> envelope_columns_;
+  std::vector<double> envelope_bounds_;
+  std::vector<double> column_distances_;
+
+  dynamic_reconfigure::Server<costmap_2d::DistancePluginConfig> *dsrv_;
+};
+
+}  // namespace costmap_2d
+
+#endif  // COSTMAP_2D_DISTANCE_LAYER_H_
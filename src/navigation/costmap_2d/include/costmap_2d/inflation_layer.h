@@ -44,6 +44,7 @@
 #include <costmap_2d/InflationPluginConfig.h>
 #include <dynamic_reconfigure/server.h>
 #include <queue>
+#include <vector>
 
 namespace costmap_2d
 {
@@ -91,6 +92,12 @@ public:
   virtual ~InflationLayer()
   {
     deleteKernels();
+    if (seen_stamps_)
+      delete[] seen_stamps_;
+    if (nearest_obstacle_)
+      delete[] nearest_obstacle_;
+    if (lethal_cells_)
+      delete[] lethal_cells_;
     if (dsrv_)
         delete dsrv_;
   }
@@ -105,6 +112,18 @@ public:
   }
   virtual void matchSize();
 
+  /** @brief Only the incremental mode keeps the per-cell state that lets tiles be written independently. */
+  virtual bool isTileable()
+  {
+    return use_incremental_inflation_;
+  }
+  virtual unsigned int getTileHalo()
+  {
+    return cell_inflation_radius_;
+  }
+  virtual void prepareTiles(costmap_2d::Costmap2D& master_grid, int min_i, int min_j, int max_i, int max_j);
+  virtual void updateTile(costmap_2d::Costmap2D& master_grid, int min_i, int min_j, int max_i, int max_j);
+
   virtual void reset() { onInitialize(); }
 
   /** @brief  Given a distance, compute a cost.
@@ -162,10 +181,59 @@ private:
     return cached_costs_[dx][dy];
   }
 
+  /**
+   * @brief  Lookup the index of the distance bucket a cell belongs to
+   * @param mx The x coordinate of the current cell
+   * @param my The y coordinate of the current cell
+   * @param src_x The x coordinate of the source cell
+   * @param src_y The y coordinate of the source cell
+   * @return The position of the cell's distance in the sorted list of distinct kernel distances
+   */
+  inline unsigned int levelLookup(int mx, int my, int src_x, int src_y)
+  {
+    unsigned int dx = abs(mx - src_x);
+    unsigned int dy = abs(my - src_y);
+    return cached_levels_[dx][dy];
+  }
+
   void computeCaches();
   void deleteKernels();
   void inflate_area(int min_i, int min_j, int max_i, int max_j, unsigned char* master_grid);
 
+  /**
+   * @brief  Propagate inflation from the lethal cells of the window with a binary heap ordered by distance
+   */
+  void inflateWithPriorityQueue(costmap_2d::Costmap2D& master_grid, int min_i, int min_j, int max_i, int max_j);
+
+  /**
+   * @brief  Propagate inflation from the lethal cells of the window with one FIFO queue per distinct
+   *         kernel distance, processed in increasing distance order
+   */
+  void inflateWithBuckets(costmap_2d::Costmap2D& master_grid, int min_i, int min_j, int max_i, int max_j);
+
+  /**
+   * @brief  Repair the nearest obstacle of the cells around the lethal cells that were added or cleared
+   *         since the last cycle, then write the inflation costs of the window into the master grid
+   */
+  void inflateIncrementally(costmap_2d::Costmap2D& master_grid, int min_i, int min_j, int max_i, int max_j);
+
+  /**
+   * @brief  First half of inflateIncrementally(), brings nearest_obstacle_ up to date with the master grid
+   * @return False if there is nothing to inflate with
+   */
+  bool repairNearestObstacles(costmap_2d::Costmap2D& master_grid, int min_i, int min_j, int max_i, int max_j);
+
+  /**
+   * @brief  Move nearest_obstacle_ and lethal_cells_ along with a master grid whose origin moved by (dx, dy) cells,
+   *         queueing the cells that came into view or lost their obstacle for the repair
+   */
+  void shiftNearestObstacles(costmap_2d::Costmap2D& master_grid, int dx, int dy);
+
+  /**
+   * @brief  Second half of inflateIncrementally(), writes the costs of the window from nearest_obstacle_
+   */
+  void writeIncrementalCosts(costmap_2d::Costmap2D& master_grid, int min_i, int min_j, int max_i, int max_j);
+
   unsigned int cellDistance(double world_dist)
   {
     return layered_costmap_->getCostmap()->cellDistance(world_dist);
@@ -174,6 +242,12 @@ private:
   inline void enqueue(unsigned char* grid, unsigned int index, unsigned int mx, unsigned int my, unsigned int src_x,
                       unsigned int src_y);
 
+  inline void enqueueBucket(unsigned char* grid, unsigned int index, unsigned int mx, unsigned int my,
+                            unsigned int src_x, unsigned int src_y, unsigned int current_level);
+
+  inline void enqueueIncremental(unsigned int index, unsigned int mx, unsigned int my, unsigned int src_x,
+                                 unsigned int src_y, unsigned int size_x, unsigned int current_level);
+
   double inflation_radius_, inscribed_radius_, weight_;
   unsigned int cell_inflation_radius_;
   unsigned int cached_cell_inflation_radius_;
@@ -184,8 +258,24 @@ private:
   bool* seen_;
   int seen_size_;
 
+  bool use_bucket_queue_;  ///< Use the distance-bucketed FIFO queues instead of inflation_queue_
+  std::vector<std::vector<CellData> > inflation_buckets_;  ///< One FIFO per entry of cached_levels_, reused across cycles
+  unsigned int* seen_stamps_;  ///< Generation in which each cell was last enqueued, replaces seen_ for the buckets
+  unsigned int seen_stamps_size_;
+  unsigned int seen_generation_;
+
+  bool use_incremental_inflation_;  ///< Only repair the neighbourhood of lethal cells that changed since last cycle
+  bool incremental_valid_;  ///< False when nearest_obstacle_ has to be rebuilt from the whole map
+  unsigned int* nearest_obstacle_;  ///< Index of the lethal cell each cell is inflated from, NO_SOURCE if none
+  bool* lethal_cells_;  ///< Which cells of the master grid were lethal at the end of the last cycle
+  unsigned int incremental_size_;
+  double last_origin_x_, last_origin_y_;
+  std::vector<unsigned int> raise_queue_;  ///< Cells whose nearest obstacle was cleared
+  bool tiles_ready_;  ///< Whether prepareTiles() repaired nearest_obstacle_ for the tiles of this cycle
+
   unsigned char** cached_costs_;
   double** cached_distances_;
+  unsigned int** cached_levels_;
 
   dynamic_reconfigure::Server<costmap_2d::InflationPluginConfig> *dsrv_;
   void reconfigureCB(costmap_2d::InflationPluginConfig &config, uint32_t level);
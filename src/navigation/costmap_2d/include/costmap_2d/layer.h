@@ -71,6 +71,36 @@ public:
    */
   virtual void updateCosts(Costmap2D& master_grid, int min_i, int min_j, int max_i, int max_j) {}
 
+  /**
+   * @brief Whether updateTile() may be called concurrently on disjoint
+   *        tiles of the update window instead of updateCosts() on the
+   *        whole window. Layers that are not tileable are updated serially.
+   */
+  virtual bool isTileable() { return false; }
+
+  /**
+   * @brief How many cells around a tile this layer reads from the master
+   *        grid. A layer with a halo is only prepared once the layers below
+   *        it have finished the whole window, one without may be prepared
+   *        before they have run.
+   */
+  virtual unsigned int getTileHalo() { return 0; }
+
+  /**
+   * @brief Called once, serially, before updateTile() is run on the tiles
+   *        of the window [min_i, max_i) x [min_j, max_j).
+   */
+  virtual void prepareTiles(Costmap2D& master_grid, int min_i, int min_j, int max_i, int max_j) {}
+
+  /**
+   * @brief Update one tile of the underlying costmap. May be called from
+   *        several threads at once, each with a different tile.
+   */
+  virtual void updateTile(Costmap2D& master_grid, int min_i, int min_j, int max_i, int max_j)
+  {
+    updateCosts(master_grid, min_i, min_j, max_i, max_j);
+  }
+
   /** @brief Stop publishers. */
   virtual void deactivate() {}
 
@@ -41,6 +41,10 @@
 #include <costmap_2d/cost_values.h>
 #include <costmap_2d/layer.h>
 #include <costmap_2d/costmap_2d.h>
+#include <costmap_2d/worker_pool.h>
+#include <costmap_2d/update_profiler.h>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
 #include <vector>
 #include <string>
 
@@ -154,7 +158,68 @@ public:
    * This is updated by setFootprint(). */
   double getInscribedRadius() { return inscribed_radius_; }
 
+  /**
+   * @brief  Split the update window into tiles and update them on a worker pool
+   * @param num_threads The number of threads that update tiles, 1 or less updates serially
+   * @param tile_size The edge length of a tile in cells
+   */
+  void setTiledUpdate(int num_threads, unsigned int tile_size);
+
+  /**
+   * @brief  Get a copy of the costmap as of the last update, which no one writes to
+   *
+   * Readers can hold on to it for as long as they like without holding up updateMap(), which
+   * publishes the next version into a second buffer. Snapshots are kept from the first call on,
+   * at the cost of copying the updated window after every update.
+   * @param version If not NULL, set to the version of the snapshot, which increases with every update
+   */
+  boost::shared_ptr<const Costmap2D> getSnapshot(unsigned int* version = NULL);
+
+  /**
+   * @brief  Make the next update copy the whole costmap into the snapshot
+   *
+   * Call this after writing to the costmap outside of updateMap().
+   */
+  void invalidateSnapshot();
+
+  /**
+   * @brief  Record the timings of each layer and the update window of the last updates
+   * @param cycles The number of updates to keep, 0 stops recording
+   *
+   * Call this once all layers are added, before the costmap is updated or profiled from other threads.
+   */
+  void setProfiling(unsigned int cycles);
+
+  /** @brief The timings of the last updates, which any thread can read, NULL unless profiling */
+  const UpdateProfiler* getProfiler() const
+  {
+    return profiler_;
+  }
+
 private:
+  /**
+   * @brief  Run the layer stack over the window tile by tile, layers with a halo start a new pass
+   */
+  void updateTiles(int x0, int y0, int xn, int yn);
+
+  void updateTile(unsigned int first_layer, unsigned int last_layer, unsigned int tile);
+
+  /**
+   * @brief  Bring the spare snapshot up to date with the costmap and publish it
+   */
+  void publishSnapshot(int x0, int y0, int xn, int yn);
+
+  /**
+   * @brief  Convert the bounds collected from the layers so far into the update window
+   */
+  void getWindow(int* x0, int* y0, int* xn, int* yn);
+
+  struct Tile
+  {
+    int x0, y0, xn, yn;
+  };
+
+
   Costmap2D costmap_;
   std::string global_frame_;
 
@@ -170,6 +235,21 @@ private:
   bool size_locked_;
   double circumscribed_radius_, inscribed_radius_;
   std::vector<geometry_msgs::Point> footprint_;
+
+  WorkerPool* workers_;
+  unsigned int tile_size_;
+  std::vector<Tile> tiles_;
+
+  boost::mutex snapshot_mutex_;  ///< @brief Guards the fields below, take it after the costmap's lock
+  bool publish_snapshots_;
+  unsigned int snapshot_full_copies_;  ///< @brief How many more updates have to copy the whole costmap
+  boost::shared_ptr<Costmap2D> snapshot_;  ///< @brief The latest version, shared with readers
+  boost::shared_ptr<Costmap2D> spare_snapshot_;  ///< @brief The version before, missing the last window
+  unsigned int snapshot_version_;
+  int snapshot_x0_, snapshot_y0_, snapshot_xn_, snapshot_yn_;  ///< @brief The window of the last update
+
+  UpdateProfiler* profiler_;
+  UpdateProfiler* cycle_profiler_;  ///< @brief profiler_ during an update it can record, NULL otherwise
 };
 
 }  // namespace costmap_2d
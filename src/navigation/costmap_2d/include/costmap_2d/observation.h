@@ -41,8 +41,8 @@ namespace costmap_2d
 
 /**
  * @brief Stores an observation in terms of a point cloud and the origin of the source
- * @note Tried to make members and constructor arguments const but the compiler would not accept the default
- * assignment operator for vector insertion!
+ * @note The cloud is immutable once the observation has been created, so copies of an
+ * observation share it instead of copying the points.
  */
 class Observation
 {
@@ -57,7 +57,6 @@ public:
 
   virtual ~Observation()
   {
-    delete cloud_;
   }
 
   /**
@@ -67,7 +66,7 @@ public:
    * @param obstacle_range The range out to which an observation should be able to insert obstacles
    * @param raytrace_range The range out to which an observation should be able to clear via raytracing
    */
-  Observation(geometry_msgs::Point& origin, pcl::PointCloud<pcl::PointXYZ> cloud,
+  Observation(geometry_msgs::Point& origin, const pcl::PointCloud<pcl::PointXYZ>& cloud,
               double obstacle_range, double raytrace_range) :
       origin_(origin), cloud_(new pcl::PointCloud<pcl::PointXYZ>(cloud)),
       obstacle_range_(obstacle_range), raytrace_range_(raytrace_range)
@@ -75,11 +74,24 @@ public:
   }
 
   /**
-   * @brief  Copy constructor
+   * @brief  Creates an observation from an origin point and a cloud that it will share
+   * @param origin The origin point of the observation
+   * @param cloud The point cloud of the observation, which must not be modified afterwards
+   * @param obstacle_range The range out to which an observation should be able to insert obstacles
+   * @param raytrace_range The range out to which an observation should be able to clear via raytracing
+   */
+  Observation(geometry_msgs::Point& origin, const pcl::PointCloud<pcl::PointXYZ>::ConstPtr& cloud,
+              double obstacle_range, double raytrace_range) :
+      origin_(origin), cloud_(cloud), obstacle_range_(obstacle_range), raytrace_range_(raytrace_range)
+  {
+  }
+
+  /**
+   * @brief  Copy constructor, the copy shares the cloud of the original
    * @param obs The observation to copy
    */
   Observation(const Observation& obs) :
-      origin_(obs.origin_), cloud_(new pcl::PointCloud<pcl::PointXYZ>(*(obs.cloud_))),
+      origin_(obs.origin_), cloud_(obs.cloud_),
       obstacle_range_(obs.obstacle_range_), raytrace_range_(obs.raytrace_range_)
   {
   }
@@ -89,13 +101,21 @@ public:
    * @param cloud The point cloud of the observation
    * @param obstacle_range The range out to which an observation should be able to insert obstacles
    */
-  Observation(pcl::PointCloud<pcl::PointXYZ> cloud, double obstacle_range) :
+  Observation(const pcl::PointCloud<pcl::PointXYZ>& cloud, double obstacle_range) :
       cloud_(new pcl::PointCloud<pcl::PointXYZ>(cloud)), obstacle_range_(obstacle_range), raytrace_range_(0.0)
   {
   }
 
+  /**
+   * @brief  The number of bytes of point data held by the cloud
+   */
+  size_t cloudBytes() const
+  {
+    return cloud_->points.size() * sizeof(pcl::PointXYZ);
+  }
+
   geometry_msgs::Point origin_;
-  pcl::PointCloud<pcl::PointXYZ>* cloud_;
+  pcl::PointCloud<pcl::PointXYZ>::ConstPtr cloud_;
   double obstacle_range_, raytrace_range_;
 };
 
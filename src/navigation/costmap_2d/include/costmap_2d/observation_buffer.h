@@ -110,10 +110,19 @@ public:
 
   /**
    * @brief  Pushes copies of all current observations onto the end of the vector passed in
-   * @param  observations The vector to be filled
+   * @param  observations The vector to be filled, the observations share their clouds with the buffer
    */
   void getObservations(std::vector<Observation>& observations);
 
+  /**
+   * @brief  Get the number of bytes of point data the buffer has copied while converting, transforming and filtering clouds
+   * @return The total since the buffer was created
+   */
+  size_t getBytesCopied() const
+  {
+    return bytes_copied_;
+  }
+
   /**
    * @brief  Check if the observation buffer is being update at its expected rate
    * @return True if it is being updated at the expected rate, false otherwise
@@ -159,6 +168,7 @@ private:
   boost::recursive_mutex lock_;  ///< @brief A lock for accessing data in callbacks safely
   double obstacle_range_, raytrace_range_;
   double tf_tolerance_;
+  size_t bytes_copied_;
 };
 }  // namespace costmap_2d
 #endif  // COSTMAP_2D_OBSERVATION_BUFFER_H_
@@ -62,7 +62,7 @@ namespace costmap_2d
 class ObstacleLayer : public CostmapLayer
 {
 public:
-  ObstacleLayer()
+  ObstacleLayer() : dsrv_(NULL), bytes_copied_(0), bytes_copied_total_(0)
   {
     costmap_ = NULL;  // this is the unsigned char* member of parent class Costmap2D.
   }
@@ -73,6 +73,13 @@ public:
                             double* max_x, double* max_y);
   virtual void updateCosts(costmap_2d::Costmap2D& master_grid, int min_i, int min_j, int max_i, int max_j);
 
+  virtual bool isTileable()
+  {
+    return true;
+  }
+  virtual void prepareTiles(costmap_2d::Costmap2D& master_grid, int min_i, int min_j, int max_i, int max_j);
+  virtual void updateTile(costmap_2d::Costmap2D& master_grid, int min_i, int min_j, int max_i, int max_j);
+
   virtual void activate();
   virtual void deactivate();
   virtual void reset();
@@ -109,6 +116,14 @@ public:
   void pointCloud2Callback(const sensor_msgs::PointCloud2ConstPtr& message,
                            const boost::shared_ptr<costmap_2d::ObservationBuffer>& buffer);
 
+  /**
+   * @brief  Get the number of bytes of point data the observation buffers copied between the last two updates
+   */
+  size_t getBytesCopied() const
+  {
+    return bytes_copied_;
+  }
+
   // for testing purposes
   void addStaticObservation(costmap_2d::Observation& obs, bool marking, bool clearing);
   void clearStaticObservations(bool marking, bool clearing);
@@ -141,6 +156,11 @@ protected:
   virtual void raytraceFreespace(const costmap_2d::Observation& clearing_observation, double* min_x, double* min_y,
                                  double* max_x, double* max_y);
 
+  /**
+   * @brief  Refresh bytes_copied_ from the counters of the observation buffers
+   */
+  void updateBytesCopied();
+
   void updateRaytraceBounds(double ox, double oy, double wx, double wy, double range, double* min_x, double* min_y,
                             double* max_x, double* max_y);
 
@@ -168,6 +188,12 @@ protected:
 
   int combination_method_;
 
+  size_t bytes_copied_;  ///< @brief Bytes of point data copied by the observation buffers during the last cycle
+  size_t bytes_copied_total_;
+
+  std::vector<bool> ray_endpoint_seen_;  ///< @brief Marks the cells that already have a ray traced to them, one per cell
+  std::vector<unsigned int> ray_endpoints_;  ///< @brief Distinct endpoint cells of the observation being raytraced
+
 private:
   void reconfigureCB(costmap_2d::ObstaclePluginConfig &config, uint32_t level);
 };
@@ -64,6 +64,12 @@ public:
                             double* max_x, double* max_y);
   virtual void updateCosts(costmap_2d::Costmap2D& master_grid, int min_i, int min_j, int max_i, int max_j);
 
+  /** @brief Only tileable when not rolling, the rolling copy looks up a transform per update. */
+  virtual bool isTileable()
+  {
+    return !layered_costmap_->isRolling();
+  }
+
   virtual void matchSize();
 
 private:
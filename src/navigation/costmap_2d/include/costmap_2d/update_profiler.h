@@ -0,0 +1,132 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+#ifndef COSTMAP_2D_UPDATE_PROFILER_H_
+#define COSTMAP_2D_UPDATE_PROFILER_H_
+
+#include <boost/atomic.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/scoped_array.hpp>
+#include <vector>
+
+namespace costmap_2d
+{
+
+/**
+ * @class UpdateProfiler
+ * @brief Keeps the timings of the last few updates of a LayeredCostmap in a ring buffer
+ *
+ * One thread, the one updating the costmap, records cycles. Any number of other
+ * threads can read them at the same time without taking a lock: a cycle that is
+ * overwritten while it is read is left out.
+ */
+class UpdateProfiler
+{
+public:
+  struct Layer
+  {
+    double bounds_time;  ///< Seconds spent in updateBounds()
+    double costs_time;  ///< Seconds spent in updateCosts(), summed over the threads of a tiled update
+    unsigned int bounds_cells;  ///< Cells in the update window once the layer has added its bounds
+  };
+
+  struct Cycle
+  {
+    double stamp;  ///< Wall clock time the update started at
+    double update_time;  ///< Seconds the whole update took
+    int x0, y0, xn, yn;  ///< The update window, empty if nothing was updated
+    std::vector<Layer> layers;  ///< In the order of the layers
+  };
+
+  /**
+   * @brief  Constructor for a profiler
+   * @param capacity The number of cycles to keep
+   * @param num_layers The number of layers of the costmap
+   */
+  UpdateProfiler(unsigned int capacity, unsigned int num_layers);
+
+  unsigned int getNumLayers() const
+  {
+    return num_layers_;
+  }
+
+  /** @brief Start recording a cycle, clearing the timings of the last. */
+  void beginCycle(double stamp);
+
+  void setBounds(unsigned int layer, double seconds, unsigned int cells)
+  {
+    current_layers_[layer].bounds_time = seconds;
+    current_layers_[layer].bounds_cells = cells;
+  }
+
+  /** @brief Add to the time a layer spent in updateCosts(), from any thread. */
+  void addCostsTime(unsigned int layer, double seconds)
+  {
+    costs_nsec_[layer].fetch_add(boost::uint64_t(seconds * 1e9 + 0.5), boost::memory_order_relaxed);
+  }
+
+  /** @brief Finish the cycle and make it visible to readers. */
+  void endCycle(double update_time, int x0, int y0, int xn, int yn);
+
+  /**
+   * @brief  Get the recorded cycles, oldest first
+   * @param cycles Set to the cycles still in the buffer
+   * @param since Only the cycles recorded after this count are returned
+   * @return The number of cycles recorded so far, to pass as since next time
+   */
+  unsigned int getCycles(std::vector<Cycle>& cycles, unsigned int since = 0) const;
+
+private:
+  struct Slot
+  {
+    boost::atomic<unsigned int> sequence;  ///< Odd while the slot is written
+    unsigned int cycle;  ///< Which cycle the slot holds
+    double stamp, update_time;
+    int x0, y0, xn, yn;
+  };
+
+  unsigned int capacity_, num_layers_;
+  boost::scoped_array<Slot> slots_;
+  std::vector<Layer> slot_layers_;  ///< num_layers_ per slot
+
+  double current_stamp_;
+  std::vector<Layer> current_layers_;
+  boost::scoped_array<boost::atomic<boost::uint64_t> > costs_nsec_;
+
+  boost::atomic<unsigned int> recorded_;  ///< Number of cycles recorded so far
+};
+
+}  // namespace costmap_2d
+
+#endif  // COSTMAP_2D_UPDATE_PROFILER_H_
@@ -55,6 +55,7 @@
 #include <costmap_2d/VoxelPluginConfig.h>
 #include <costmap_2d/obstacle_layer.h>
 #include <voxel_grid/voxel_grid.h>
+#include <voxel_grid/wide_voxel_grid.h>
 
 namespace costmap_2d
 {
@@ -63,7 +64,7 @@ class VoxelLayer : public ObstacleLayer
 {
 public:
   VoxelLayer() :
-      voxel_grid_(0, 0, 0)
+      voxel_grid_(0, 0, 0), wide_voxel_grid_(0, 0, 0), use_wide_columns_(false)
   {
     costmap_ = NULL;  // this is the unsigned char* member of parent class's parent class Costmap2D.
   }
@@ -99,6 +100,8 @@ private:
   bool publish_voxel_;
   ros::Publisher voxel_pub_;
   voxel_grid::VoxelGrid voxel_grid_;
+  voxel_grid::WideVoxelGrid wide_voxel_grid_;  ///< @brief Used instead of voxel_grid_ when use_wide_columns_ is set
+  bool use_wide_columns_;
   double z_resolution_, origin_z_;
   unsigned int unknown_threshold_, mark_threshold_, size_z_;
   ros::Publisher clearing_endpoints_pub_;
@@ -0,0 +1,98 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+#ifndef COSTMAP_2D_WORKER_POOL_H_
+#define COSTMAP_2D_WORKER_POOL_H_
+
+#include <boost/function.hpp>
+#include <boost/thread.hpp>
+#include <vector>
+
+namespace costmap_2d
+{
+
+/**
+ * @class WorkerPool
+ * @brief A small fixed set of threads that run indexed jobs in parallel
+ *
+ * The calling thread takes part in every run(), so a pool created with
+ * n threads executes jobs on up to n + 1 cores.
+ */
+class WorkerPool
+{
+public:
+  /**
+   * @brief  Constructor for a worker pool
+   * @param num_threads The number of threads to spawn in addition to the calling thread
+   */
+  explicit WorkerPool(unsigned int num_threads);
+
+  /**
+   * @brief  Destructor, joins all of the worker threads
+   */
+  ~WorkerPool();
+
+  /**
+   * @brief  Run job(i) for every i in [0, count) and wait for all of them to finish
+   * @param count The number of jobs to run
+   * @param job The function to call with each job index, it must be safe to call concurrently
+   */
+  void run(unsigned int count, const boost::function<void(unsigned int)>& job);
+
+  unsigned int getNumThreads() const
+  {
+    return threads_.size();
+  }
+
+private:
+  void workerThread();
+
+  /**
+   * @brief  Claim and execute jobs until none are left, must be called with lock held
+   */
+  void runJobs(boost::unique_lock<boost::mutex>& lock);
+
+  std::vector<boost::thread*> threads_;
+  boost::mutex mutex_;
+  boost::condition_variable work_available_, work_done_;
+
+  const boost::function<void(unsigned int)>* job_;
+  unsigned int count_, next_, pending_;
+  unsigned int generation_;
+  bool shutdown_;
+};
+
+}  // namespace costmap_2d
+
+#endif  // COSTMAP_2D_WORKER_POOL_H_
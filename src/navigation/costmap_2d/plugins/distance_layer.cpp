@@ -0,0 +1,286 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+#include <costmap_2d/distance_layer.h>
+#include <costmap_2d/cost_values.h>
+#include <pluginlib/class_list_macros.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+PLUGINLIB_EXPORT_CLASS(costmap_2d::DistanceLayer, costmap_2d::Layer)
+
+namespace costmap_2d
+{
+
+static const unsigned int NO_SOURCE = std::numeric_limits<unsigned int>::max();
+static const int NO_ROW = std::numeric_limits<int>::max() / 4;
+
+DistanceLayer::DistanceLayer()
+  : max_distance_(1.0)
+  , cell_max_distance_(0)
+  , need_recompute_(true)
+  , origin_x_(0.0)
+  , origin_y_(0.0)
+  , resolution_(0.0)
+  , size_x_(0)
+  , size_y_(0)
+  , dsrv_(NULL)
+{
+}
+
+DistanceLayer::~DistanceLayer()
+{
+  if (dsrv_)
+    delete dsrv_;
+}
+
+void DistanceLayer::onInitialize()
+{
+  {
+    boost::unique_lock<boost::shared_mutex> lock(access_);
+    current_ = true;
+    need_recompute_ = true;
+  }
+
+  // the server calls reconfigureCB() right away, which takes the lock itself
+  {
+    dynamic_reconfigure::Server<costmap_2d::DistancePluginConfig>::CallbackType cb = boost::bind(
+        &DistanceLayer::reconfigureCB, this, _1, _2);
+
+    if (dsrv_ != NULL)
+    {
+      dsrv_->clearCallback();
+      dsrv_->setCallback(cb);
+    }
+    else
+    {
+      dsrv_ = new dynamic_reconfigure::Server<costmap_2d::DistancePluginConfig>(ros::NodeHandle("~/" + name_));
+      dsrv_->setCallback(cb);
+    }
+  }
+
+  matchSize();
+}
+
+void DistanceLayer::reconfigureCB(costmap_2d::DistancePluginConfig &config, uint32_t level)
+{
+  boost::unique_lock<boost::shared_mutex> lock(access_);
+  if (enabled_ != config.enabled || max_distance_ != config.max_distance)
+  {
+    enabled_ = config.enabled;
+    max_distance_ = config.max_distance;
+    cell_max_distance_ = layered_costmap_->getCostmap()->cellDistance(max_distance_);
+    need_recompute_ = true;
+  }
+}
+
+void DistanceLayer::matchSize()
+{
+  boost::unique_lock<boost::shared_mutex> lock(access_);
+  Costmap2D* costmap = layered_costmap_->getCostmap();
+  cell_max_distance_ = costmap->cellDistance(max_distance_);
+  nearest_.assign(costmap->getSizeInCellsX() * costmap->getSizeInCellsY(), NO_SOURCE);
+  size_x_ = costmap->getSizeInCellsX();
+  size_y_ = costmap->getSizeInCellsY();
+  resolution_ = costmap->getResolution();
+  origin_x_ = costmap->getOriginX();
+  origin_y_ = costmap->getOriginY();
+  need_recompute_ = true;
+}
+
+void DistanceLayer::updateCosts(costmap_2d::Costmap2D& master_grid, int min_i, int min_j, int max_i, int max_j)
+{
+  boost::unique_lock<boost::shared_mutex> lock(access_);
+  if (!enabled_)
+    return;
+
+  int size_x = master_grid.getSizeInCellsX(), size_y = master_grid.getSizeInCellsY();
+  if (nearest_.size() != (unsigned int)(size_x * size_y))
+  {
+    nearest_.assign(size_x * size_y, NO_SOURCE);
+    size_x_ = size_x;
+    size_y_ = size_y;
+    need_recompute_ = true;
+  }
+
+  // a rolling window has moved the cells under the indices stored in nearest_
+  if (need_recompute_ || origin_x_ != master_grid.getOriginX() || origin_y_ != master_grid.getOriginY() ||
+      resolution_ != master_grid.getResolution())
+  {
+    origin_x_ = master_grid.getOriginX();
+    origin_y_ = master_grid.getOriginY();
+    resolution_ = master_grid.getResolution();
+    need_recompute_ = false;
+    min_i = 0;
+    min_j = 0;
+    max_i = size_x;
+    max_j = size_y;
+  }
+
+  // obstacles changed inside the window move the nearest obstacle of cells up to
+  // cell_max_distance_ outside of it, which can be anywhere within as far again
+  int reach = cell_max_distance_ + 1;
+  int out_min_i = std::max(0, min_i - reach), out_min_j = std::max(0, min_j - reach);
+  int out_max_i = std::min(size_x, max_i + reach), out_max_j = std::min(size_y, max_j + reach);
+  if (out_min_i >= out_max_i || out_min_j >= out_max_j)
+    return;
+
+  computeNearest(master_grid.getCharMap(), size_x, std::max(0, out_min_i - reach), std::max(0, out_min_j - reach),
+                 std::min(size_x, out_max_i + reach), std::min(size_y, out_max_j + reach),
+                 out_min_i, out_min_j, out_max_i, out_max_j);
+}
+
+void DistanceLayer::computeNearest(const unsigned char* master_array, unsigned int size_x, int min_i, int min_j,
+                                   int max_i, int max_j, int out_min_i, int out_min_j, int out_max_i, int out_max_j)
+{
+  int width = max_i - min_i, height = max_j - min_j;
+  nearest_row_.resize(width * height);
+
+  // first the nearest lethal cell of each cell along its column, scanning down then up
+  for (int i = 0; i < width; ++i)
+  {
+    int last = -NO_ROW;
+    for (int j = 0; j < height; ++j)
+    {
+      if (master_array[size_x * (min_j + j) + min_i + i] == LETHAL_OBSTACLE)
+        last = j;
+      nearest_row_[width * j + i] = last;
+    }
+    last = NO_ROW;
+    for (int j = height - 1; j >= 0; --j)
+    {
+      int& row = nearest_row_[width * j + i];
+      if (row == j)
+        last = j;
+      else if (last - j < j - row)
+        row = last;
+    }
+  }
+
+  // then along each row, the lower envelope of the parabolas of the columns' squared distances
+  envelope_columns_.resize(width);
+  envelope_bounds_.resize(width + 1);
+  column_distances_.resize(width);
+  double max_square = (double)cell_max_distance_ * cell_max_distance_;
+  for (int j = out_min_j - min_j; j < out_max_j - min_j; ++j)
+  {
+    const int* rows = &nearest_row_[width * j];
+    int k = -1;
+    for (int q = 0; q < width; ++q)
+    {
+      if (rows[q] == NO_ROW || rows[q] == -NO_ROW)
+        continue;
+      double f = (double)(rows[q] - j) * (rows[q] - j);
+      column_distances_[q] = f;
+      double s = -std::numeric_limits<double>::max();
+      while (k >= 0)
+      {
+        int v = envelope_columns_[k];
+        s = ((f + (double)q * q) - (column_distances_[v] + (double)v * v)) / (2.0 * (q - v));
+        if (s > envelope_bounds_[k])
+          break;
+        --k;
+      }
+      ++k;
+      envelope_columns_[k] = q;
+      envelope_bounds_[k] = k == 0 ? -std::numeric_limits<double>::max() : s;
+    }
+
+    unsigned int* nearest = &nearest_[size_x * (min_j + j)];
+    if (k < 0)
+    {
+      for (int i = out_min_i; i < out_max_i; ++i)
+        nearest[i] = NO_SOURCE;
+      continue;
+    }
+
+    envelope_bounds_[k + 1] = std::numeric_limits<double>::max();
+    int e = 0;
+    for (int i = out_min_i - min_i; i < out_max_i - min_i; ++i)
+    {
+      while (envelope_bounds_[e + 1] < i)
+        ++e;
+      int q = envelope_columns_[e];
+      double square = (double)(i - q) * (i - q) + column_distances_[q];
+      if (square <= max_square)
+        nearest[min_i + i] = size_x * (min_j + rows[q]) + min_i + q;
+      else
+        nearest[min_i + i] = NO_SOURCE;
+    }
+  }
+}
+
+bool DistanceLayer::getDistance(double wx, double wy, double& distance, double& gradient_x, double& gradient_y) const
+{
+  boost::shared_lock<boost::shared_mutex> lock(access_);
+  gradient_x = 0.0;
+  gradient_y = 0.0;
+  if (!enabled_ || wx < origin_x_ || wy < origin_y_)
+    return false;
+
+  unsigned int mx = (int)((wx - origin_x_) / resolution_);
+  unsigned int my = (int)((wy - origin_y_) / resolution_);
+  if (mx >= size_x_ || my >= size_y_)
+    return false;
+
+  unsigned int source = nearest_[size_x_ * my + mx];
+  if (source == NO_SOURCE)
+  {
+    distance = max_distance_;
+    return true;
+  }
+
+  if (source == size_x_ * my + mx)
+  {
+    distance = 0.0;
+    return true;
+  }
+
+  // measured from the point itself rather than the center of its cell
+  double dx = wx - (origin_x_ + (source % size_x_ + 0.5) * resolution_);
+  double dy = wy - (origin_y_ + (source / size_x_ + 0.5) * resolution_);
+  double exact = sqrt(dx * dx + dy * dy);
+  if (exact >= max_distance_)
+  {
+    distance = max_distance_;
+    return true;
+  }
+  distance = exact;
+  gradient_x = dx / exact;
+  gradient_y = dy / exact;
+  return true;
+}
+
+}  // namespace costmap_2d
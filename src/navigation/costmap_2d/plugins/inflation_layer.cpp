@@ -39,6 +39,8 @@
 #include <costmap_2d/costmap_math.h>
 #include <costmap_2d/footprint.h>
 #include <pluginlib/class_list_macros.h>
+#include <algorithm>
+#include <limits>
 
 PLUGINLIB_EXPORT_CLASS(costmap_2d::InflationLayer, costmap_2d::Layer)
 
@@ -49,6 +51,8 @@ using costmap_2d::NO_INFORMATION;
 namespace costmap_2d
 {
 
+static const unsigned int NO_SOURCE = std::numeric_limits<unsigned int>::max();
+
 InflationLayer::InflationLayer()
   : inflation_radius_(0)
   , weight_(0)
@@ -56,8 +60,21 @@ InflationLayer::InflationLayer()
   , cached_cell_inflation_radius_(0)
   , dsrv_(NULL)
   , seen_(NULL)
+  , use_bucket_queue_(false)
+  , seen_stamps_(NULL)
+  , seen_stamps_size_(0)
+  , seen_generation_(0)
+  , use_incremental_inflation_(false)
+  , incremental_valid_(false)
+  , nearest_obstacle_(NULL)
+  , lethal_cells_(NULL)
+  , incremental_size_(0)
+  , last_origin_x_(0.0)
+  , last_origin_y_(0.0)
+  , tiles_ready_(false)
   , cached_costs_(NULL)
   , cached_distances_(NULL)
+  , cached_levels_(NULL)
 {
   access_ = new boost::shared_mutex();
 }
@@ -72,6 +89,11 @@ void InflationLayer::onInitialize()
       delete[] seen_;
     seen_ = NULL;
     seen_size_ = 0;
+    if (seen_stamps_)
+      delete[] seen_stamps_;
+    seen_stamps_ = NULL;
+    seen_stamps_size_ = 0;
+    incremental_valid_ = false;
     need_reinflation_ = false;
 
     dynamic_reconfigure::Server<costmap_2d::InflationPluginConfig>::CallbackType cb = boost::bind(
@@ -106,6 +128,16 @@ void InflationLayer::reconfigureCB(costmap_2d::InflationPluginConfig &config, ui
     enabled_ = config.enabled;
     need_reinflation_ = true;
   }
+
+  if (use_bucket_queue_ != config.use_bucket_queue) {
+    use_bucket_queue_ = config.use_bucket_queue;
+    need_reinflation_ = true;
+  }
+
+  if (use_incremental_inflation_ != config.use_incremental_inflation) {
+    use_incremental_inflation_ = config.use_incremental_inflation;
+    need_reinflation_ = true;
+  }
 }
 
 void InflationLayer::matchSize()
@@ -121,6 +153,22 @@ void InflationLayer::matchSize()
     delete[] seen_;
   seen_size_ = size_x * size_y;
   seen_ = new bool[seen_size_];
+
+  // the stamps are only allocated once the bucket queues are actually used
+  if (seen_stamps_)
+    delete[] seen_stamps_;
+  seen_stamps_ = NULL;
+  seen_stamps_size_ = 0;
+
+  // likewise for the incremental state, which is rebuilt on the next update
+  if (nearest_obstacle_)
+    delete[] nearest_obstacle_;
+  if (lethal_cells_)
+    delete[] lethal_cells_;
+  nearest_obstacle_ = NULL;
+  lethal_cells_ = NULL;
+  incremental_size_ = 0;
+  incremental_valid_ = false;
 }
 
 void InflationLayer::updateBounds(double robot_x, double robot_y, double robot_yaw, double* min_x,
@@ -136,6 +184,16 @@ void InflationLayer::updateBounds(double robot_x, double robot_y, double robot_y
     *max_x = std::numeric_limits<float>::max();
     *max_y = std::numeric_limits<float>::max();
     need_reinflation_ = false;
+    incremental_valid_ = false;
+  }
+  else if (use_incremental_inflation_)
+  {
+    // The master grid is reset within the bounds, so they have to cover every
+    // cell whose cost may drop because an obstacle inside them was cleared.
+    *min_x -= inflation_radius_;
+    *min_y -= inflation_radius_;
+    *max_x += inflation_radius_;
+    *max_y += inflation_radius_;
   }
 }
 
@@ -158,6 +216,37 @@ void InflationLayer::updateCosts(costmap_2d::Costmap2D& master_grid, int min_i,
   if (!enabled_)
     return;
 
+  if (use_incremental_inflation_)
+  {
+    inflateIncrementally(master_grid, min_i, min_j, max_i, max_j);
+    return;
+  }
+
+  unsigned int size_x = master_grid.getSizeInCellsX(), size_y = master_grid.getSizeInCellsY();
+
+  // We need to include in the inflation cells outside the bounding
+  // box min_i...max_j, by the amount cell_inflation_radius_.  Cells
+  // up to that distance outside the box can still influence the costs
+  // stored in cells inside the box.
+  min_i -= cell_inflation_radius_;
+  min_j -= cell_inflation_radius_;
+  max_i += cell_inflation_radius_;
+  max_j += cell_inflation_radius_;
+
+  min_i = std::max(0, min_i);
+  min_j = std::max(0, min_j);
+  max_i = std::min(int(size_x), max_i);
+  max_j = std::min(int(size_y), max_j);
+
+  if (use_bucket_queue_)
+    inflateWithBuckets(master_grid, min_i, min_j, max_i, max_j);
+  else
+    inflateWithPriorityQueue(master_grid, min_i, min_j, max_i, max_j);
+}
+
+void InflationLayer::inflateWithPriorityQueue(costmap_2d::Costmap2D& master_grid, int min_i, int min_j, int max_i,
+                                              int max_j)
+{
   // make sure the inflation queue is empty at the beginning of the cycle (should always be true)
   ROS_ASSERT_MSG(inflation_queue_.empty(), "The inflation queue must be empty at the beginning of inflation");
 
@@ -178,20 +267,6 @@ void InflationLayer::updateCosts(costmap_2d::Costmap2D& master_grid, int min_i,
   }
   memset(seen_, false, size_x * size_y * sizeof(bool));
 
-  // We need to include in the inflation cells outside the bounding
-  // box min_i...max_j, by the amount cell_inflation_radius_.  Cells
-  // up to that distance outside the box can still influence the costs
-  // stored in cells inside the box.
-  min_i -= cell_inflation_radius_;
-  min_j -= cell_inflation_radius_;
-  max_i += cell_inflation_radius_;
-  max_j += cell_inflation_radius_;
-
-  min_i = std::max(0, min_i);
-  min_j = std::max(0, min_j);
-  max_i = std::min(int(size_x), max_i);
-  max_j = std::min(int(size_y), max_j);
-
   for (int j = min_j; j < max_j; j++)
   {
     for (int i = min_i; i < max_i; i++)
@@ -231,6 +306,336 @@ void InflationLayer::updateCosts(costmap_2d::Costmap2D& master_grid, int min_i,
   }
 }
 
+void InflationLayer::inflateWithBuckets(costmap_2d::Costmap2D& master_grid, int min_i, int min_j, int max_i,
+                                        int max_j)
+{
+  // the buckets are sized by computeCaches(), which does nothing for a zero inflation radius
+  if (inflation_buckets_.empty())
+    return;
+
+  unsigned char* master_array = master_grid.getCharMap();
+  unsigned int size_x = master_grid.getSizeInCellsX(), size_y = master_grid.getSizeInCellsY();
+
+  if (seen_stamps_ == NULL || seen_stamps_size_ != size_x * size_y)
+  {
+    if (seen_stamps_)
+      delete[] seen_stamps_;
+    seen_stamps_size_ = size_x * size_y;
+    seen_stamps_ = new unsigned int[seen_stamps_size_];
+    memset(seen_stamps_, 0, seen_stamps_size_ * sizeof(unsigned int));
+    seen_generation_ = 0;
+  }
+
+  // a new generation marks every cell unseen without touching the array,
+  // it only has to be cleared when the counter wraps around
+  if (++seen_generation_ == 0)
+  {
+    memset(seen_stamps_, 0, seen_stamps_size_ * sizeof(unsigned int));
+    seen_generation_ = 1;
+  }
+
+  for (int j = min_j; j < max_j; j++)
+  {
+    for (int i = min_i; i < max_i; i++)
+    {
+      int index = master_grid.getIndex(i, j);
+      unsigned char cost = master_array[index];
+      if (cost == LETHAL_OBSTACLE)
+      {
+        enqueueBucket(master_array, index, i, j, i, j, 0);
+      }
+    }
+  }
+
+  for (unsigned int level = 0; level < inflation_buckets_.size(); ++level)
+  {
+    std::vector<CellData>& bucket = inflation_buckets_[level];
+
+    // cells can be appended to the bucket while we walk it, so index rather than iterate
+    for (unsigned int k = 0; k < bucket.size(); ++k)
+    {
+      unsigned int index = bucket[k].index_;
+      unsigned int mx = bucket[k].x_;
+      unsigned int my = bucket[k].y_;
+      unsigned int sx = bucket[k].src_x_;
+      unsigned int sy = bucket[k].src_y_;
+
+      // attempt to put the neighbors of the current cell onto the queues
+      if (mx > 0)
+        enqueueBucket(master_array, index - 1, mx - 1, my, sx, sy, level);
+      if (my > 0)
+        enqueueBucket(master_array, index - size_x, mx, my - 1, sx, sy, level);
+      if (mx < size_x - 1)
+        enqueueBucket(master_array, index + 1, mx + 1, my, sx, sy, level);
+      if (my < size_y - 1)
+        enqueueBucket(master_array, index + size_x, mx, my + 1, sx, sy, level);
+    }
+
+    // keep the capacity so that the next cycle does not allocate
+    bucket.clear();
+  }
+}
+
+void InflationLayer::prepareTiles(costmap_2d::Costmap2D& master_grid, int min_i, int min_j, int max_i, int max_j)
+{
+  boost::unique_lock < boost::shared_mutex > lock(*access_);
+  tiles_ready_ = enabled_ && use_incremental_inflation_ &&
+                 repairNearestObstacles(master_grid, min_i, min_j, max_i, max_j);
+}
+
+void InflationLayer::updateTile(costmap_2d::Costmap2D& master_grid, int min_i, int min_j, int max_i, int max_j)
+{
+  // tiles only read nearest_obstacle_, so they can share the lock
+  boost::shared_lock < boost::shared_mutex > lock(*access_);
+  if (tiles_ready_)
+    writeIncrementalCosts(master_grid, min_i, min_j, max_i, max_j);
+}
+
+void InflationLayer::inflateIncrementally(costmap_2d::Costmap2D& master_grid, int min_i, int min_j, int max_i,
+                                          int max_j)
+{
+  if (repairNearestObstacles(master_grid, min_i, min_j, max_i, max_j))
+    writeIncrementalCosts(master_grid, min_i, min_j, max_i, max_j);
+}
+
+bool InflationLayer::repairNearestObstacles(costmap_2d::Costmap2D& master_grid, int min_i, int min_j, int max_i,
+                                            int max_j)
+{
+  if (inflation_buckets_.empty())
+    return false;
+
+  unsigned char* master_array = master_grid.getCharMap();
+  unsigned int size_x = master_grid.getSizeInCellsX(), size_y = master_grid.getSizeInCellsY();
+
+  if (nearest_obstacle_ == NULL || incremental_size_ != size_x * size_y)
+  {
+    if (nearest_obstacle_)
+      delete[] nearest_obstacle_;
+    if (lethal_cells_)
+      delete[] lethal_cells_;
+    incremental_size_ = size_x * size_y;
+    nearest_obstacle_ = new unsigned int[incremental_size_];
+    lethal_cells_ = new bool[incremental_size_];
+    incremental_valid_ = false;
+  }
+
+  raise_queue_.clear();
+
+  // a moved origin shifts the contents of the master grid under us, so shift ours along with it
+  if (master_grid.getOriginX() != last_origin_x_ || master_grid.getOriginY() != last_origin_y_)
+  {
+    int dx = int(floor((master_grid.getOriginX() - last_origin_x_) / master_grid.getResolution() + 0.5));
+    int dy = int(floor((master_grid.getOriginY() - last_origin_y_) / master_grid.getResolution() + 0.5));
+    last_origin_x_ = master_grid.getOriginX();
+    last_origin_y_ = master_grid.getOriginY();
+    if (incremental_valid_)
+      shiftNearestObstacles(master_grid, dx, dy);
+  }
+
+  // Only the window can hold changed obstacles, unless we are starting
+  // over, in which case every lethal cell of the map counts as added.
+  int scan_min_i = min_i, scan_min_j = min_j, scan_max_i = max_i, scan_max_j = max_j;
+  if (!incremental_valid_)
+  {
+    std::fill(nearest_obstacle_, nearest_obstacle_ + incremental_size_, NO_SOURCE);
+    memset(lethal_cells_, false, incremental_size_ * sizeof(bool));
+    scan_min_i = scan_min_j = 0;
+    scan_max_i = size_x;
+    scan_max_j = size_y;
+    incremental_valid_ = true;
+  }
+
+  for (int j = scan_min_j; j < scan_max_j; j++)
+  {
+    unsigned int index = master_grid.getIndex(scan_min_i, j);
+    for (int i = scan_min_i; i < scan_max_i; i++, index++)
+    {
+      bool lethal = master_array[index] == LETHAL_OBSTACLE;
+      if (lethal == lethal_cells_[index])
+        continue;
+
+      lethal_cells_[index] = lethal;
+      if (lethal)
+      {
+        nearest_obstacle_[index] = index;
+        inflation_buckets_[0].push_back(CellData(0.0, index, i, j, i, j));
+      }
+      else
+      {
+        nearest_obstacle_[index] = NO_SOURCE;
+        raise_queue_.push_back(index);
+      }
+    }
+  }
+
+  // Raise: forget the nearest obstacle of every cell that was inflated from a
+  // cleared one. The cells around that region that still have a valid
+  // obstacle are queued to propagate it back into the region.
+  for (unsigned int k = 0; k < raise_queue_.size(); ++k)
+  {
+    unsigned int index = raise_queue_[k];
+    unsigned int mx, my;
+    master_grid.indexToCells(index, mx, my);
+
+    unsigned int neighbors[4];
+    unsigned int count = 0;
+    if (mx > 0)
+      neighbors[count++] = index - 1;
+    if (my > 0)
+      neighbors[count++] = index - size_x;
+    if (mx < size_x - 1)
+      neighbors[count++] = index + 1;
+    if (my < size_y - 1)
+      neighbors[count++] = index + size_x;
+
+    for (unsigned int n = 0; n < count; ++n)
+    {
+      unsigned int neighbor = neighbors[n];
+      unsigned int source = nearest_obstacle_[neighbor];
+      if (source == NO_SOURCE)
+        continue;
+
+      if (!lethal_cells_[source])
+      {
+        nearest_obstacle_[neighbor] = NO_SOURCE;
+        raise_queue_.push_back(neighbor);
+      }
+      else
+      {
+        unsigned int nx, ny, sx, sy;
+        master_grid.indexToCells(neighbor, nx, ny);
+        master_grid.indexToCells(source, sx, sy);
+        inflation_buckets_[levelLookup(nx, ny, sx, sy)].push_back(
+            CellData(distanceLookup(nx, ny, sx, sy), neighbor, nx, ny, sx, sy));
+      }
+    }
+  }
+
+  // Lower: propagate obstacles outwards for as long as they are closer than
+  // what the cells already have
+  for (unsigned int level = 0; level < inflation_buckets_.size(); ++level)
+  {
+    std::vector<CellData>& bucket = inflation_buckets_[level];
+    for (unsigned int k = 0; k < bucket.size(); ++k)
+    {
+      unsigned int index = bucket[k].index_;
+      unsigned int mx = bucket[k].x_;
+      unsigned int my = bucket[k].y_;
+      unsigned int sx = bucket[k].src_x_;
+      unsigned int sy = bucket[k].src_y_;
+
+      // skip entries whose cell has been given a closer obstacle since they were queued
+      if (nearest_obstacle_[index] != sy * size_x + sx)
+        continue;
+
+      if (mx > 0)
+        enqueueIncremental(index - 1, mx - 1, my, sx, sy, size_x, level);
+      if (my > 0)
+        enqueueIncremental(index - size_x, mx, my - 1, sx, sy, size_x, level);
+      if (mx < size_x - 1)
+        enqueueIncremental(index + 1, mx + 1, my, sx, sy, size_x, level);
+      if (my < size_y - 1)
+        enqueueIncremental(index + size_x, mx, my + 1, sx, sy, size_x, level);
+    }
+    bucket.clear();
+  }
+
+  return true;
+}
+
+void InflationLayer::shiftNearestObstacles(costmap_2d::Costmap2D& master_grid, int dx, int dy)
+{
+  unsigned char* master_array = master_grid.getCharMap();
+  unsigned int size_x = master_grid.getSizeInCellsX(), size_y = master_grid.getSizeInCellsY();
+  int sx = size_x, sy = size_y;
+  if (dx <= -sx || dx >= sx || dy <= -sy || dy >= sy)
+  {
+    incremental_valid_ = false;
+    return;
+  }
+
+  Costmap2D::shiftMap(lethal_cells_, size_x, size_y, dx, dy, false);
+  Costmap2D::shiftMap(nearest_obstacle_, size_x, size_y, dx, dy, NO_SOURCE);
+
+  // The nearest obstacles are indices, which move by the same offset as the cells. Only a cell within the
+  // inflation radius of the edge can have lost its obstacle out of view, those are raised.
+  unsigned int offset = dy * sx + dx;
+  int radius = cell_inflation_radius_;
+  for (int j = 0; j < sy; j++)
+  {
+    bool edge_row = j < radius || j >= sy - radius;
+    unsigned int index = j * size_x;
+    for (int i = 0; i < sx; i++, index++)
+    {
+      unsigned int source = nearest_obstacle_[index];
+      if (source == NO_SOURCE)
+        continue;
+
+      if (edge_row || i < radius || i >= sx - radius)
+      {
+        int src_y = source / size_x;
+        int src_x = source - src_y * size_x - dx;
+        src_y -= dy;
+        if (src_x < 0 || src_x >= sx || src_y < 0 || src_y >= sy)
+        {
+          nearest_obstacle_[index] = NO_SOURCE;
+          raise_queue_.push_back(index);
+          continue;
+        }
+      }
+      nearest_obstacle_[index] = source - offset;
+    }
+  }
+
+  // The cells that came into view are all new: their obstacles are added, and the others are raised
+  // so that the obstacles around them propagate into them.
+  int strip_min_i = dx < 0 ? 0 : sx - dx, strip_max_i = dx < 0 ? -dx : sx;
+  for (int j = 0; j < sy; j++)
+  {
+    bool strip_row = dy < 0 ? j < -dy : j >= sy - dy;
+    for (int i = strip_row ? 0 : strip_min_i; i < (strip_row ? sx : strip_max_i); i++)
+    {
+      unsigned int index = j * size_x + i;
+      if (master_array[index] == LETHAL_OBSTACLE)
+      {
+        lethal_cells_[index] = true;
+        nearest_obstacle_[index] = index;
+        inflation_buckets_[0].push_back(CellData(0.0, index, i, j, i, j));
+      }
+      else
+        raise_queue_.push_back(index);
+    }
+  }
+}
+
+void InflationLayer::writeIncrementalCosts(costmap_2d::Costmap2D& master_grid, int min_i, int min_j, int max_i,
+                                           int max_j)
+{
+  unsigned char* master_array = master_grid.getCharMap();
+
+  // the master grid has been reset within the window, so all of it needs its inflation back
+  for (int j = min_j; j < max_j; j++)
+  {
+    unsigned int index = master_grid.getIndex(min_i, j);
+    for (int i = min_i; i < max_i; i++, index++)
+    {
+      unsigned int source = nearest_obstacle_[index];
+      if (source == NO_SOURCE)
+        continue;
+
+      unsigned int sx, sy;
+      master_grid.indexToCells(source, sx, sy);
+      unsigned char cost = costLookup(i, j, sx, sy);
+      unsigned char old_cost = master_array[index];
+
+      if (old_cost == NO_INFORMATION && cost >= INSCRIBED_INFLATED_OBSTACLE)
+        master_array[index] = cost;
+      else
+        master_array[index] = std::max(old_cost, cost);
+    }
+  }
+}
+
 /**
  * @brief  Given an index of a cell in the costmap, place it into a priority queue for obstacle inflation
  * @param  grid The costmap
@@ -268,8 +673,82 @@ inline void InflationLayer::enqueue(unsigned char* grid, unsigned int index, uns
   }
 }
 
+/**
+ * @brief  Given an index of a cell in the costmap, place it into the distance bucket it belongs to
+ * @param  grid The costmap
+ * @param  index The index of the cell
+ * @param  mx The x coordinate of the cell (can be computed from the index, but saves time to store it)
+ * @param  my The y coordinate of the cell (can be computed from the index, but saves time to store it)
+ * @param  src_x The x index of the obstacle point inflation started at
+ * @param  src_y The y index of the obstacle point inflation started at
+ * @param  current_level The bucket being processed, cells closer than that are handled within it
+ */
+inline void InflationLayer::enqueueBucket(unsigned char* grid, unsigned int index, unsigned int mx, unsigned int my,
+                                          unsigned int src_x, unsigned int src_y, unsigned int current_level)
+{
+  if (seen_stamps_[index] == seen_generation_)
+    return;
+
+  // we compute our distance table one cell further than the inflation radius dictates so we can make the check below
+  double distance = distanceLookup(mx, my, src_x, src_y);
+
+  // we only want to put the cell in the queue if it is within the inflation radius of the obstacle point
+  if (distance > cell_inflation_radius_)
+    return;
+
+  // assign the cost associated with the distance from an obstacle to the cell
+  unsigned char cost = costLookup(mx, my, src_x, src_y);
+  unsigned char old_cost = grid[index];
+
+  if (old_cost == NO_INFORMATION && cost >= INSCRIBED_INFLATED_OBSTACLE)
+    grid[index] = cost;
+  else
+    grid[index] = std::max(old_cost, cost);
+
+  // the priority queue would pop a closer cell right away, so do the same by
+  // appending it to the bucket currently being processed
+  seen_stamps_[index] = seen_generation_;
+  unsigned int level = std::max(levelLookup(mx, my, src_x, src_y), current_level);
+  inflation_buckets_[level].push_back(CellData(distance, index, mx, my, src_x, src_y));
+}
+
+/**
+ * @brief  Give a cell a new nearest obstacle and queue it if that obstacle is closer than its current one
+ * @param  index The index of the cell
+ * @param  mx The x coordinate of the cell
+ * @param  my The y coordinate of the cell
+ * @param  src_x The x index of the obstacle being propagated
+ * @param  src_y The y index of the obstacle being propagated
+ * @param  size_x The x size of the master grid, to locate the current nearest obstacle
+ * @param  current_level The bucket being processed, cells closer than that are handled within it
+ */
+inline void InflationLayer::enqueueIncremental(unsigned int index, unsigned int mx, unsigned int my,
+                                               unsigned int src_x, unsigned int src_y, unsigned int size_x,
+                                               unsigned int current_level)
+{
+  double distance = distanceLookup(mx, my, src_x, src_y);
+  if (distance > cell_inflation_radius_)
+    return;
+
+  unsigned int current = nearest_obstacle_[index];
+  if (current != NO_SOURCE)
+  {
+    unsigned int cy = current / size_x;
+    unsigned int cx = current - cy * size_x;
+    if (distanceLookup(mx, my, cx, cy) <= distance)
+      return;
+  }
+
+  nearest_obstacle_[index] = src_y * size_x + src_x;
+  unsigned int level = std::max(levelLookup(mx, my, src_x, src_y), current_level);
+  inflation_buckets_[level].push_back(CellData(distance, index, mx, my, src_x, src_y));
+}
+
 void InflationLayer::computeCaches()
 {
+  // the nearest obstacles found with the previous kernel may lie outside of the new one
+  incremental_valid_ = false;
+
   if (cell_inflation_radius_ == 0)
     return;
 
@@ -280,17 +759,34 @@ void InflationLayer::computeCaches()
 
     cached_costs_ = new unsigned char*[cell_inflation_radius_ + 2];
     cached_distances_ = new double*[cell_inflation_radius_ + 2];
+    cached_levels_ = new unsigned int*[cell_inflation_radius_ + 2];
 
+    std::vector<double> levels;
     for (unsigned int i = 0; i <= cell_inflation_radius_ + 1; ++i)
     {
       cached_costs_[i] = new unsigned char[cell_inflation_radius_ + 2];
       cached_distances_[i] = new double[cell_inflation_radius_ + 2];
+      cached_levels_[i] = new unsigned int[cell_inflation_radius_ + 2];
       for (unsigned int j = 0; j <= cell_inflation_radius_ + 1; ++j)
       {
         cached_distances_[i][j] = hypot(i, j);
+        levels.push_back(cached_distances_[i][j]);
       }
     }
 
+    // the kernel only produces a few distinct distances, give each of them a bucket
+    std::sort(levels.begin(), levels.end());
+    levels.erase(std::unique(levels.begin(), levels.end()), levels.end());
+    for (unsigned int i = 0; i <= cell_inflation_radius_ + 1; ++i)
+    {
+      for (unsigned int j = 0; j <= cell_inflation_radius_ + 1; ++j)
+      {
+        cached_levels_[i][j] = std::lower_bound(levels.begin(), levels.end(), cached_distances_[i][j])
+            - levels.begin();
+      }
+    }
+    inflation_buckets_.resize(levels.size());
+
     cached_cell_inflation_radius_ = cell_inflation_radius_;
   }
 
@@ -327,6 +823,17 @@ void InflationLayer::deleteKernels()
     delete[] cached_costs_;
     cached_costs_ = NULL;
   }
+
+  if (cached_levels_ != NULL)
+  {
+    for (unsigned int i = 0; i <= cached_cell_inflation_radius_ + 1; ++i)
+    {
+      if (cached_levels_[i])
+        delete[] cached_levels_[i];
+    }
+    delete[] cached_levels_;
+    cached_levels_ = NULL;
+  }
 }
 
 }  // namespace costmap_2d
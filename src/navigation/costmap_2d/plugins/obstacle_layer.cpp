@@ -358,6 +358,8 @@ void ObstacleLayer::updateBounds(double robot_x, double robot_y, double robot_ya
   // update the global current status
   current_ = current;
 
+  updateBytesCopied();
+
   // raytrace freespace
   for (unsigned int i = 0; i < clearing_observations.size(); ++i)
   {
@@ -425,14 +427,27 @@ void ObstacleLayer::updateFootprint(double robot_x, double robot_y, double robot
 }
 
 void ObstacleLayer::updateCosts(costmap_2d::Costmap2D& master_grid, int min_i, int min_j, int max_i, int max_j)
+{
+  prepareTiles(master_grid, min_i, min_j, max_i, max_j);
+  updateTile(master_grid, min_i, min_j, max_i, max_j);
+}
+
+void ObstacleLayer::prepareTiles(costmap_2d::Costmap2D& master_grid, int min_i, int min_j, int max_i, int max_j)
 {
   if (!enabled_)
     return;
 
+  // the footprint only touches our own grid, so it is cleared once for all tiles
   if (footprint_clearing_enabled_)
   {
     setConvexPolygonCost(transformed_footprint_, costmap_2d::FREE_SPACE);
   }
+}
+
+void ObstacleLayer::updateTile(costmap_2d::Costmap2D& master_grid, int min_i, int min_j, int max_i, int max_j)
+{
+  if (!enabled_)
+    return;
 
   switch (combination_method_)
   {
@@ -463,6 +478,22 @@ void ObstacleLayer::clearStaticObservations(bool marking, bool clearing)
     static_clearing_observations_.clear();
 }
 
+void ObstacleLayer::updateBytesCopied()
+{
+  size_t total = 0;
+  for (unsigned int i = 0; i < observation_buffers_.size(); ++i)
+  {
+    observation_buffers_[i]->lock();
+    total += observation_buffers_[i]->getBytesCopied();
+    observation_buffers_[i]->unlock();
+  }
+
+  bytes_copied_ = total - bytes_copied_total_;
+  bytes_copied_total_ = total;
+  ROS_DEBUG("%s: %lu bytes of observation points copied since the last update", name_.c_str(),
+            (unsigned long)bytes_copied_);
+}
+
 bool ObstacleLayer::getMarkingObservations(std::vector<Observation>& marking_observations) const
 {
   bool current = true;
@@ -500,7 +531,7 @@ void ObstacleLayer::raytraceFreespace(const Observation& clearing_observation, d
 {
   double ox = clearing_observation.origin_.x;
   double oy = clearing_observation.origin_.y;
-  pcl::PointCloud < pcl::PointXYZ > cloud = *(clearing_observation.cloud_);
+  const pcl::PointCloud<pcl::PointXYZ>& cloud = *(clearing_observation.cloud_);
 
   // get the map coordinates of the origin of the sensor
   unsigned int x0, y0;
@@ -520,6 +551,12 @@ void ObstacleLayer::raytraceFreespace(const Observation& clearing_observation, d
 
   touch(ox, oy, min_x, min_y, max_x, max_y);
 
+  // every ray of the observation starts at the same cell and is limited to the same length, so two
+  // points that fall into the same cell clear exactly the same cells and only need one trace
+  if (ray_endpoint_seen_.size() != size_x_ * size_y_)
+    ray_endpoint_seen_.assign(size_x_ * size_y_, false);
+  ray_endpoints_.clear();
+
   // for each point in the cloud, we want to trace a line from the origin and clear obstacles along it
   for (unsigned int i = 0; i < cloud.points.size(); ++i)
   {
@@ -566,13 +603,29 @@ void ObstacleLayer::raytraceFreespace(const Observation& clearing_observation, d
     if (!worldToMap(wx, wy, x1, y1))
       continue;
 
-    unsigned int cell_raytrace_range = cellDistance(clearing_observation.raytrace_range_);
-    MarkCell marker(costmap_, FREE_SPACE);
-    // and finally... we can execute our trace to clear obstacles along that line
-    raytraceLine(marker, x0, y0, x1, y1, cell_raytrace_range);
+    unsigned int index = getIndex(x1, y1);
+    if (!ray_endpoint_seen_[index])
+    {
+      ray_endpoint_seen_[index] = true;
+      ray_endpoints_.push_back(index);
+    }
 
     updateRaytraceBounds(ox, oy, wx, wy, clearing_observation.raytrace_range_, min_x, min_y, max_x, max_y);
   }
+
+  unsigned int cell_raytrace_range = cellDistance(clearing_observation.raytrace_range_);
+  MarkCell marker(costmap_, FREE_SPACE);
+
+  // and finally... we can execute our traces to clear obstacles along the lines, in memory order of
+  // their endpoints so that neighbouring rays walk through the same cache lines one after the other
+  std::sort(ray_endpoints_.begin(), ray_endpoints_.end());
+  for (unsigned int i = 0; i < ray_endpoints_.size(); ++i)
+  {
+    unsigned int x1, y1;
+    indexToCells(ray_endpoints_[i], x1, y1);
+    raytraceLine(marker, x0, y0, x1, y1, cell_raytrace_range);
+    ray_endpoint_seen_[ray_endpoints_[i]] = false;
+  }
 }
 
 void ObstacleLayer::activate()
@@ -54,9 +54,13 @@ namespace costmap_2d
 
 void VoxelLayer::onInitialize()
 {
-  ObstacleLayer::onInitialize();
   ros::NodeHandle private_nh("~/" + name_);
 
+  // 64 bit columns hold up to 32 z voxels and clear steep rays a column at a time
+  private_nh.param("use_wide_columns", use_wide_columns_, false);
+
+  ObstacleLayer::onInitialize();
+
   private_nh.param("publish_voxel_map", publish_voxel_, false);
   if (publish_voxel_)
     voxel_pub_ = private_nh.advertise < costmap_2d::VoxelGrid > ("voxel_grid", 1);
@@ -84,9 +88,18 @@ void VoxelLayer::reconfigureCB(costmap_2d::VoxelPluginConfig &config, uint32_t l
   footprint_clearing_enabled_ = config.footprint_clearing_enabled;
   max_obstacle_height_ = config.max_obstacle_height;
   size_z_ = config.z_voxels;
+  if (!use_wide_columns_ && size_z_ > VOXEL_BITS)
+  {
+    ROS_WARN("z_voxels is %d, but only %d are supported unless use_wide_columns is set", config.z_voxels, VOXEL_BITS);
+    size_z_ = VOXEL_BITS;
+  }
   origin_z_ = config.origin_z;
   z_resolution_ = config.z_resolution;
-  unknown_threshold_ = config.unknown_threshold + (VOXEL_BITS - size_z_);
+  // the wide grid only starts the levels it has as unknown
+  if (use_wide_columns_)
+    unknown_threshold_ = config.unknown_threshold;
+  else
+    unknown_threshold_ = config.unknown_threshold + (VOXEL_BITS - size_z_);
   mark_threshold_ = config.mark_threshold;
   combination_method_ = config.combination_method;
   matchSize();
@@ -95,22 +108,32 @@ void VoxelLayer::reconfigureCB(costmap_2d::VoxelPluginConfig &config, uint32_t l
 void VoxelLayer::matchSize()
 {
   ObstacleLayer::matchSize();
-  voxel_grid_.resize(size_x_, size_y_, size_z_);
-  ROS_ASSERT(voxel_grid_.sizeX() == size_x_ && voxel_grid_.sizeY() == size_y_);
+  if (use_wide_columns_)
+  {
+    wide_voxel_grid_.resize(size_x_, size_y_, size_z_);
+    ROS_ASSERT(wide_voxel_grid_.sizeX() == size_x_ && wide_voxel_grid_.sizeY() == size_y_);
+  }
+  else
+  {
+    voxel_grid_.resize(size_x_, size_y_, size_z_);
+    ROS_ASSERT(voxel_grid_.sizeX() == size_x_ && voxel_grid_.sizeY() == size_y_);
+  }
 }
 
 void VoxelLayer::reset()
 {
   deactivate();
   resetMaps();
-  voxel_grid_.reset();
   activate();
 }
 
 void VoxelLayer::resetMaps()
 {
   Costmap2D::resetMaps();
-  voxel_grid_.reset();
+  if (use_wide_columns_)
+    wide_voxel_grid_.reset();
+  else
+    voxel_grid_.reset();
 }
 
 void VoxelLayer::updateBounds(double robot_x, double robot_y, double robot_yaw, double* min_x,
@@ -134,6 +157,8 @@ void VoxelLayer::updateBounds(double robot_x, double robot_y, double robot_yaw,
   // update the global current status
   current_ = current;
 
+  updateBytesCopied();
+
   // raytrace freespace
   for (unsigned int i = 0; i < clearing_observations.size(); ++i)
   {
@@ -177,7 +202,9 @@ void VoxelLayer::updateBounds(double robot_x, double robot_y, double robot_yaw,
       }
 
       // mark the cell in the voxel grid and check if we should also mark it in the costmap
-      if (voxel_grid_.markVoxelInMap(mx, my, mz, mark_threshold_))
+      bool marked = use_wide_columns_ ? wide_voxel_grid_.markVoxelInMap(mx, my, mz, mark_threshold_) :
+                                        voxel_grid_.markVoxelInMap(mx, my, mz, mark_threshold_);
+      if (marked)
       {
         unsigned int index = getIndex(mx, my);
 
@@ -190,12 +217,29 @@ void VoxelLayer::updateBounds(double robot_x, double robot_y, double robot_yaw,
   if (publish_voxel_)
   {
     costmap_2d::VoxelGrid grid_msg;
-    unsigned int size = voxel_grid_.sizeX() * voxel_grid_.sizeY();
-    grid_msg.size_x = voxel_grid_.sizeX();
-    grid_msg.size_y = voxel_grid_.sizeY();
-    grid_msg.size_z = voxel_grid_.sizeZ();
-    grid_msg.data.resize(size);
-    memcpy(&grid_msg.data[0], voxel_grid_.getData(), size * sizeof(unsigned int));
+    if (use_wide_columns_)
+    {
+      // the message holds 16 levels per column, the ones above are not published
+      unsigned int size = wide_voxel_grid_.sizeX() * wide_voxel_grid_.sizeY();
+      grid_msg.size_x = wide_voxel_grid_.sizeX();
+      grid_msg.size_y = wide_voxel_grid_.sizeY();
+      grid_msg.size_z = std::min(wide_voxel_grid_.sizeZ(), (unsigned int)VOXEL_BITS);
+      if (wide_voxel_grid_.sizeZ() > VOXEL_BITS)
+        ROS_WARN_ONCE("Only the lowest %d of %u voxel levels are published", VOXEL_BITS, wide_voxel_grid_.sizeZ());
+      grid_msg.data.resize(size);
+      const uint64_t* data = wide_voxel_grid_.getData();
+      for (unsigned int i = 0; i < size; ++i)
+        grid_msg.data[i] = voxel_grid::WideVoxelGrid::toNarrowColumn(data[i]);
+    }
+    else
+    {
+      unsigned int size = voxel_grid_.sizeX() * voxel_grid_.sizeY();
+      grid_msg.size_x = voxel_grid_.sizeX();
+      grid_msg.size_y = voxel_grid_.sizeY();
+      grid_msg.size_z = voxel_grid_.sizeZ();
+      grid_msg.data.resize(size);
+      memcpy(&grid_msg.data[0], voxel_grid_.getData(), size * sizeof(unsigned int));
+    }
 
     grid_msg.origin.x = origin_x_;
     grid_msg.origin.y = origin_y_;
@@ -252,7 +296,10 @@ void VoxelLayer::clearNonLethal(double wx, double wy, double w_size_x, double w_
         if (clear_no_info || *current != NO_INFORMATION)
         {
           *current = FREE_SPACE;
-          voxel_grid_.clearVoxelColumn(index);
+          if (use_wide_columns_)
+            wide_voxel_grid_.clearVoxelColumn(index);
+          else
+            voxel_grid_.clearVoxelColumn(index);
         }
       }
       current++;
@@ -355,9 +402,14 @@ void VoxelLayer::raytraceFreespace(const Observation& clearing_observation, doub
       unsigned int cell_raytrace_range = cellDistance(clearing_observation.raytrace_range_);
 
       // voxel_grid_.markVoxelLine(sensor_x, sensor_y, sensor_z, point_x, point_y, point_z);
-      voxel_grid_.clearVoxelLineInMap(sensor_x, sensor_y, sensor_z, point_x, point_y, point_z, costmap_,
-                                      unknown_threshold_, mark_threshold_, FREE_SPACE, NO_INFORMATION,
-                                      cell_raytrace_range);
+      if (use_wide_columns_)
+        wide_voxel_grid_.clearVoxelLineInMap(sensor_x, sensor_y, sensor_z, point_x, point_y, point_z, costmap_,
+                                             unknown_threshold_, mark_threshold_, FREE_SPACE, NO_INFORMATION,
+                                             cell_raytrace_range);
+      else
+        voxel_grid_.clearVoxelLineInMap(sensor_x, sensor_y, sensor_z, point_x, point_y, point_z, costmap_,
+                                        unknown_threshold_, mark_threshold_, FREE_SPACE, NO_INFORMATION,
+                                        cell_raytrace_range);
 
       updateRaytraceBounds(ox, oy, wpx, wpy, clearing_observation.raytrace_range_, min_x, min_y, max_x, max_y);
 
@@ -395,48 +447,17 @@ void VoxelLayer::updateOrigin(double new_origin_x, double new_origin_y)
   new_grid_ox = origin_x_ + cell_ox * resolution_;
   new_grid_oy = origin_y_ + cell_oy * resolution_;
 
-  // To save casting from unsigned int to int a bunch of times
-  int size_x = size_x_;
-  int size_y = size_y_;
-
-  // we need to compute the overlap of the new and existing windows
-  int lower_left_x, lower_left_y, upper_right_x, upper_right_y;
-  lower_left_x = std::min(std::max(cell_ox, 0), size_x);
-  lower_left_y = std::min(std::max(cell_oy, 0), size_y);
-  upper_right_x = std::min(std::max(cell_ox + size_x, 0), size_x);
-  upper_right_y = std::min(std::max(cell_oy + size_y, 0), size_y);
-
-  unsigned int cell_size_x = upper_right_x - lower_left_x;
-  unsigned int cell_size_y = upper_right_y - lower_left_y;
-
-  // we need a map to store the obstacles in the window temporarily
-  unsigned char* local_map = new unsigned char[cell_size_x * cell_size_y];
-  unsigned int* local_voxel_map = new unsigned int[cell_size_x * cell_size_y];
-  unsigned int* voxel_map = voxel_grid_.getData();
-
-  // copy the local window in the costmap to the local map
-  copyMapRegion(costmap_, lower_left_x, lower_left_y, size_x_, local_map, 0, 0, cell_size_x, cell_size_x, cell_size_y);
-  copyMapRegion(voxel_map, lower_left_x, lower_left_y, size_x_, local_voxel_map, 0, 0, cell_size_x, cell_size_x,
-                cell_size_y);
-
-  // we'll reset our maps to unknown space if appropriate
-  resetMaps();
+  // move the overlap of the new and existing windows in place, only the cells that come into view are reset
+  boost::unique_lock<mutex_t> lock(*getMutex());
+  shiftMap(costmap_, size_x_, size_y_, cell_ox, cell_oy, default_value_);
+  if (use_wide_columns_)
+    shiftMap(wide_voxel_grid_.getData(), size_x_, size_y_, cell_ox, cell_oy, wide_voxel_grid_.getUnknownColumn());
+  else
+    shiftMap(voxel_grid_.getData(), size_x_, size_y_, cell_ox, cell_oy, voxel_grid_.getUnknownColumn());
 
   // update the origin with the appropriate world coordinates
   origin_x_ = new_grid_ox;
   origin_y_ = new_grid_oy;
-
-  // compute the starting cell location for copying data back in
-  int start_x = lower_left_x - cell_ox;
-  int start_y = lower_left_y - cell_oy;
-
-  // now we want to copy the overlapping information back into the map, but in its new location
-  copyMapRegion(local_map, 0, 0, cell_size_x, costmap_, start_x, start_y, size_x_, cell_size_x, cell_size_y);
-  copyMapRegion(local_voxel_map, 0, 0, cell_size_x, voxel_map, start_x, start_y, size_x_, cell_size_x, cell_size_y);
-
-  // make sure to clean up
-  delete[] local_map;
-  delete[] local_voxel_map;
 }
 
 }  // namespace costmap_2d
@@ -0,0 +1,146 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+#include <costmap_2d/changed_tiles.h>
+#include <algorithm>
+
+namespace costmap_2d
+{
+
+const unsigned int ChangedTiles::TILE_SIZE;
+
+ChangedTiles::ChangedTiles() :
+    size_x_(0), size_y_(0), tiles_x_(0), tiles_y_(0)
+{
+}
+
+void ChangedTiles::reset(unsigned int size_x, unsigned int size_y, const std::vector<int8_t>& values)
+{
+  size_x_ = size_x;
+  size_y_ = size_y;
+  tiles_x_ = (size_x + TILE_SIZE - 1) / TILE_SIZE;
+  tiles_y_ = (size_y + TILE_SIZE - 1) / TILE_SIZE;
+  dirty_.assign(tiles_x_ * tiles_y_, 0);
+  values_ = values;
+}
+
+void ChangedTiles::markDirty(unsigned int x0, unsigned int xn, unsigned int y0, unsigned int yn)
+{
+  unsigned int tx_end = std::min(tiles_x_, (xn + TILE_SIZE - 1) / TILE_SIZE);
+  unsigned int ty_end = std::min(tiles_y_, (yn + TILE_SIZE - 1) / TILE_SIZE);
+  for (unsigned int ty = y0 / TILE_SIZE; ty < ty_end; ty++)
+  {
+    for (unsigned int tx = x0 / TILE_SIZE; tx < tx_end; tx++)
+    {
+      dirty_[ty * tiles_x_ + tx] = 1;
+    }
+  }
+}
+
+void ChangedTiles::collect(const unsigned char* data, const char* translation, std::vector<Rect>& rects,
+                           unsigned int max_rects)
+{
+  rects.clear();
+
+  // one row of tiles at a time, with an extra pass to close the rectangles still open after the last
+  open_rects_.clear();
+  for (unsigned int ty = 0; ty <= tiles_y_; ty++)
+  {
+    row_rects_.clear();
+    for (unsigned int tx = 0; ty < tiles_y_ && tx < tiles_x_; tx++)
+    {
+      unsigned char& dirty = dirty_[ty * tiles_x_ + tx];
+      if (!dirty)
+        continue;
+      dirty = 0;
+
+      // only tiles that look different to the subscribers are sent
+      Rect tile;
+      tile.x0 = tx * TILE_SIZE;
+      tile.xn = std::min(size_x_, tile.x0 + TILE_SIZE);
+      tile.y0 = ty * TILE_SIZE;
+      tile.yn = std::min(size_y_, tile.y0 + TILE_SIZE);
+      bool changed = false;
+      for (unsigned int y = tile.y0; y < tile.yn; y++)
+      {
+        for (unsigned int i = y * size_x_ + tile.x0; i < y * size_x_ + tile.xn; i++)
+        {
+          int8_t value = translation[ data[ i ]];
+          if (values_[i] != value)
+          {
+            values_[i] = value;
+            changed = true;
+          }
+        }
+      }
+      if (!changed)
+        continue;
+
+      if (!row_rects_.empty() && row_rects_.back().xn == tile.x0)
+        row_rects_.back().xn = tile.xn;
+      else
+        row_rects_.push_back(tile);
+    }
+
+    // a rectangle of the last row continues into this one if it has one just as wide under it
+    unsigned int k = 0;
+    for (unsigned int i = 0; i < open_rects_.size(); i++)
+    {
+      const Rect& open = open_rects_[i];
+      while (k < row_rects_.size() && row_rects_[k].x0 < open.x0)
+        k++;
+      if (k < row_rects_.size() && row_rects_[k].x0 == open.x0 && row_rects_[k].xn == open.xn)
+        row_rects_[k].y0 = open.y0;
+      else
+        rects.push_back(open);
+    }
+    open_rects_.swap(row_rects_);
+  }
+
+  // too many rectangles are sent as one bounding them, where the cells between them hold the values last sent
+  if (rects.size() > max_rects)
+  {
+    Rect bounds = rects[0];
+    for (unsigned int i = 1; i < rects.size(); i++)
+    {
+      bounds.x0 = std::min(bounds.x0, rects[i].x0);
+      bounds.xn = std::max(bounds.xn, rects[i].xn);
+      bounds.y0 = std::min(bounds.y0, rects[i].y0);
+      bounds.yn = std::max(bounds.yn, rects[i].yn);
+    }
+    rects.assign(1, bounds);
+  }
+}
+
+}  // namespace costmap_2d
@@ -38,20 +38,24 @@
 #include <boost/bind.hpp>
 #include <costmap_2d/costmap_2d_publisher.h>
 #include <costmap_2d/cost_values.h>
+#include <algorithm>
 
 namespace costmap_2d
 {
 
 char* Costmap2DPublisher::cost_translation_table_ = NULL;
+const unsigned int Costmap2DPublisher::UPDATE_QUEUE_SIZE;
 
 Costmap2DPublisher::Costmap2DPublisher(ros::NodeHandle * ros_node, Costmap2D* costmap, std::string global_frame,
-                                       std::string topic_name, bool always_send_full_costmap) :
+                                       std::string topic_name, bool always_send_full_costmap, bool single_update) :
     node(ros_node), costmap_(costmap), global_frame_(global_frame), active_(false),
-    always_send_full_costmap_(always_send_full_costmap)
+    always_send_full_costmap_(always_send_full_costmap), single_update_(single_update)
 {
   costmap_pub_ = ros_node->advertise<nav_msgs::OccupancyGrid>(topic_name, 1,
                                                     boost::bind(&Costmap2DPublisher::onNewSubscription, this, _1));
-  costmap_update_pub_ = ros_node->advertise<map_msgs::OccupancyGridUpdate>(topic_name + "_updates", 1);
+  // a publication can be several updates, which must all reach the subscribers
+  costmap_update_pub_ = ros_node->advertise<map_msgs::OccupancyGridUpdate>(topic_name + "_updates",
+                                                                         single_update_ ? 1 : UPDATE_QUEUE_SIZE);
 
   if (cost_translation_table_ == NULL)
   {
@@ -80,6 +84,21 @@ Costmap2DPublisher::~Costmap2DPublisher()
 {
 }
 
+void Costmap2DPublisher::updateBounds(unsigned int x0, unsigned int xn, unsigned int y0, unsigned int yn)
+{
+  x0_ = std::min(x0, x0_);
+  xn_ = std::max(xn, xn_);
+  y0_ = std::min(y0, y0_);
+  yn_ = std::max(yn, yn_);
+
+  // until the tiles match the costmap again, the next publication is a full grid
+  if (single_update_ || always_send_full_costmap_ || x0 >= xn || y0 >= yn ||
+      !tiles_.matches(costmap_->getSizeInCellsX(), costmap_->getSizeInCellsY()))
+    return;
+
+  tiles_.markDirty(x0, xn, y0, yn);
+}
+
 void Costmap2DPublisher::onNewSubscription(const ros::SingleSubscriberPublisher& pub)
 {
   prepareGrid();
@@ -132,33 +151,21 @@ void Costmap2DPublisher::publishCostmap()
     {
       costmap_pub_.publish(grid_);
     }
+
+    // updates are relative to this grid from now on
+    if (!single_update_ && !always_send_full_costmap_)
+    {
+      // grid_ is also prepared for new subscribers, under the same lock
+      boost::unique_lock<Costmap2D::mutex_t> lock(*(costmap_->getMutex()));
+      tiles_.reset(grid_.info.width, grid_.info.height, grid_.data);
+    }
   }
   else if (x0_ < xn_)
   {
-    boost::unique_lock<Costmap2D::mutex_t> lock(*(costmap_->getMutex()));
-    // Publish Just an Update
-    map_msgs::OccupancyGridUpdate update;
-    update.header.stamp = ros::Time::now();
-    update.header.frame_id = global_frame_;
-    update.x = x0_;
-    update.y = y0_;
-    update.width = xn_ - x0_;
-    update.height = yn_ - y0_;
-    update.data.resize(update.width * update.height);
-
-    unsigned int i = 0;
-    for (unsigned int y = y0_; y < yn_; y++)
-    {
-      for (unsigned int x = x0_; x < xn_; x++)
-      {
-        unsigned char cost = costmap_->getCost(x, y);
-        update.data[i++] = cost_translation_table_[ cost ];
-      }
-    }
-    if (costmap_update_pub_.getNumSubscribers() > 0)
-    {
-      costmap_update_pub_.publish(update);
-    }
+    if (single_update_)
+      publishSingleUpdate();
+    else
+      publishTileUpdates();
   }
 
   xn_ = yn_ = 0;
@@ -166,4 +173,67 @@ void Costmap2DPublisher::publishCostmap()
   y0_ = costmap_->getSizeInCellsY();
 }
 
+void Costmap2DPublisher::publishSingleUpdate()
+{
+  boost::unique_lock<Costmap2D::mutex_t> lock(*(costmap_->getMutex()));
+  // Publish Just an Update
+  map_msgs::OccupancyGridUpdate update;
+  update.header.stamp = ros::Time::now();
+  update.header.frame_id = global_frame_;
+  update.x = x0_;
+  update.y = y0_;
+  update.width = xn_ - x0_;
+  update.height = yn_ - y0_;
+  update.data.resize(update.width * update.height);
+
+  unsigned int i = 0;
+  for (unsigned int y = y0_; y < yn_; y++)
+  {
+    for (unsigned int x = x0_; x < xn_; x++)
+    {
+      unsigned char cost = costmap_->getCost(x, y);
+      update.data[i++] = cost_translation_table_[ cost ];
+    }
+  }
+  if (costmap_update_pub_.getNumSubscribers() > 0)
+  {
+    costmap_update_pub_.publish(update);
+  }
+}
+
+void Costmap2DPublisher::publishTileUpdates()
+{
+  boost::unique_lock<Costmap2D::mutex_t> lock(*(costmap_->getMutex()));
+  ros::Time stamp = ros::Time::now();
+  tiles_.collect(costmap_->getCharMap(), cost_translation_table_, rects_, UPDATE_QUEUE_SIZE);
+  for (unsigned int i = 0; i < rects_.size(); i++)
+  {
+    publishUpdate(rects_[i], stamp);
+  }
+}
+
+void Costmap2DPublisher::publishUpdate(const ChangedTiles::Rect& rect, const ros::Time& stamp)
+{
+  if (costmap_update_pub_.getNumSubscribers() == 0)
+    return;
+
+  map_msgs::OccupancyGridUpdate update;
+  update.header.stamp = stamp;
+  update.header.frame_id = global_frame_;
+  update.x = rect.x0;
+  update.y = rect.y0;
+  update.width = rect.xn - rect.x0;
+  update.height = rect.yn - rect.y0;
+  update.data.resize(update.width * update.height);
+
+  unsigned int size_x = costmap_->getSizeInCellsX();
+  const std::vector<int8_t>& values = tiles_.getValues();
+  std::vector<int8_t>::iterator out = update.data.begin();
+  for (unsigned int y = rect.y0; y < rect.yn; y++)
+  {
+    out = std::copy(values.begin() + y * size_x + rect.x0, values.begin() + y * size_x + rect.xn, out);
+  }
+  costmap_update_pub_.publish(update);
+}
+
 }  // end namespace costmap_2d
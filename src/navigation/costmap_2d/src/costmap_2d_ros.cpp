@@ -37,7 +37,9 @@
  *********************************************************************/
 #include <costmap_2d/layered_costmap.h>
 #include <costmap_2d/costmap_2d_ros.h>
+#include <diagnostic_msgs/DiagnosticArray.h>
 #include <cstdio>
+#include <sstream>
 #include <string>
 #include <algorithm>
 #include <vector>
@@ -62,7 +64,7 @@ void move_parameter(ros::NodeHandle& old_h, ros::NodeHandle& new_h, std::string
 Costmap2DROS::Costmap2DROS(std::string name, tf::TransformListener& tf) :
     layered_costmap_(NULL), name_(name), tf_(tf), stop_updates_(false), initialized_(true), stopped_(false),
     robot_stopped_(false), map_update_thread_(NULL), last_publish_(0),
-    plugin_loader_("costmap_2d", "costmap_2d::Layer"), publisher_(NULL)
+    plugin_loader_("costmap_2d", "costmap_2d::Layer"), publisher_(NULL), diagnosed_cycles_(0)
 {
   ros::NodeHandle private_nh("~/" + name);
   ros::NodeHandle g_nh;
@@ -99,13 +101,21 @@ Costmap2DROS::Costmap2DROS(std::string name, tf::TransformListener& tf) :
   }
 
   // check if we want a rolling window version of the costmap
-  bool rolling_window, track_unknown_space, always_send_full_costmap;
+  bool rolling_window, track_unknown_space, always_send_full_costmap, send_single_costmap_update;
   private_nh.param("rolling_window", rolling_window, false);
   private_nh.param("track_unknown_space", track_unknown_space, false);
   private_nh.param("always_send_full_costmap", always_send_full_costmap, false);
+  // send the changes as one rectangle around all of them, rather than only the changed tiles
+  private_nh.param("send_single_costmap_update", send_single_costmap_update, false);
 
   layered_costmap_ = new LayeredCostmap(global_frame_, rolling_window, track_unknown_space);
 
+  // optionally split the update window into tiles that are updated on several threads
+  int update_threads, update_tile_size;
+  private_nh.param("update_threads", update_threads, 1);
+  private_nh.param("update_tile_size", update_tile_size, 128);
+  layered_costmap_->setTiledUpdate(update_threads, std::max(1, update_tile_size));
+
   if (!private_nh.hasParam("plugins"))
   {
     resetOldParameters(private_nh);
@@ -127,6 +137,16 @@ Costmap2DROS::Costmap2DROS(std::string name, tf::TransformListener& tf) :
     }
   }
 
+  // keep the timings of the last updates, for the diagnostics topic and the dump_profile service
+  int profile_cycles;
+  private_nh.param("profile_cycles", profile_cycles, 100);
+  layered_costmap_->setProfiling(std::max(0, profile_cycles));
+  if (profile_cycles > 0)
+  {
+    diagnostics_pub_ = g_nh.advertise<diagnostic_msgs::DiagnosticArray>("/diagnostics", 1);
+    profile_service_ = private_nh.advertiseService("dump_profile", &Costmap2DROS::dumpProfileService, this);
+  }
+
   // subscribe to the footprint topic
   std::string topic_param, topic;
   if (!private_nh.searchParam("footprint_topic", topic_param))
@@ -148,7 +168,7 @@ Costmap2DROS::Costmap2DROS(std::string name, tf::TransformListener& tf) :
   setUnpaddedRobotFootprint(makeFootprintFromParams(private_nh));
 
   publisher_ = new Costmap2DPublisher(&private_nh, layered_costmap_->getCostmap(), global_frame_, "costmap",
-                                      always_send_full_costmap);
+                                      always_send_full_costmap, send_single_costmap_update);
 
   // create a thread to handle updating the map
   stop_updates_ = false;
@@ -403,6 +423,11 @@ void Costmap2DROS::mapUpdateLoop(double frequency)
         last_publish_ = now;
       }
     }
+    if (layered_costmap_->getProfiler() && last_diagnostics_ + ros::Duration(1.0) < ros::Time::now())
+    {
+      publishDiagnostics(frequency);
+      last_diagnostics_ = ros::Time::now();
+    }
     r.sleep();
     // make sure to sleep for the remainder of our cycle time
     if (r.cycleTime() > ros::Duration(1 / frequency))
@@ -411,6 +436,110 @@ void Costmap2DROS::mapUpdateLoop(double frequency)
   }
 }
 
+static void addValue(diagnostic_msgs::DiagnosticStatus& status, const std::string& key, double value)
+{
+  diagnostic_msgs::KeyValue key_value;
+  key_value.key = key;
+  std::ostringstream stream;
+  stream << value;
+  key_value.value = stream.str();
+  status.values.push_back(key_value);
+}
+
+void Costmap2DROS::publishDiagnostics(double frequency)
+{
+  std::vector<UpdateProfiler::Cycle> cycles;
+  diagnosed_cycles_ = layered_costmap_->getProfiler()->getCycles(cycles, diagnosed_cycles_);
+  if (cycles.empty())
+    return;
+
+  std::vector<boost::shared_ptr<Layer> >* plugins = layered_costmap_->getPlugins();
+  unsigned int num_layers = cycles[0].layers.size();
+  double update_time = 0.0, max_update_time = 0.0, window_cells = 0.0;
+  std::vector<double> bounds_time(num_layers, 0.0), costs_time(num_layers, 0.0), max_costs_time(num_layers, 0.0);
+  for (unsigned int i = 0; i < cycles.size(); ++i)
+  {
+    const UpdateProfiler::Cycle& cycle = cycles[i];
+    update_time += cycle.update_time;
+    max_update_time = std::max(max_update_time, cycle.update_time);
+    if (cycle.xn > cycle.x0 && cycle.yn > cycle.y0)
+      window_cells += double(cycle.xn - cycle.x0) * (cycle.yn - cycle.y0);
+    for (unsigned int j = 0; j < num_layers; ++j)
+    {
+      bounds_time[j] += cycle.layers[j].bounds_time;
+      costs_time[j] += cycle.layers[j].costs_time;
+      max_costs_time[j] = std::max(max_costs_time[j], cycle.layers[j].costs_time);
+    }
+  }
+
+  diagnostic_msgs::DiagnosticStatus status;
+  status.name = name_ + ": map update";
+  status.hardware_id = name_;
+  if (frequency > 0.0 && max_update_time > 1 / frequency)
+  {
+    status.level = diagnostic_msgs::DiagnosticStatus::WARN;
+    status.message = "Updates take longer than the update period";
+  }
+  else
+  {
+    status.level = diagnostic_msgs::DiagnosticStatus::OK;
+    status.message = "Updates keep up with the update rate";
+  }
+
+  // times in milliseconds, averaged over the updates since the last diagnostics
+  double n = cycles.size();
+  addValue(status, "Updates", n);
+  addValue(status, "Update time", update_time / n * 1e3);
+  addValue(status, "Max update time", max_update_time * 1e3);
+  addValue(status, "Window cells", window_cells / n);
+  for (unsigned int j = 0; j < num_layers && j < plugins->size(); ++j)
+  {
+    std::string layer = (*plugins)[j]->getName();
+    addValue(status, layer + " bounds time", bounds_time[j] / n * 1e3);
+    addValue(status, layer + " costs time", costs_time[j] / n * 1e3);
+    addValue(status, layer + " max costs time", max_costs_time[j] * 1e3);
+  }
+
+  diagnostic_msgs::DiagnosticArray array;
+  array.header.stamp = ros::Time::now();
+  array.status.push_back(status);
+  diagnostics_pub_.publish(array);
+}
+
+bool Costmap2DROS::dumpProfileService(costmap_2d::GetUpdateProfile::Request& req,
+                                      costmap_2d::GetUpdateProfile::Response& resp)
+{
+  const UpdateProfiler* profiler = layered_costmap_->getProfiler();
+  if (profiler == NULL)
+    return false;
+
+  std::vector<UpdateProfiler::Cycle> cycles;
+  profiler->getCycles(cycles);
+  std::vector<boost::shared_ptr<Layer> >* plugins = layered_costmap_->getPlugins();
+  resp.cycles.resize(cycles.size());
+  for (unsigned int i = 0; i < cycles.size(); ++i)
+  {
+    const UpdateProfiler::Cycle& cycle = cycles[i];
+    costmap_2d::UpdateCycle& msg = resp.cycles[i];
+    msg.stamp = ros::Time(cycle.stamp);
+    msg.update_time = cycle.update_time;
+    msg.x0 = cycle.x0;
+    msg.y0 = cycle.y0;
+    msg.xn = cycle.xn;
+    msg.yn = cycle.yn;
+    msg.layers.resize(cycle.layers.size());
+    for (unsigned int j = 0; j < cycle.layers.size(); ++j)
+    {
+      if (j < plugins->size())
+        msg.layers[j].name = (*plugins)[j]->getName();
+      msg.layers[j].bounds_time = cycle.layers[j].bounds_time;
+      msg.layers[j].costs_time = cycle.layers[j].costs_time;
+      msg.layers[j].bounds_cells = cycle.layers[j].bounds_cells;
+    }
+  }
+  return true;
+}
+
 void Costmap2DROS::updateMap()
 {
   if (!stop_updates_)
@@ -499,6 +628,7 @@ void Costmap2DROS::resetLayers()
   {
     (*plugin)->reset();
   }
+  layered_costmap_->invalidateSnapshot();
 }
 
 bool Costmap2DROS::getRobotPose(tf::Stamped<tf::Pose>& global_pose) const
@@ -38,6 +38,7 @@
 #include <costmap_2d/layered_costmap.h>
 #include <costmap_2d/footprint.h>
 #include <cstdio>
+#include <cstring>
 #include <string>
 #include <algorithm>
 #include <vector>
@@ -48,7 +49,9 @@ namespace costmap_2d
 {
 
 LayeredCostmap::LayeredCostmap(std::string global_frame, bool rolling_window, bool track_unknown) :
-    costmap_(), global_frame_(global_frame), rolling_window_(rolling_window), initialized_(false), size_locked_(false)
+    costmap_(), global_frame_(global_frame), rolling_window_(rolling_window), initialized_(false), size_locked_(false),
+    workers_(NULL), tile_size_(128), publish_snapshots_(false), snapshot_full_copies_(0), snapshot_version_(0),
+    snapshot_x0_(0), snapshot_y0_(0), snapshot_xn_(0), snapshot_yn_(0), profiler_(NULL), cycle_profiler_(NULL)
 {
   if (track_unknown)
     costmap_.setDefaultValue(255);
@@ -62,6 +65,28 @@ LayeredCostmap::~LayeredCostmap()
   {
     plugins_.pop_back();
   }
+
+  delete workers_;
+  delete profiler_;
+}
+
+void LayeredCostmap::setTiledUpdate(int num_threads, unsigned int tile_size)
+{
+  delete workers_;
+  workers_ = NULL;
+
+  // the thread calling updateMap() works on tiles too
+  if (num_threads > 1)
+    workers_ = new WorkerPool(num_threads - 1);
+  tile_size_ = std::max(1u, tile_size);
+}
+
+void LayeredCostmap::setProfiling(unsigned int cycles)
+{
+  delete profiler_;
+  profiler_ = NULL;
+  if (cycles > 0)
+    profiler_ = new UpdateProfiler(cycles, plugins_.size());
 }
 
 void LayeredCostmap::resizeMap(unsigned int size_x, unsigned int size_y, double resolution, double origin_x,
@@ -74,10 +99,20 @@ void LayeredCostmap::resizeMap(unsigned int size_x, unsigned int size_y, double
   {
     (*plugin)->matchSize();
   }
+  invalidateSnapshot();
 }
 
 void LayeredCostmap::updateMap(double robot_x, double robot_y, double robot_yaw)
 {
+  // a profiler set up for another set of layers records nothing
+  cycle_profiler_ = profiler_ && profiler_->getNumLayers() == plugins_.size() ? profiler_ : NULL;
+  ros::WallTime start_time;
+  if (cycle_profiler_)
+  {
+    start_time = ros::WallTime::now();
+    cycle_profiler_->beginCycle(start_time.toSec());
+  }
+
   // if we're using a rolling buffer costmap... we need to update the origin using the robot's position
   if (rolling_window_)
   {
@@ -87,40 +122,60 @@ void LayeredCostmap::updateMap(double robot_x, double robot_y, double robot_yaw)
   }
 
   if (plugins_.size() == 0)
+  {
+    publishSnapshot(0, 0, 0, 0);
+    if (cycle_profiler_)
+      cycle_profiler_->endCycle((ros::WallTime::now() - start_time).toSec(), 0, 0, 0, 0);
     return;
+  }
 
   minx_ = miny_ = 1e30;
   maxx_ = maxy_ = -1e30;
 
-  for (vector<boost::shared_ptr<Layer> >::iterator plugin = plugins_.begin(); plugin != plugins_.end();
-      ++plugin)
+  int x0, xn, y0, yn;
+  for (unsigned int i = 0; i < plugins_.size(); ++i)
   {
-    (*plugin)->updateBounds(robot_x, robot_y, robot_yaw, &minx_, &miny_, &maxx_, &maxy_);
+    ros::WallTime layer_start = cycle_profiler_ ? ros::WallTime::now() : ros::WallTime();
+    plugins_[i]->updateBounds(robot_x, robot_y, robot_yaw, &minx_, &miny_, &maxx_, &maxy_);
+    if (cycle_profiler_)
+    {
+      double layer_time = (ros::WallTime::now() - layer_start).toSec();
+      getWindow(&x0, &y0, &xn, &yn);
+      cycle_profiler_->setBounds(i, layer_time, xn > x0 && yn > y0 ? (xn - x0) * (yn - y0) : 0);
+    }
   }
 
-  int x0, xn, y0, yn;
-  costmap_.worldToMapEnforceBounds(minx_, miny_, x0, y0);
-  costmap_.worldToMapEnforceBounds(maxx_, maxy_, xn, yn);
-
-  x0 = std::max(0, x0);
-  xn = std::min(int(costmap_.getSizeInCellsX()), xn + 1);
-  y0 = std::max(0, y0);
-  yn = std::min(int(costmap_.getSizeInCellsY()), yn + 1);
+  getWindow(&x0, &y0, &xn, &yn);
 
   ROS_DEBUG("Updating area x: [%d, %d] y: [%d, %d]", x0, xn, y0, yn);
 
   if (xn < x0 || yn < y0)
+  {
+    publishSnapshot(0, 0, 0, 0);
+    if (cycle_profiler_)
+      cycle_profiler_->endCycle((ros::WallTime::now() - start_time).toSec(), 0, 0, 0, 0);
     return;
+  }
 
   {
     // Clear and update costmap under a single lock
     boost::unique_lock<Costmap2D::mutex_t> lock(*(costmap_.getMutex()));
     costmap_.resetMap(x0, y0, xn, yn);
-    for (vector<boost::shared_ptr<Layer> >::iterator plugin = plugins_.begin(); plugin != plugins_.end();
-        ++plugin)
+    if (workers_)
+    {
+      updateTiles(x0, y0, xn, yn);
+    }
+    else
     {
-      (*plugin)->updateCosts(costmap_, x0, y0, xn, yn);
+      for (unsigned int i = 0; i < plugins_.size(); ++i)
+      {
+        ros::WallTime layer_start = cycle_profiler_ ? ros::WallTime::now() : ros::WallTime();
+        plugins_[i]->updateCosts(costmap_, x0, y0, xn, yn);
+        if (cycle_profiler_)
+          cycle_profiler_->addCostsTime(i, (ros::WallTime::now() - layer_start).toSec());
+      }
     }
+    publishSnapshot(x0, y0, xn, yn);
   }
 
   bx0_ = x0;
@@ -129,6 +184,174 @@ void LayeredCostmap::updateMap(double robot_x, double robot_y, double robot_yaw)
   byn_ = yn;
 
   initialized_ = true;
+
+  if (cycle_profiler_)
+    cycle_profiler_->endCycle((ros::WallTime::now() - start_time).toSec(), x0, y0, xn, yn);
+}
+
+void LayeredCostmap::getWindow(int* x0, int* y0, int* xn, int* yn)
+{
+  costmap_.worldToMapEnforceBounds(minx_, miny_, *x0, *y0);
+  costmap_.worldToMapEnforceBounds(maxx_, maxy_, *xn, *yn);
+
+  *x0 = std::max(0, *x0);
+  *xn = std::min(int(costmap_.getSizeInCellsX()), *xn + 1);
+  *y0 = std::max(0, *y0);
+  *yn = std::min(int(costmap_.getSizeInCellsY()), *yn + 1);
+}
+
+void LayeredCostmap::updateTiles(int x0, int y0, int xn, int yn)
+{
+  tiles_.clear();
+  for (int ty = y0; ty < yn; ty += tile_size_)
+  {
+    for (int tx = x0; tx < xn; tx += tile_size_)
+    {
+      Tile tile;
+      tile.x0 = tx;
+      tile.y0 = ty;
+      tile.xn = std::min(xn, int(tx + tile_size_));
+      tile.yn = std::min(yn, int(ty + tile_size_));
+      tiles_.push_back(tile);
+    }
+  }
+
+  unsigned int first = 0;
+  while (first < plugins_.size())
+  {
+    if (!plugins_[first]->isTileable())
+    {
+      ros::WallTime layer_start = cycle_profiler_ ? ros::WallTime::now() : ros::WallTime();
+      plugins_[first]->updateCosts(costmap_, x0, y0, xn, yn);
+      if (cycle_profiler_)
+        cycle_profiler_->addCostsTime(first, (ros::WallTime::now() - layer_start).toSec());
+      ++first;
+      continue;
+    }
+
+    // Consecutive tileable layers run back to back on a tile while it is in cache. A layer
+    // with a halo reads cells of neighbouring tiles, so it waits for the whole window.
+    unsigned int last = first + 1;
+    while (last < plugins_.size() && plugins_[last]->isTileable() && plugins_[last]->getTileHalo() == 0)
+      ++last;
+
+    for (unsigned int i = first; i < last; ++i)
+    {
+      ros::WallTime layer_start = cycle_profiler_ ? ros::WallTime::now() : ros::WallTime();
+      plugins_[i]->prepareTiles(costmap_, x0, y0, xn, yn);
+      if (cycle_profiler_)
+        cycle_profiler_->addCostsTime(i, (ros::WallTime::now() - layer_start).toSec());
+    }
+
+    workers_->run(tiles_.size(), boost::bind(&LayeredCostmap::updateTile, this, first, last, _1));
+    first = last;
+  }
+}
+
+void LayeredCostmap::updateTile(unsigned int first_layer, unsigned int last_layer, unsigned int tile)
+{
+  const Tile& t = tiles_[tile];
+  for (unsigned int i = first_layer; i < last_layer; ++i)
+  {
+    ros::WallTime layer_start = cycle_profiler_ ? ros::WallTime::now() : ros::WallTime();
+    plugins_[i]->updateTile(costmap_, t.x0, t.y0, t.xn, t.yn);
+    if (cycle_profiler_)
+      cycle_profiler_->addCostsTime(i, (ros::WallTime::now() - layer_start).toSec());
+  }
+}
+
+boost::shared_ptr<const Costmap2D> LayeredCostmap::getSnapshot(unsigned int* version)
+{
+  {
+    boost::mutex::scoped_lock lock(snapshot_mutex_);
+    if (publish_snapshots_)
+    {
+      if (version)
+        *version = snapshot_version_;
+      return snapshot_;
+    }
+  }
+
+  // the first snapshot, in the lock order of updateMap()
+  boost::unique_lock<Costmap2D::mutex_t> costmap_lock(*(costmap_.getMutex()));
+  boost::mutex::scoped_lock lock(snapshot_mutex_);
+  if (!publish_snapshots_)
+  {
+    snapshot_.reset(new Costmap2D(costmap_));
+    spare_snapshot_.reset();
+    snapshot_full_copies_ = 0;
+    publish_snapshots_ = true;
+    ++snapshot_version_;
+  }
+  if (version)
+    *version = snapshot_version_;
+  return snapshot_;
+}
+
+void LayeredCostmap::invalidateSnapshot()
+{
+  // both buffers are out of date
+  boost::mutex::scoped_lock lock(snapshot_mutex_);
+  snapshot_full_copies_ = 2;
+}
+
+static bool sameGeometry(const Costmap2D& a, const Costmap2D& b)
+{
+  return a.getSizeInCellsX() == b.getSizeInCellsX() && a.getSizeInCellsY() == b.getSizeInCellsY() &&
+      a.getResolution() == b.getResolution() && a.getOriginX() == b.getOriginX() && a.getOriginY() == b.getOriginY();
+}
+
+static void copyWindow(const Costmap2D& from, Costmap2D& to, int x0, int y0, int xn, int yn)
+{
+  if (xn <= x0 || yn <= y0)
+    return;
+  unsigned int size_x = from.getSizeInCellsX();
+  for (int y = y0; y < yn; ++y)
+    memcpy(to.getCharMap() + y * size_x + x0, from.getCharMap() + y * size_x + x0, xn - x0);
+}
+
+void LayeredCostmap::publishSnapshot(int x0, int y0, int xn, int yn)
+{
+  boost::unique_lock<Costmap2D::mutex_t> costmap_lock(*(costmap_.getMutex()));
+  boost::shared_ptr<Costmap2D> next;
+  bool full_copy;
+  {
+    boost::mutex::scoped_lock lock(snapshot_mutex_);
+    if (!publish_snapshots_)
+      return;
+    // A moved origin leaves both buffers out of date. The spare may be from an origin the window has rolled
+    // back to, which it matches, but patching it with the windows of the updates since would miss the cells
+    // that left view and came back.
+    if (!sameGeometry(*snapshot_, costmap_))
+      snapshot_full_copies_ = 2;
+    full_copy = snapshot_full_copies_ > 0;
+    if (!full_copy && (xn <= x0 || yn <= y0))
+      return;
+    next.swap(spare_snapshot_);
+  }
+
+  // readers only get hold of the latest version, so once no one holds the spare no one will
+  if (full_copy || !next || !next.unique() || !sameGeometry(*next, costmap_))
+  {
+    next.reset(new Costmap2D(costmap_));
+  }
+  else
+  {
+    // the spare is one version behind, it misses the window of the last update as well as this one
+    copyWindow(costmap_, *next, snapshot_x0_, snapshot_y0_, snapshot_xn_, snapshot_yn_);
+    copyWindow(costmap_, *next, x0, y0, xn, yn);
+  }
+
+  boost::mutex::scoped_lock lock(snapshot_mutex_);
+  spare_snapshot_ = snapshot_;
+  snapshot_ = next;
+  if (full_copy && snapshot_full_copies_ > 0)
+    --snapshot_full_copies_;
+  ++snapshot_version_;
+  snapshot_x0_ = x0;
+  snapshot_y0_ = y0;
+  snapshot_xn_ = xn;
+  snapshot_yn_ = yn;
 }
 
 bool LayeredCostmap::isCurrent()
@@ -55,7 +55,7 @@ ObservationBuffer::ObservationBuffer(string topic_name, double observation_keep_
     tf_(tf), observation_keep_time_(observation_keep_time), expected_update_rate_(expected_update_rate),
     last_updated_(ros::Time::now()), global_frame_(global_frame), sensor_frame_(sensor_frame), topic_name_(topic_name),
     min_obstacle_height_(min_obstacle_height), max_obstacle_height_(max_obstacle_height),
-    obstacle_range_(obstacle_range), raytrace_range_(raytrace_range), tf_tolerance_(tf_tolerance)
+    obstacle_range_(obstacle_range), raytrace_range_(raytrace_range), tf_tolerance_(tf_tolerance), bytes_copied_(0)
 {
 }
 
@@ -92,8 +92,12 @@ bool ObservationBuffer::setGlobalFrame(const std::string new_global_frame)
       tf_.transformPoint(new_global_frame, origin, origin);
       obs.origin_ = origin.point;
 
-      // we also need to transform the cloud of the observation to the new global frame
-      pcl_ros::transformPointCloud(new_global_frame, *obs.cloud_, *obs.cloud_, tf_);
+      // we also need to transform the cloud of the observation to the new global frame, into a new cloud
+      // since the old one may still be in use by whoever we handed it out to
+      pcl::PointCloud<pcl::PointXYZ>::Ptr global_frame_cloud(new pcl::PointCloud<pcl::PointXYZ>());
+      pcl_ros::transformPointCloud(new_global_frame, *obs.cloud_, *global_frame_cloud, tf_);
+      obs.cloud_ = global_frame_cloud;
+      bytes_copied_ += obs.cloudBytes();
     }
     catch (TransformException& ex)
     {
@@ -117,6 +121,7 @@ void ObservationBuffer::bufferCloud(const sensor_msgs::PointCloud2& cloud)
     // Actually convert the PointCloud2 message into a type we can reason about
     pcl::PointCloud < pcl::PointXYZ > pcl_cloud;
     pcl::fromPCLPointCloud2(pcl_pc2, pcl_cloud);
+    bytes_copied_ += pcl_cloud.points.size() * sizeof(pcl::PointXYZ);
     bufferCloud(pcl_cloud);
   }
   catch (pcl::PCLException& ex)
@@ -151,32 +156,34 @@ void ObservationBuffer::bufferCloud(const pcl::PointCloud<pcl::PointXYZ>& cloud)
     observation_list_.front().raytrace_range_ = raytrace_range_;
     observation_list_.front().obstacle_range_ = obstacle_range_;
 
-    pcl::PointCloud < pcl::PointXYZ > global_frame_cloud;
+    pcl::PointCloud<pcl::PointXYZ>::Ptr global_frame_cloud(new pcl::PointCloud<pcl::PointXYZ>());
 
     // transform the point cloud
-    pcl_ros::transformPointCloud(global_frame_, cloud, global_frame_cloud, tf_);
-    global_frame_cloud.header.stamp = cloud.header.stamp;
+    pcl_ros::transformPointCloud(global_frame_, cloud, *global_frame_cloud, tf_);
+    global_frame_cloud->header.stamp = cloud.header.stamp;
 
-    // now we need to remove observations from the cloud that are below or above our height thresholds
-    pcl::PointCloud < pcl::PointXYZ > &observation_cloud = *(observation_list_.front().cloud_);
-    unsigned int cloud_size = global_frame_cloud.points.size();
-    observation_cloud.points.resize(cloud_size);
+    unsigned int cloud_size = global_frame_cloud->points.size();
+    bytes_copied_ += cloud_size * sizeof(pcl::PointXYZ);
+
+    // now we need to remove observations from the cloud that are below or above our height thresholds,
+    // which we do in place so that the transformed cloud can become the observation without another copy
+    pcl::PointCloud<pcl::PointXYZ>::VectorType& points = global_frame_cloud->points;
     unsigned int point_count = 0;
 
-    // copy over the points that are within our height bounds
+    // keep the points that are within our height bounds
     for (unsigned int i = 0; i < cloud_size; ++i)
     {
-      if (global_frame_cloud.points[i].z <= max_obstacle_height_
-          && global_frame_cloud.points[i].z >= min_obstacle_height_)
+      if (points[i].z <= max_obstacle_height_ && points[i].z >= min_obstacle_height_)
       {
-        observation_cloud.points[point_count++] = global_frame_cloud.points[i];
+        points[point_count++] = points[i];
       }
     }
 
     // resize the cloud for the number of legal points
-    observation_cloud.points.resize(point_count);
-    observation_cloud.header.stamp = cloud.header.stamp;
-    observation_cloud.header.frame_id = global_frame_cloud.header.frame_id;
+    points.resize(point_count);
+    global_frame_cloud->width = point_count;
+    global_frame_cloud->height = 1;
+    observation_list_.front().cloud_ = global_frame_cloud;
   }
   catch (TransformException& ex)
   {
@@ -194,13 +201,13 @@ void ObservationBuffer::bufferCloud(const pcl::PointCloud<pcl::PointXYZ>& cloud)
   purgeStaleObservations();
 }
 
-// returns a copy of the observations
+// returns the observations, which share their clouds with the buffer
 void ObservationBuffer::getObservations(vector<Observation>& observations)
 {
   // first... let's make sure that we don't have any stale observations
   purgeStaleObservations();
 
-  // now we'll just copy the observations for the caller
+  // now we'll just copy the observations for the caller, the points are not copied
   list<Observation>::iterator obs_it;
   for (obs_it = observation_list_.begin(); obs_it != observation_list_.end(); ++obs_it)
   {
@@ -0,0 +1,126 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+#include <costmap_2d/update_profiler.h>
+#include <algorithm>
+
+namespace costmap_2d
+{
+
+UpdateProfiler::UpdateProfiler(unsigned int capacity, unsigned int num_layers) :
+    capacity_(std::max(1u, capacity)), num_layers_(num_layers), slots_(new Slot[capacity_]),
+    slot_layers_(capacity_ * num_layers), current_stamp_(0.0), current_layers_(num_layers),
+    costs_nsec_(new boost::atomic<boost::uint64_t>[num_layers]), recorded_(0)
+{
+  for (unsigned int i = 0; i < capacity_; ++i)
+  {
+    slots_[i].sequence.store(0);
+    slots_[i].cycle = 0;
+  }
+  for (unsigned int i = 0; i < num_layers_; ++i)
+    costs_nsec_[i].store(0);
+}
+
+void UpdateProfiler::beginCycle(double stamp)
+{
+  current_stamp_ = stamp;
+  for (unsigned int i = 0; i < num_layers_; ++i)
+  {
+    current_layers_[i] = Layer();
+    costs_nsec_[i].store(0, boost::memory_order_relaxed);
+  }
+}
+
+void UpdateProfiler::endCycle(double update_time, int x0, int y0, int xn, int yn)
+{
+  unsigned int cycle = recorded_.load(boost::memory_order_relaxed);
+  unsigned int index = cycle % capacity_;
+  Slot& slot = slots_[index];
+
+  // readers that see the sequence change while copying the slot drop what they copied
+  unsigned int sequence = slot.sequence.load(boost::memory_order_relaxed);
+  slot.sequence.store(sequence + 1, boost::memory_order_relaxed);
+  boost::atomic_thread_fence(boost::memory_order_release);
+
+  slot.cycle = cycle;
+  slot.stamp = current_stamp_;
+  slot.update_time = update_time;
+  slot.x0 = x0;
+  slot.y0 = y0;
+  slot.xn = xn;
+  slot.yn = yn;
+  for (unsigned int i = 0; i < num_layers_; ++i)
+  {
+    Layer& layer = slot_layers_[index * num_layers_ + i];
+    layer = current_layers_[i];
+    layer.costs_time = costs_nsec_[i].load(boost::memory_order_relaxed) / 1e9;
+  }
+
+  slot.sequence.store(sequence + 2, boost::memory_order_release);
+  recorded_.store(cycle + 1, boost::memory_order_release);
+}
+
+unsigned int UpdateProfiler::getCycles(std::vector<Cycle>& cycles, unsigned int since) const
+{
+  unsigned int recorded = recorded_.load(boost::memory_order_acquire);
+  unsigned int first = std::max(since, recorded > capacity_ ? recorded - capacity_ : 0);
+
+  cycles.clear();
+  for (unsigned int c = first; c < recorded; ++c)
+  {
+    unsigned int index = c % capacity_;
+    const Slot& slot = slots_[index];
+    unsigned int sequence = slot.sequence.load(boost::memory_order_acquire);
+    if (sequence & 1)
+      continue;
+
+    Cycle cycle;
+    unsigned int slot_cycle = slot.cycle;
+    cycle.stamp = slot.stamp;
+    cycle.update_time = slot.update_time;
+    cycle.x0 = slot.x0;
+    cycle.y0 = slot.y0;
+    cycle.xn = slot.xn;
+    cycle.yn = slot.yn;
+    cycle.layers.assign(slot_layers_.begin() + index * num_layers_, slot_layers_.begin() + (index + 1) * num_layers_);
+
+    boost::atomic_thread_fence(boost::memory_order_acquire);
+    if (slot.sequence.load(boost::memory_order_relaxed) != sequence || slot_cycle != c)
+      continue;
+    cycles.push_back(cycle);
+  }
+  return recorded;
+}
+
+}  // namespace costmap_2d
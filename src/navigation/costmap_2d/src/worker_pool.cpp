@@ -0,0 +1,120 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+#include <costmap_2d/worker_pool.h>
+
+namespace costmap_2d
+{
+
+WorkerPool::WorkerPool(unsigned int num_threads) :
+    job_(NULL), count_(0), next_(0), pending_(0), generation_(0), shutdown_(false)
+{
+  for (unsigned int i = 0; i < num_threads; ++i)
+    threads_.push_back(new boost::thread(boost::bind(&WorkerPool::workerThread, this)));
+}
+
+WorkerPool::~WorkerPool()
+{
+  {
+    boost::unique_lock<boost::mutex> lock(mutex_);
+    shutdown_ = true;
+  }
+  work_available_.notify_all();
+
+  for (unsigned int i = 0; i < threads_.size(); ++i)
+  {
+    threads_[i]->join();
+    delete threads_[i];
+  }
+}
+
+void WorkerPool::run(unsigned int count, const boost::function<void(unsigned int)>& job)
+{
+  // nothing to share, don't pay for the wakeups
+  if (threads_.empty() || count <= 1)
+  {
+    for (unsigned int i = 0; i < count; ++i)
+      job(i);
+    return;
+  }
+
+  boost::unique_lock<boost::mutex> lock(mutex_);
+  job_ = &job;
+  count_ = count;
+  next_ = 0;
+  pending_ = count;
+  ++generation_;
+  work_available_.notify_all();
+
+  runJobs(lock);
+
+  while (pending_ > 0)
+    work_done_.wait(lock);
+  job_ = NULL;
+}
+
+void WorkerPool::runJobs(boost::unique_lock<boost::mutex>& lock)
+{
+  while (next_ < count_)
+  {
+    unsigned int i = next_++;
+    const boost::function<void(unsigned int)>& job = *job_;
+
+    lock.unlock();
+    job(i);
+    lock.lock();
+
+    if (--pending_ == 0)
+      work_done_.notify_all();
+  }
+}
+
+void WorkerPool::workerThread()
+{
+  unsigned int seen_generation = 0;
+  boost::unique_lock<boost::mutex> lock(mutex_);
+  while (true)
+  {
+    while (!shutdown_ && seen_generation == generation_)
+      work_available_.wait(lock);
+
+    if (shutdown_)
+      return;
+
+    seen_generation = generation_;
+    runJobs(lock);
+  }
+}
+
+}  // namespace costmap_2d
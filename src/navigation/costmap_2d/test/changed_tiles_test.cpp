@@ -0,0 +1,227 @@
+/*
+ * Copyright (c) 2013, Willow Garage, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Willow Garage, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <vector>
+
+#include "costmap_2d/changed_tiles.h"
+
+using namespace costmap_2d;
+
+static const unsigned int T = ChangedTiles::TILE_SIZE;
+
+// Sends half the value, so that pairs of values look the same
+struct HalfTable
+{
+  char table[256];
+  HalfTable()
+  {
+    for (int i = 0; i < 256; i++)
+      table[i] = i / 2;
+  }
+};
+
+class ChangedTilesTest : public testing::Test
+{
+protected:
+  void start(unsigned int size_x, unsigned int size_y)
+  {
+    size_x_ = size_x;
+    size_y_ = size_y;
+    data_.assign(size_x * size_y, 0);
+    tiles_.reset(size_x, size_y, std::vector<int8_t>(size_x * size_y, 0));
+    changed_.clear();
+  }
+
+  // Changes one cell of a tile, and expects the tile to be sent
+  void change(unsigned int tx, unsigned int ty)
+  {
+    unsigned int x = std::min(size_x_ - 1, tx * T + 3), y = std::min(size_y_ - 1, ty * T + 5);
+    data_[y * size_x_ + x] += 2;
+    changed_.push_back(tx);
+    changed_.push_back(ty);
+  }
+
+  void collect()
+  {
+    tiles_.markDirty(0, size_x_, 0, size_y_);
+    tiles_.collect(&data_[0], half_.table, rects_);
+  }
+
+  // Every cell of the changed tiles is in exactly one rectangle, and no other cell is in any
+  void expectExactCover()
+  {
+    std::vector<int> expected(size_x_ * size_y_, 0), covered(size_x_ * size_y_, 0);
+    for (unsigned int k = 0; k < changed_.size(); k += 2)
+      for (unsigned int y = changed_[k + 1] * T; y < std::min(size_y_, (changed_[k + 1] + 1) * T); y++)
+        for (unsigned int x = changed_[k] * T; x < std::min(size_x_, (changed_[k] + 1) * T); x++)
+          expected[y * size_x_ + x] = 1;
+
+    for (unsigned int k = 0; k < rects_.size(); k++)
+    {
+      const ChangedTiles::Rect& r = rects_[k];
+      ASSERT_LT(r.x0, r.xn);
+      ASSERT_LT(r.y0, r.yn);
+      ASSERT_LE(r.xn, size_x_);
+      ASSERT_LE(r.yn, size_y_);
+      for (unsigned int y = r.y0; y < r.yn; y++)
+        for (unsigned int x = r.x0; x < r.xn; x++)
+          covered[y * size_x_ + x]++;
+    }
+    for (unsigned int i = 0; i < size_x_ * size_y_; i++)
+      ASSERT_EQ(expected[i], covered[i]) << "at " << i % size_x_ << ", " << i / size_x_;
+  }
+
+  void expectValuesSent()
+  {
+    const std::vector<int8_t>& values = tiles_.getValues();
+    ASSERT_EQ(data_.size(), values.size());
+    for (unsigned int i = 0; i < data_.size(); i++)
+      ASSERT_EQ(half_.table[data_[i]], values[i]);
+  }
+
+  HalfTable half_;
+  unsigned int size_x_, size_y_;
+  std::vector<unsigned char> data_;
+  ChangedTiles tiles_;
+  std::vector<unsigned int> changed_;  // tile coordinates, x then y
+  std::vector<ChangedTiles::Rect> rects_;
+};
+
+TEST_F(ChangedTilesTest, lShapeMerges)
+{
+  start(5 * T, 4 * T);
+  change(1, 0);
+  change(1, 1);
+  change(1, 2);
+  change(2, 2);
+  change(3, 2);
+  collect();
+  expectExactCover();
+  expectValuesSent();
+  // the upright of the L, and its foot
+  EXPECT_EQ(2u, rects_.size());
+}
+
+TEST_F(ChangedTilesTest, staircaseMerges)
+{
+  start(5 * T, 5 * T);
+  for (unsigned int ty = 0; ty < 4; ty++)
+    for (unsigned int tx = 0; tx <= ty; tx++)
+      change(tx, ty);
+  // and a step down, which no rectangle above is as wide as
+  change(3, 4);
+  change(4, 4);
+  collect();
+  expectExactCover();
+  expectValuesSent();
+  EXPECT_EQ(5u, rects_.size());
+
+  // nothing is sent twice
+  collect();
+  EXPECT_TRUE(rects_.empty());
+}
+
+TEST_F(ChangedTilesTest, unchangedValuesAreNotSent)
+{
+  start(4 * T, 3 * T);
+
+  // a different cost which is sent as the same value, and a cost changed back
+  data_[T + 1] = 1;
+  data_[2 * T * 4 * T + 7] = 10;
+  tiles_.markDirty(0, 4 * T, 0, 3 * T);
+  data_[2 * T * 4 * T + 7] = 0;
+  tiles_.collect(&data_[0], half_.table, rects_);
+  EXPECT_TRUE(rects_.empty());
+
+  // a change in a tile that was not marked waits until it is
+  change(3, 1);
+  tiles_.markDirty(0, 2 * T, 0, 3 * T);
+  tiles_.collect(&data_[0], half_.table, rects_);
+  EXPECT_TRUE(rects_.empty());
+  tiles_.markDirty(3 * T + 10, 3 * T + 11, T + 2, T + 3);
+  tiles_.collect(&data_[0], half_.table, rects_);
+  expectExactCover();
+  expectValuesSent();
+  EXPECT_EQ(1u, rects_.size());
+}
+
+TEST_F(ChangedTilesTest, edgeTilesOfOddSizedMaps)
+{
+  start(2 * T + 6, T + 13);
+  change(2, 1);
+  change(2, 0);
+  change(0, 1);
+  // bounds past the edge of the map only mark the tiles on it
+  tiles_.markDirty(T, 5 * T, 0, 5 * T);
+  tiles_.markDirty(0, 1, T, T + 1);
+  tiles_.collect(&data_[0], half_.table, rects_);
+  expectExactCover();
+  expectValuesSent();
+  EXPECT_EQ(2u, rects_.size());
+
+  ASSERT_TRUE(tiles_.matches(2 * T + 6, T + 13));
+  EXPECT_FALSE(tiles_.matches(3 * T, T + 13));
+}
+
+TEST_F(ChangedTilesTest, tooManyRectanglesAreBounded)
+{
+  // a checkerboard of changed tiles, with no two that merge, as many as fit
+  start(6 * T, 5 * T);
+  for (unsigned int ty = 1; ty < 5; ty++)
+    for (unsigned int tx = ty % 2; tx < 5; tx += 2)
+      change(tx, ty);
+  tiles_.markDirty(0, 6 * T, 0, 5 * T);
+  tiles_.collect(&data_[0], half_.table, rects_, 10);
+  expectExactCover();
+  expectValuesSent();
+  EXPECT_EQ(10u, rects_.size());
+
+  // and one more, which is sent as the box around them all
+  start(6 * T, 5 * T);
+  for (unsigned int ty = 1; ty < 5; ty++)
+    for (unsigned int tx = ty % 2; tx < 5; tx += 2)
+      change(tx, ty);
+  change(4, 0);
+  tiles_.markDirty(0, 6 * T, 0, 5 * T);
+  tiles_.collect(&data_[0], half_.table, rects_, 10);
+  expectValuesSent();
+  ASSERT_EQ(1u, rects_.size());
+  EXPECT_EQ(0u, rects_[0].x0);
+  EXPECT_EQ(5 * T, rects_[0].xn);
+  EXPECT_EQ(0u, rects_[0].y0);
+  EXPECT_EQ(5 * T, rects_[0].yn);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2013, Willow Garage, Inc.
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Willow Garage, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * Benchmark comparing the priority queue and the bucketed queue inflation
+ * of InflationLayer on the map published by map_server.
+ *
+ * roslaunch costmap_2d inflation_benchmark.launch
+ * roslaunch costmap_2d inflation_benchmark.launch map_args:=`rospack find costmap_2d`/test/TenByTen.yaml
+ */
+
+#include <costmap_2d/costmap_2d.h>
+#include <costmap_2d/layered_costmap.h>
+#include <costmap_2d/static_layer.h>
+#include <costmap_2d/inflation_layer.h>
+#include <costmap_2d/footprint.h>
+#include <tf/transform_listener.h>
+
+using namespace costmap_2d;
+
+costmap_2d::InflationLayer* addInflationLayer(LayeredCostmap& layers, tf::TransformListener& tf, std::string name)
+{
+  InflationLayer* ilayer = new InflationLayer();
+  ilayer->initialize(&layers, name, &tf);
+  layers.addPlugin(boost::shared_ptr<Layer>(ilayer));
+  return ilayer;
+}
+
+/**
+ * @brief  Inflate the whole map from a fresh copy of the obstacles and return the average wall time in seconds
+ */
+double timeInflation(InflationLayer* ilayer, Costmap2D& master, const Costmap2D& obstacles, int iterations)
+{
+  unsigned int size_x = master.getSizeInCellsX(), size_y = master.getSizeInCellsY();
+  double total = 0.0;
+  for (int i = 0; i < iterations; ++i)
+  {
+    memcpy(master.getCharMap(), obstacles.getCharMap(), size_x * size_y * sizeof(unsigned char));
+    ros::WallTime start = ros::WallTime::now();
+    ilayer->updateCosts(master, 0, 0, size_x, size_y);
+    total += (ros::WallTime::now() - start).toSec();
+  }
+  return total / iterations;
+}
+
+int main(int argc, char** argv)
+{
+  ros::init(argc, argv, "inflation_benchmark");
+  ros::NodeHandle private_nh("~");
+
+  int iterations;
+  double inflation_radius, robot_radius;
+  private_nh.param("iterations", iterations, 20);
+  private_nh.param("inflation_radius", inflation_radius, 0.55);
+  private_nh.param("robot_radius", robot_radius, 0.46);
+
+  private_nh.setParam("heap/inflation_radius", inflation_radius);
+  private_nh.setParam("heap/use_bucket_queue", false);
+  private_nh.setParam("bucket/inflation_radius", inflation_radius);
+  private_nh.setParam("bucket/use_bucket_queue", true);
+
+  tf::TransformListener tf;
+  LayeredCostmap layers("map", false, true);
+
+  // blocks until the map has been received and the costmap resized to it
+  StaticLayer* slayer = new StaticLayer();
+  layers.addPlugin(boost::shared_ptr<Layer>(slayer));
+  slayer->initialize(&layers, "static", &tf);
+
+  InflationLayer* heap_layer = addInflationLayer(layers, tf, "heap");
+  InflationLayer* bucket_layer = addInflationLayer(layers, tf, "bucket");
+  layers.setFootprint(makeFootprintFromRadius(robot_radius));
+
+  Costmap2D& master = *layers.getCostmap();
+  Costmap2D obstacles(*slayer);
+  unsigned int size_x = master.getSizeInCellsX(), size_y = master.getSizeInCellsY();
+
+  double heap_time = timeInflation(heap_layer, master, obstacles, iterations);
+  Costmap2D heap_result(master);
+  double bucket_time = timeInflation(bucket_layer, master, obstacles, iterations);
+
+  unsigned int differences = 0;
+  for (unsigned int i = 0; i < size_x * size_y; ++i)
+  {
+    if (heap_result.getCharMap()[i] != master.getCharMap()[i])
+      ++differences;
+  }
+
+  ROS_INFO("Inflating a %u x %u map at %.3f m/cell to %.2f m, averaged over %d runs",
+           size_x, size_y, master.getResolution(), inflation_radius, iterations);
+  ROS_INFO("  priority queue: %9.3f ms", heap_time * 1e3);
+  ROS_INFO("  bucket queues:  %9.3f ms (%.2fx)", bucket_time * 1e3, heap_time / bucket_time);
+  ROS_INFO("  %u cells differ (equal distance ties broken in a different order)", differences);
+
+  return 0;
+}
@@ -36,6 +36,7 @@
 #include <costmap_2d/layered_costmap.h>
 #include <costmap_2d/obstacle_layer.h>
 #include <costmap_2d/inflation_layer.h>
+#include <costmap_2d/distance_layer.h>
 #include <costmap_2d/observation_buffer.h>
 #include <costmap_2d/testing_helper.h>
 #include <set>
@@ -315,6 +316,351 @@ TEST(costmap, testInflation3){
   ASSERT_EQ(countValues(*costmap, INSCRIBED_INFLATED_OBSTACLE), (unsigned int)4);
 }
 
+/**
+ * Test that the bucketed inflation queues produce the same costs as the priority queue
+ */
+TEST(costmap, testBucketQueueMatchesPriorityQueue){
+  tf::TransformListener tf;
+  ros::NodeHandle nh;
+  nh.setParam("/inflation_tests/inflation_bucket/use_bucket_queue", true);
+  nh.setParam("/inflation_tests/inflation_bucket/inflation_radius", 4.0);
+
+  LayeredCostmap heap_layers("frame", false, false);
+  LayeredCostmap bucket_layers("frame", false, false);
+  heap_layers.resizeMap(100, 100, 1, 0, 0);
+  bucket_layers.resizeMap(100, 100, 1, 0, 0);
+
+  // Footprint with inscribed radius = 1.5
+  std::vector<Point> polygon = setRadii(heap_layers, 1.5, 1.5, 4.0);
+
+  ObstacleLayer* heap_olayer = addObstacleLayer(heap_layers, tf);
+  addInflationLayer(heap_layers, tf);
+
+  ObstacleLayer* bucket_olayer = addObstacleLayer(bucket_layers, tf);
+  InflationLayer* bucket_ilayer = new InflationLayer();
+  bucket_ilayer->initialize(&bucket_layers, "inflation_bucket", &tf);
+  bucket_layers.addPlugin(boost::shared_ptr<Layer>(bucket_ilayer));
+
+  heap_layers.setFootprint(polygon);
+  bucket_layers.setFootprint(polygon);
+
+  // Obstacles far enough apart that no cell is equally close to two of them,
+  // which is the only case where the two queues may break ties differently
+  double obstacles[][2] = {{10, 10}, {30, 70}, {70, 25}, {85, 85}, {50, 50}, {51, 50}, {52, 50}};
+  for (unsigned int i = 0; i < sizeof(obstacles) / sizeof(obstacles[0]); i++)
+  {
+    addObservation(heap_olayer, obstacles[i][0], obstacles[i][1], MAX_Z);
+    addObservation(bucket_olayer, obstacles[i][0], obstacles[i][1], MAX_Z);
+  }
+
+  heap_layers.updateMap(0,0,0);
+  bucket_layers.updateMap(0,0,0);
+
+  Costmap2D* heap_costmap = heap_layers.getCostmap();
+  Costmap2D* bucket_costmap = bucket_layers.getCostmap();
+  ASSERT_EQ(countValues(*bucket_costmap, LETHAL_OBSTACLE), (unsigned int)7);
+  for (unsigned int j = 0; j < 100; j++)
+    for (unsigned int i = 0; i < 100; i++)
+      ASSERT_EQ(heap_costmap->getCost(i, j), bucket_costmap->getCost(i, j));
+
+  // Running again reuses the queues and the generation-stamped seen array
+  bucket_layers.updateMap(0,0,0);
+  for (unsigned int j = 0; j < 100; j++)
+    for (unsigned int i = 0; i < 100; i++)
+      ASSERT_EQ(heap_costmap->getCost(i, j), bucket_costmap->getCost(i, j));
+}
+
+/**
+ * Test that incremental inflation lowers the costs around an obstacle that has been cleared
+ */
+TEST(costmap, testIncrementalInflationClearsObstacles){
+  tf::TransformListener tf;
+  ros::NodeHandle nh;
+  nh.setParam("/inflation_tests/inflation_incremental/use_incremental_inflation", true);
+  nh.setParam("/inflation_tests/inflation_incremental/inflation_radius", 3.0);
+
+  LayeredCostmap layers("frame", false, false);
+  LayeredCostmap reference_layers("frame", false, false);
+  layers.resizeMap(10, 10, 1, 0, 0);
+  reference_layers.resizeMap(10, 10, 1, 0, 0);
+
+  // 1 2 3
+  std::vector<Point> polygon = setRadii(reference_layers, 1, 1.75, 3);
+
+  ObstacleLayer* olayer = addObstacleLayer(layers, tf);
+  InflationLayer* ilayer = new InflationLayer();
+  ilayer->initialize(&layers, "inflation_incremental", &tf);
+  layers.addPlugin(boost::shared_ptr<Layer>(ilayer));
+  layers.setFootprint(polygon);
+
+  ObstacleLayer* reference_olayer = addObstacleLayer(reference_layers, tf);
+  addInflationLayer(reference_layers, tf);
+  reference_layers.setFootprint(polygon);
+
+  Costmap2D* costmap = layers.getCostmap();
+
+  // Same expectations as testInflation3
+  addObservation(olayer, 5, 5, MAX_Z);
+  layers.updateMap(0,0,0);
+  ASSERT_EQ(countValues(*costmap, FREE_SPACE, false), (unsigned int)29);
+  ASSERT_EQ(countValues(*costmap, LETHAL_OBSTACLE), (unsigned int)1);
+  ASSERT_EQ(countValues(*costmap, INSCRIBED_INFLATED_OBSTACLE), (unsigned int)4);
+
+  // The ray to <7, 7> goes through <5, 5>, which clears it
+  olayer->clearStaticObservations(true, true);
+  addObservation(olayer, 7, 7, MAX_Z);
+  layers.updateMap(0,0,0);
+
+  addObservation(reference_olayer, 7, 7, MAX_Z);
+  reference_layers.updateMap(0,0,0);
+  Costmap2D* reference = reference_layers.getCostmap();
+
+  ASSERT_EQ(costmap->getCost(5, 5), reference->getCost(5, 5));
+  ASSERT_EQ(countValues(*costmap, LETHAL_OBSTACLE), (unsigned int)1);
+  for (unsigned int j = 0; j < 10; j++)
+    for (unsigned int i = 0; i < 10; i++)
+      ASSERT_EQ(costmap->getCost(i, j), reference->getCost(i, j));
+
+  // Update again - should see no change
+  layers.updateMap(0,0,0);
+  for (unsigned int j = 0; j < 10; j++)
+    for (unsigned int i = 0; i < 10; i++)
+      ASSERT_EQ(costmap->getCost(i, j), reference->getCost(i, j));
+}
+
+/**
+ * Test that incremental inflation follows a rolling window, including the obstacles that come into or leave view
+ */
+TEST(costmap, testIncrementalInflationRollingWindow){
+  tf::TransformListener tf;
+  ros::NodeHandle nh;
+  nh.setParam("/inflation_tests/inflation_incremental/use_incremental_inflation", true);
+  nh.setParam("/inflation_tests/inflation_incremental/inflation_radius", 4.0);
+
+  LayeredCostmap layers("frame", true, false);
+  LayeredCostmap reference_layers("frame", true, false);
+  layers.resizeMap(30, 30, 1, 0, 0);
+  reference_layers.resizeMap(30, 30, 1, 0, 0);
+
+  std::vector<Point> polygon = setRadii(reference_layers, 1, 1.5, 4);
+
+  ObstacleLayer* olayer = addObstacleLayer(layers, tf);
+  InflationLayer* ilayer = new InflationLayer();
+  ilayer->initialize(&layers, "inflation_incremental", &tf);
+  layers.addPlugin(boost::shared_ptr<Layer>(ilayer));
+  layers.setFootprint(polygon);
+
+  ObstacleLayer* reference_olayer = addObstacleLayer(reference_layers, tf);
+  addInflationLayer(reference_layers, tf);
+  reference_layers.setFootprint(polygon);
+
+  // Moves of a cell or two, a fractional one, one backwards and a jump further than the map is wide
+  double path[][2] = {{15, 15}, {16, 15}, {18, 16}, {20.5, 16}, {23, 19}, {22, 22}, {19, 21}, {19, 14}, {70, 40}, {72, 37}};
+  Costmap2D* costmap = layers.getCostmap();
+  Costmap2D* reference = reference_layers.getCostmap();
+  for (unsigned int k = 0; k < sizeof(path) / sizeof(path[0]); k++)
+  {
+    double x = path[k][0], y = path[k][1];
+
+    // Obstacles far enough apart that no cell is within the inflation radius of two of them. Seen from the
+    // robot, the ones out of view clear up to the edge of the map, so every update covers the whole map.
+    olayer->clearStaticObservations(true, true);
+    reference_olayer->clearStaticObservations(true, true);
+    for (int oy = -15; oy < 70; oy += 10)
+    {
+      for (int ox = -15; ox < 110; ox += 10)
+      {
+        addObservation(olayer, ox + 0.5, oy + 0.5, MAX_Z, x, y);
+        addObservation(reference_olayer, ox + 0.5, oy + 0.5, MAX_Z, x, y);
+      }
+    }
+
+    layers.updateMap(x, y, 0);
+    reference_layers.updateMap(x, y, 0);
+
+    ASSERT_EQ(costmap->getOriginX(), reference->getOriginX());
+    ASSERT_EQ(costmap->getOriginY(), reference->getOriginY());
+    ASSERT_GT(countValues(*costmap, LETHAL_OBSTACLE), (unsigned int)0);
+    for (unsigned int j = 0; j < 30; j++)
+      for (unsigned int i = 0; i < 30; i++)
+        ASSERT_EQ(costmap->getCost(i, j), reference->getCost(i, j));
+  }
+}
+
+/**
+ * Test that incremental inflation keeps the costs between two equally close obstacles when either of them is cleared
+ */
+TEST(costmap, testIncrementalInflationEquidistantObstacles){
+  tf::TransformListener tf;
+  ros::NodeHandle nh;
+  nh.setParam("/inflation_tests/inflation_incremental/use_incremental_inflation", true);
+  nh.setParam("/inflation_tests/inflation_incremental/inflation_radius", 4.0);
+
+  LayeredCostmap layers("frame", false, false);
+  LayeredCostmap reference_layers("frame", false, false);
+  layers.resizeMap(30, 30, 1, 0, 0);
+  reference_layers.resizeMap(30, 30, 1, 0, 0);
+
+  std::vector<Point> polygon = setRadii(reference_layers, 1, 1.5, 4);
+
+  ObstacleLayer* olayer = addObstacleLayer(layers, tf);
+  InflationLayer* ilayer = new InflationLayer();
+  ilayer->initialize(&layers, "inflation_incremental", &tf);
+  layers.addPlugin(boost::shared_ptr<Layer>(ilayer));
+  layers.setFootprint(polygon);
+
+  ObstacleLayer* reference_olayer = addObstacleLayer(reference_layers, tf);
+  addInflationLayer(reference_layers, tf);
+  reference_layers.setFootprint(polygon);
+
+  // The obstacles at <12, 15> and <18, 15> are equally close to every cell of column 15, which keeps whichever
+  // reached it first. Each of them is cleared in turn by a ray along its column, which marks the end of the ray
+  // instead. Every row is an observation: the update it is made in, the point and the origin of the ray.
+  double observations[][5] = {{0, 12.5, 15.5, 0.0, 0.0}, {0, 18.5, 15.5, 0.0, 0.0}, {1, 12.5, 25.5, 12.5, 5.5},
+                              {2, 12.5, 15.5, 0.0, 0.0}, {3, 18.5, 25.5, 18.5, 5.5}};
+  Costmap2D* costmap = layers.getCostmap();
+  Costmap2D* reference = reference_layers.getCostmap();
+  for (unsigned int k = 0; k < 4; k++)
+  {
+    olayer->clearStaticObservations(true, true);
+    reference_olayer->clearStaticObservations(true, true);
+    for (unsigned int n = 0; n < sizeof(observations) / sizeof(observations[0]); n++)
+    {
+      double* o = observations[n];
+      if (o[0] != k)
+        continue;
+      addObservation(olayer, o[1], o[2], MAX_Z, o[3], o[4]);
+      addObservation(reference_olayer, o[1], o[2], MAX_Z, o[3], o[4]);
+    }
+
+    layers.updateMap(0,0,0);
+    reference_layers.updateMap(0,0,0);
+
+    ASSERT_EQ(costmap->getCost(12, 15) == LETHAL_OBSTACLE, k != 1);
+    ASSERT_EQ(costmap->getCost(18, 15) == LETHAL_OBSTACLE, k != 3);
+    ASSERT_GT(costmap->getCost(15, 15), FREE_SPACE);
+    for (unsigned int j = 0; j < 30; j++)
+      for (unsigned int i = 0; i < 30; i++)
+        ASSERT_EQ(costmap->getCost(i, j), reference->getCost(i, j));
+  }
+}
+
+/**
+ * Test that updating the layers tile by tile on several threads gives the same costmap as updating them serially
+ */
+TEST(costmap, testTiledUpdateMatchesSerial){
+  tf::TransformListener tf;
+  ros::NodeHandle nh;
+  nh.setParam("/inflation_tests/inflation_incremental/use_incremental_inflation", true);
+  nh.setParam("/inflation_tests/inflation_incremental/inflation_radius", 4.0);
+
+  LayeredCostmap layers("frame", false, false);
+  LayeredCostmap tiled_layers("frame", false, false);
+  layers.resizeMap(100, 100, 1, 0, 0);
+  tiled_layers.resizeMap(100, 100, 1, 0, 0);
+  // tiles that do not divide the map evenly, and that are smaller than the inflation radius
+  tiled_layers.setTiledUpdate(4, 7);
+
+  std::vector<Point> polygon = setRadii(layers, 1, 1.5, 4);
+
+  ObstacleLayer* olayer = addObstacleLayer(layers, tf);
+  InflationLayer* ilayer = new InflationLayer();
+  ilayer->initialize(&layers, "inflation_incremental", &tf);
+  layers.addPlugin(boost::shared_ptr<Layer>(ilayer));
+  layers.setFootprint(polygon);
+
+  ObstacleLayer* tiled_olayer = addObstacleLayer(tiled_layers, tf);
+  InflationLayer* tiled_ilayer = new InflationLayer();
+  tiled_ilayer->initialize(&tiled_layers, "inflation_incremental", &tf);
+  tiled_layers.addPlugin(boost::shared_ptr<Layer>(tiled_ilayer));
+  tiled_layers.setFootprint(polygon);
+
+  addObservation(olayer, 10, 10, MAX_Z);
+  addObservation(olayer, 20, 21, MAX_Z);
+  addObservation(olayer, 6, 40, MAX_Z);
+  addObservation(tiled_olayer, 10, 10, MAX_Z);
+  addObservation(tiled_olayer, 20, 21, MAX_Z);
+  addObservation(tiled_olayer, 6, 40, MAX_Z);
+
+  layers.updateMap(0,0,0);
+  tiled_layers.updateMap(0,0,0);
+
+  Costmap2D* costmap = layers.getCostmap();
+  Costmap2D* tiled_costmap = tiled_layers.getCostmap();
+  ASSERT_EQ(countValues(*tiled_costmap, LETHAL_OBSTACLE), (unsigned int)3);
+  for (unsigned int j = 0; j < 100; j++)
+    for (unsigned int i = 0; i < 100; i++)
+      ASSERT_EQ(costmap->getCost(i, j), tiled_costmap->getCost(i, j));
+
+  // The ray to <12, 12> goes through <10, 10>, which clears it
+  olayer->clearStaticObservations(true, true);
+  tiled_olayer->clearStaticObservations(true, true);
+  addObservation(olayer, 12, 12, MAX_Z);
+  addObservation(tiled_olayer, 12, 12, MAX_Z);
+
+  layers.updateMap(0,0,0);
+  tiled_layers.updateMap(0,0,0);
+  for (unsigned int j = 0; j < 100; j++)
+    for (unsigned int i = 0; i < 100; i++)
+      ASSERT_EQ(costmap->getCost(i, j), tiled_costmap->getCost(i, j));
+}
+
+/**
+ * Test that the distance layer gives the distance to the nearest lethal cell, also after one is cleared
+ */
+TEST(costmap, testDistanceLayer){
+  tf::TransformListener tf;
+  ros::NodeHandle nh;
+  nh.setParam("/inflation_tests/distance/max_distance", 6.0);
+
+  LayeredCostmap layers("frame", false, false);
+  layers.resizeMap(40, 30, 1, 0, 0);
+
+  ObstacleLayer* olayer = addObstacleLayer(layers, tf);
+  DistanceLayer* dlayer = new DistanceLayer();
+  dlayer->initialize(&layers, "distance", &tf);
+  layers.addPlugin(boost::shared_ptr<Layer>(dlayer));
+
+  addObservation(olayer, 10, 10, MAX_Z);
+  addObservation(olayer, 20, 21, MAX_Z);
+  addObservation(olayer, 30, 8, MAX_Z);
+
+  for (int pass = 0; pass < 2; pass++)
+  {
+    layers.updateMap(0,0,0);
+    Costmap2D* costmap = layers.getCostmap();
+
+    for (unsigned int j = 0; j < 30; j++)
+    {
+      for (unsigned int i = 0; i < 40; i++)
+      {
+        double expected = 6.0;
+        for (unsigned int oj = 0; oj < 30; oj++)
+          for (unsigned int oi = 0; oi < 40; oi++)
+            if (costmap->getCost(oi, oj) == LETHAL_OBSTACLE)
+              expected = std::min(expected, hypot(double(i) - oi, double(j) - oj));
+
+        double distance, gradient_x, gradient_y;
+        ASSERT_TRUE(dlayer->getDistance(i + 0.5, j + 0.5, distance, gradient_x, gradient_y));
+        ASSERT_NEAR(expected, distance, 1e-9);
+        if (distance > 0.0 && distance < 6.0) {
+          ASSERT_NEAR(1.0, hypot(gradient_x, gradient_y), 1e-9);
+        }
+      }
+    }
+
+    // The ray to <12, 12> goes through <10, 10>, which clears it
+    olayer->clearStaticObservations(true, true);
+    addObservation(olayer, 12, 12, MAX_Z);
+    addObservation(olayer, 20, 21, MAX_Z);
+    addObservation(olayer, 30, 8, MAX_Z);
+  }
+
+  double distance;
+  ASSERT_FALSE(dlayer->getDistance(-1.0, 5.0, distance));
+  ASSERT_TRUE(dlayer->getDistance(14.5, 12.5, distance));
+  ASSERT_NEAR(2.0, distance, 1e-9);
+}
 
 int main(int argc, char** argv){
   ros::init(argc, argv, "inflation_tests");
@@ -244,6 +244,161 @@ TEST(costmap, testMultipleAdditions){
 
 }
 
+/**
+ * Verify that copies of an observation share its cloud instead of copying the points
+ */
+TEST(costmap, testObservationsShareClouds){
+  tf::TransformListener tf;
+  LayeredCostmap layers("frame", false, false);
+  layers.resizeMap(10, 10, 1, 0, 0);
+  ObstacleLayer* olayer = addObstacleLayer(layers, tf);
+
+  pcl::PointCloud<pcl::PointXYZ> cloud;
+  cloud.points.resize(2);
+  cloud.points[0].x = 3.0;
+  cloud.points[1].x = 4.0;
+  geometry_msgs::Point p;
+  p.z = MAX_Z;
+
+  Observation obs(p, cloud, 100.0, 100.0);
+  Observation copy(obs);
+  std::vector<Observation> observations(3, obs);
+  ASSERT_EQ(obs.cloud_.get(), copy.cloud_.get());
+  ASSERT_EQ(obs.cloud_.get(), observations[2].cloud_.get());
+  ASSERT_EQ(obs.cloudBytes(), 2 * sizeof(pcl::PointXYZ));
+
+  olayer->addStaticObservation(obs, true, true);
+  layers.updateMap(0,0,0);
+  ASSERT_EQ(countValues(*(layers.getCostmap()), costmap_2d::LETHAL_OBSTACLE), 2);
+  ASSERT_EQ(olayer->getBytesCopied(), 0u);
+}
+
+/**
+ * Verify that snapshots keep the costmap as of their update while later updates go on
+ */
+TEST(costmap, testSnapshots){
+  tf::TransformListener tf;
+  LayeredCostmap layers("frame", false, false);
+  addStaticLayer(layers, tf);
+  ObstacleLayer* olayer = addObstacleLayer(layers, tf);
+  layers.updateMap(0,0,0);
+
+  unsigned int version1, version2, version3;
+  boost::shared_ptr<const Costmap2D> snapshot1 = layers.getSnapshot(&version1);
+
+  addObservation(olayer, 5.0, 0.0);
+  layers.updateMap(0,0,0);
+  boost::shared_ptr<const Costmap2D> snapshot2 = layers.getSnapshot(&version2);
+
+  addObservation(olayer, 0.0, 5.0);
+  layers.updateMap(0,0,0);
+  boost::shared_ptr<const Costmap2D> snapshot3 = layers.getSnapshot(&version3);
+
+  ASSERT_LT(version1, version2);
+  ASSERT_LT(version2, version3);
+
+  Costmap2D copy1(*snapshot1), copy2(*snapshot2), copy3(*snapshot3);
+  ASSERT_EQ(countValues(copy1, costmap_2d::LETHAL_OBSTACLE), 20);
+  ASSERT_EQ(countValues(copy2, costmap_2d::LETHAL_OBSTACLE), 21);
+  ASSERT_EQ(countValues(copy3, costmap_2d::LETHAL_OBSTACLE), 22);
+
+  Costmap2D* costmap = layers.getCostmap();
+  for (unsigned int j = 0; j < costmap->getSizeInCellsY(); j++)
+    for (unsigned int i = 0; i < costmap->getSizeInCellsX(); i++)
+      ASSERT_EQ(costmap->getCost(i, j), snapshot3->getCost(i, j));
+}
+
+/**
+ * Verify that snapshots follow a rolling window that moves away and back
+ */
+TEST(costmap, testSnapshotsRollingWindow){
+  tf::TransformListener tf;
+  LayeredCostmap layers("frame", true, false);
+  layers.resizeMap(20, 20, 1, 0, 0);
+  ObstacleLayer* olayer = addObstacleLayer(layers, tf);
+
+  // Every row is an update: the robot, which puts the origin 9.75 below it, and an obstacle seen from there.
+  // The obstacle at <1.5, 1.5> leaves view with the first move and is gone when the window comes back.
+  double steps[][4] = {{9.75, 9.75, 1.5, 1.5}, {9.75, 9.75, 3.5, 17.5}, {13.75, 11.75, 20.5, 20.5},
+                       {9.75, 9.75, 15.5, 15.5}, {9.75, 9.75, 8.5, 2.5}, {6.75, 8.75, 0.5, 10.5},
+                       {9.75, 9.75, 12.5, 12.5}};
+  Costmap2D* costmap = layers.getCostmap();
+  for (unsigned int k = 0; k < sizeof(steps) / sizeof(steps[0]); k++)
+  {
+    olayer->clearStaticObservations(true, true);
+    addObservation(olayer, steps[k][2], steps[k][3], MAX_Z, steps[k][0], steps[k][1]);
+    layers.updateMap(steps[k][0], steps[k][1], 0);
+
+    boost::shared_ptr<const Costmap2D> snapshot = layers.getSnapshot();
+    ASSERT_EQ(costmap->getOriginX(), snapshot->getOriginX());
+    ASSERT_EQ(costmap->getOriginY(), snapshot->getOriginY());
+    for (unsigned int j = 0; j < costmap->getSizeInCellsY(); j++)
+      for (unsigned int i = 0; i < costmap->getSizeInCellsX(); i++)
+        ASSERT_EQ(costmap->getCost(i, j), snapshot->getCost(i, j)) << "update " << k << " at " << i << ", " << j;
+  }
+  ASSERT_EQ(costmap->getOriginX(), 0.0);
+}
+
+/**
+ * The profiler keeps the last updates, with the window each layer left behind
+ */
+TEST(costmap, testProfiling){
+  tf::TransformListener tf;
+  LayeredCostmap layers("frame", false, false);
+  addStaticLayer(layers, tf);
+  ObstacleLayer* olayer = addObstacleLayer(layers, tf);
+  layers.setProfiling(3);
+  ASSERT_TRUE(layers.getProfiler() != NULL);
+
+  for (int i = 0; i < 5; i++)
+  {
+    addObservation(olayer, 5.0, 0.0);
+    layers.updateMap(0,0,0);
+  }
+
+  std::vector<UpdateProfiler::Cycle> cycles;
+  ASSERT_EQ(5u, layers.getProfiler()->getCycles(cycles));
+  ASSERT_EQ(3u, cycles.size());
+  for (unsigned int i = 0; i < cycles.size(); i++)
+  {
+    ASSERT_EQ(2u, cycles[i].layers.size());
+    ASSERT_GE(cycles[i].update_time, cycles[i].layers[1].costs_time);
+    ASSERT_LE(cycles[i].layers[0].bounds_cells, cycles[i].layers[1].bounds_cells);
+    ASSERT_EQ((unsigned int)((cycles[i].xn - cycles[i].x0) * (cycles[i].yn - cycles[i].y0)),
+              cycles[i].layers[1].bounds_cells);
+  }
+
+  // only what was recorded since
+  ASSERT_EQ(5u, layers.getProfiler()->getCycles(cycles, 4));
+  ASSERT_EQ(1u, cycles.size());
+}
+
+/**
+ * Moving the origin of a rolling window keeps the costs of the cells still in view,
+ * and resets the cells that come into view
+ */
+TEST(costmap, testUpdateOriginMovesCosts){
+  int shifts[][2] = {{3, 2}, {-4, 1}, {0, -7}, {-9, -9}, {12, 0}, {5, -11}};
+  for (unsigned int k = 0; k < sizeof(shifts) / sizeof(shifts[0]); k++)
+  {
+    Costmap2D costmap(10, 10, 1.0, 0.0, 0.0, costmap_2d::NO_INFORMATION);
+    for (unsigned int j = 0; j < 10; j++)
+      for (unsigned int i = 0; i < 10; i++)
+        costmap.setCost(i, j, j * 10 + i);
+
+    int dx = shifts[k][0], dy = shifts[k][1];
+    costmap.updateOrigin(dx, dy);
+    ASSERT_EQ(costmap.getOriginX(), dx);
+    ASSERT_EQ(costmap.getOriginY(), dy);
+
+    for (int j = 0; j < 10; j++)
+      for (int i = 0; i < 10; i++)
+      {
+        bool kept = i + dx >= 0 && i + dx < 10 && j + dy >= 0 && j + dy < 10;
+        ASSERT_EQ(costmap.getCost(i, j), kept ? (j + dy) * 10 + i + dx : costmap_2d::NO_INFORMATION);
+      }
+  }
+}
 
 int main(int argc, char** argv){
   ros::init(argc, argv, "obstacle_tests");
@@ -0,0 +1,234 @@
+/*
+ * Copyright (c) 2013, Willow Garage, Inc.
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Willow Garage, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * Benchmark comparing ObstacleLayer::raytraceFreespace, which traces one ray per
+ * distinct endpoint cell, against tracing every point of the cloud separately.
+ * The clouds are read from a recorded bag, or generated if no bag is given.
+ *
+ * rosrun costmap_2d raytrace_benchmark _bag:=kinect.bag _topic:=/camera/depth/points
+ */
+
+#include <costmap_2d/obstacle_layer.h>
+#include <costmap_2d/cost_values.h>
+#include <rosbag/bag.h>
+#include <rosbag/view.h>
+#include <pcl_conversions/pcl_conversions.h>
+#include <pcl/conversions.h>
+#include <cmath>
+#include <string>
+#include <vector>
+
+using namespace costmap_2d;
+
+/**
+ * @brief  Gives access to the raytracing of ObstacleLayer without initializing it as a plugin
+ */
+class RaytraceLayer : public ObstacleLayer
+{
+public:
+  RaytraceLayer(double size, double resolution)
+  {
+    resizeMap((unsigned int)(size / resolution), (unsigned int)(size / resolution), resolution, -size / 2, -size / 2);
+  }
+
+  void clear()
+  {
+    memset(costmap_, LETHAL_OBSTACLE, size_x_ * size_y_ * sizeof(unsigned char));
+  }
+
+  void traceBatched(const Observation& obs)
+  {
+    double min_x = 1e30, min_y = 1e30, max_x = -1e30, max_y = -1e30;
+    raytraceFreespace(obs, &min_x, &min_y, &max_x, &max_y);
+  }
+
+  /**
+   * @brief  Trace every point of the observation on its own, the way raytraceFreespace used to
+   */
+  void traceEachRay(const Observation& obs)
+  {
+    unsigned int x0, y0;
+    if (!worldToMap(obs.origin_.x, obs.origin_.y, x0, y0))
+      return;
+
+    double map_end_x = origin_x_ + size_x_ * resolution_;
+    double map_end_y = origin_y_ + size_y_ * resolution_;
+    unsigned int cell_raytrace_range = cellDistance(obs.raytrace_range_);
+    const pcl::PointCloud<pcl::PointXYZ>& cloud = *(obs.cloud_);
+    for (unsigned int i = 0; i < cloud.points.size(); ++i)
+    {
+      double ox = obs.origin_.x, oy = obs.origin_.y;
+      double wx = cloud.points[i].x, wy = cloud.points[i].y;
+      double a = wx - ox, b = wy - oy;
+      if (wx < origin_x_)
+      {
+        double t = (origin_x_ - ox) / a;
+        wx = origin_x_;
+        wy = oy + b * t;
+      }
+      if (wy < origin_y_)
+      {
+        double t = (origin_y_ - oy) / b;
+        wx = ox + a * t;
+        wy = origin_y_;
+      }
+      if (wx > map_end_x)
+      {
+        double t = (map_end_x - ox) / a;
+        wx = map_end_x - .001;
+        wy = oy + b * t;
+      }
+      if (wy > map_end_y)
+      {
+        double t = (map_end_y - oy) / b;
+        wx = ox + a * t;
+        wy = map_end_y - .001;
+      }
+
+      unsigned int x1, y1;
+      if (!worldToMap(wx, wy, x1, y1))
+        continue;
+
+      MarkCell marker(costmap_, FREE_SPACE);
+      raytraceLine(marker, x0, y0, x1, y1, cell_raytrace_range);
+    }
+  }
+};
+
+/**
+ * @brief  A depth camera like cloud: a 58 x 45 degree frustum of points at random depths up to max_range
+ */
+pcl::PointCloud<pcl::PointXYZ> makeCloud(unsigned int width, unsigned int height, double max_range)
+{
+  pcl::PointCloud<pcl::PointXYZ> cloud;
+  cloud.points.resize(width * height);
+  for (unsigned int v = 0; v < height; ++v)
+  {
+    for (unsigned int u = 0; u < width; ++u)
+    {
+      double yaw = (u / double(width) - 0.5) * 1.01;
+      double pitch = (v / double(height) - 0.5) * 0.79;
+      double range = max_range * (0.2 + 0.8 * (rand() / double(RAND_MAX)));
+      pcl::PointXYZ& p = cloud.points[v * width + u];
+      p.x = range * cos(pitch) * cos(yaw);
+      p.y = range * cos(pitch) * sin(yaw);
+      p.z = range * sin(pitch);
+    }
+  }
+  return cloud;
+}
+
+int main(int argc, char** argv)
+{
+  ros::init(argc, argv, "raytrace_benchmark");
+  ros::NodeHandle private_nh("~");
+
+  std::string bag_file, topic;
+  int iterations;
+  double size, resolution, raytrace_range;
+  private_nh.param("bag", bag_file, std::string(""));
+  private_nh.param("topic", topic, std::string("/camera/depth/points"));
+  private_nh.param("iterations", iterations, 10);
+  private_nh.param("size", size, 20.0);
+  private_nh.param("resolution", resolution, 0.05);
+  private_nh.param("raytrace_range", raytrace_range, 3.0);
+
+  // the clouds are used as recorded, in the sensor frame with the sensor at the center of the map
+  std::vector<Observation> observations;
+  geometry_msgs::Point origin;
+  if (bag_file.empty())
+  {
+    ROS_INFO("No ~bag given, generating 640 x 480 clouds");
+    for (int i = 0; i < 10; ++i)
+      observations.push_back(Observation(origin, makeCloud(640, 480, 2 * raytrace_range), raytrace_range,
+                                         raytrace_range));
+  }
+  else
+  {
+    rosbag::Bag bag(bag_file);
+    rosbag::View view(bag, rosbag::TopicQuery(topic));
+    for (rosbag::View::iterator it = view.begin(); it != view.end(); ++it)
+    {
+      sensor_msgs::PointCloud2ConstPtr message = it->instantiate<sensor_msgs::PointCloud2>();
+      if (!message)
+        continue;
+      pcl::PCLPointCloud2 pcl_pc2;
+      pcl_conversions::toPCL(*message, pcl_pc2);
+      pcl::PointCloud<pcl::PointXYZ> cloud;
+      pcl::fromPCLPointCloud2(pcl_pc2, cloud);
+      observations.push_back(Observation(origin, cloud, raytrace_range, raytrace_range));
+    }
+    ROS_INFO("Read %lu clouds from %s on %s", observations.size(), bag_file.c_str(), topic.c_str());
+  }
+
+  if (observations.empty())
+    return 1;
+
+  size_t rays = 0;
+  for (unsigned int i = 0; i < observations.size(); ++i)
+    rays += observations[i].cloud_->points.size();
+  rays *= iterations;
+
+  RaytraceLayer each_ray(size, resolution), batched(size, resolution);
+
+  ros::WallDuration each_ray_time, batched_time;
+  unsigned int differences = 0;
+  for (int it = 0; it < iterations; ++it)
+  {
+    for (unsigned int i = 0; i < observations.size(); ++i)
+    {
+      each_ray.clear();
+      batched.clear();
+
+      ros::WallTime start = ros::WallTime::now();
+      each_ray.traceEachRay(observations[i]);
+      each_ray_time += ros::WallTime::now() - start;
+
+      start = ros::WallTime::now();
+      batched.traceBatched(observations[i]);
+      batched_time += ros::WallTime::now() - start;
+
+      for (unsigned int j = 0; j < each_ray.getSizeInCellsX() * each_ray.getSizeInCellsY(); ++j)
+      {
+        if (each_ray.getCharMap()[j] != batched.getCharMap()[j])
+          ++differences;
+      }
+    }
+  }
+
+  ROS_INFO("Raytracing %lu rays into a %.1f m map at %.3f m/cell, %.1f m range", rays, size, resolution,
+           raytrace_range);
+  ROS_INFO("  every ray:        %9.3f Mrays/s", rays / each_ray_time.toSec() * 1e-6);
+  ROS_INFO("  one ray per cell: %9.3f Mrays/s (%.2fx)", rays / batched_time.toSec() * 1e-6,
+           each_ray_time.toSec() / batched_time.toSec());
+  ROS_INFO("  %u cells differ", differences);
+
+  return differences == 0 ? 0 : 1;
+}
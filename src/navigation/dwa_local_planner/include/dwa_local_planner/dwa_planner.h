@@ -51,6 +51,7 @@
 #include <costmap_2d/costmap_2d.h>
 
 #include <base_local_planner/trajectory.h>
+#include <base_local_planner/trajectory_batch.h>
 #include <base_local_planner/local_planner_limits.h>
 #include <base_local_planner/local_planner_util.h>
 #include <base_local_planner/simple_trajectory_generator.h>
@@ -162,6 +163,7 @@ namespace dwa_local_planner {
       pcl_ros::Publisher<base_local_planner::MapGridCostPoint> traj_cloud_pub_;
       bool publish_cost_grid_pc_; ///< @brief Whether or not to build and publish a PointCloud
       bool publish_traj_pc_;
+      base_local_planner::TrajectoryBatch explored_; ///< @brief The trajectories of the last cycle, kept only when they are published
 
       double cheat_factor_;
 
@@ -82,6 +82,7 @@ namespace dwa_local_planner {
  
     // obstacle costs can vary due to scaling footprint feature
     obstacle_costs_.setParams(config.max_trans_vel, config.max_scaling_factor, config.scaling_speed);
+    obstacle_costs_.setFootprintHeadings(config.footprint_headings);
 
     int vx_samp, vy_samp, vth_samp;
     vx_samp = config.vx_samples;
@@ -109,6 +110,8 @@ namespace dwa_local_planner {
     vsamples_[0] = vx_samp;
     vsamples_[1] = vy_samp;
     vsamples_[2] = vth_samp;
+
+    scored_sampling_planner_.setNumThreads(config.scoring_threads);
  
 
   }
@@ -315,8 +318,15 @@ namespace dwa_local_planner {
 
     result_traj_.cost_ = -7;
     // find best trajectory by sampling and scoring the samples
-    std::vector<base_local_planner::Trajectory> all_explored;
-    scored_sampling_planner_.findBestTrajectory(result_traj_, &all_explored);
+    // only copy the explored trajectories when they are published
+    if(publish_traj_pc_)
+    {
+      scored_sampling_planner_.findBestTrajectory(result_traj_, explored_);
+    }
+    else
+    {
+      scored_sampling_planner_.findBestTrajectory(result_traj_, NULL);
+    }
 
     if(publish_traj_pc_)
     {
@@ -328,19 +338,21 @@ namespace dwa_local_planner {
         pcl_conversions::fromPCL(traj_cloud_->header, header);
         header.stamp = ros::Time::now();
         traj_cloud_->header = pcl_conversions::toPCL(header);
-        for(std::vector<base_local_planner::Trajectory>::iterator t=all_explored.begin(); t != all_explored.end(); ++t)
+        for(unsigned int t = 0; t < explored_.size(); ++t)
         {
-            if(t->cost_<0)
+            double cost = explored_.getCost(t);
+            if(cost<0)
                 continue;
             // Fill out the plan
-            for(unsigned int i = 0; i < t->getPointsSize(); ++i) {
-                double p_x, p_y, p_th;
-                t->getPoint(i, p_x, p_y, p_th);
-                pt.x=p_x;
-                pt.y=p_y;
+            const double* p_x = explored_.getXPoints(t);
+            const double* p_y = explored_.getYPoints(t);
+            const double* p_th = explored_.getThPoints(t);
+            for(unsigned int i = 0; i < explored_.getPointsSize(t); ++i) {
+                pt.x=p_x[i];
+                pt.y=p_y[i];
                 pt.z=0;
-                pt.path_cost=p_th;
-                pt.total_cost=t->cost_;
+                pt.path_cost=p_th[i];
+                pt.total_cost=cost;
                 traj_cloud_->push_back(pt);
             }
         }
@@ -65,6 +65,7 @@
 
 // costmap & geometry
 #include <costmap_2d/costmap_2d_ros.h>
+#include <costmap_2d/distance_layer.h>
 
 // boost classes
 #include <boost/shared_ptr.hpp>
@@ -176,6 +177,7 @@ namespace eband_local_planner{
       // data
       std::vector<geometry_msgs::Point> footprint_spec_; // specification of robot footprint as vector of corner points
       costmap_2d::Costmap2D* costmap_; // pointer to underlying costmap
+      boost::shared_ptr<costmap_2d::DistanceLayer> distance_layer_; // distance layer of the costmap, if it has one
       std::vector<geometry_msgs::PoseStamped> global_plan_; // copy of the plan that shall be optimized
       std::vector<Bubble> elastic_band_;
 
@@ -75,6 +75,16 @@ namespace eband_local_planner{
       // get footprint of the robot
       footprint_spec_ = costmap_ros_->getRobotFootprint();
 
+      // take distances from a distance layer if the costmap has one, rather than from the inflated costs
+      distance_layer_.reset();
+      std::vector<boost::shared_ptr<costmap_2d::Layer> >* plugins = costmap_ros_->getLayeredCostmap()->getPlugins();
+      for(std::vector<boost::shared_ptr<costmap_2d::Layer> >::iterator plugin = plugins->begin(); plugin != plugins->end(); ++plugin)
+      {
+        distance_layer_ = boost::dynamic_pointer_cast<costmap_2d::DistanceLayer>(*plugin);
+        if(distance_layer_)
+          break;
+      }
+
 
       // create Node Handle with name of plugin (as used in move_base for loading)
       ros::NodeHandle pn("~/" + name);
@@ -1458,6 +1468,28 @@ namespace eband_local_planner{
     geometry_msgs::Pose2D edge_pose2D;
     geometry_msgs::Wrench wrench;
 
+    // the distance layer gives the gradient of the distance directly, instead of the difference-quotients below
+    double distance, gradient_x, gradient_y;
+    if(distance_layer_ && distance_layer_->getDistance(curr_bubble.center.pose.position.x,
+          curr_bubble.center.pose.position.y, distance, gradient_x, gradient_y))
+    {
+      // the bubble is no bigger where it is inside the inscribed radius or out of range of all obstacles
+      if(distance <= costmap_ros_->getLayeredCostmap()->getInscribedRadius())
+      {
+        gradient_x = 0.0;
+        gradient_y = 0.0;
+      }
+      wrench.force.x = external_force_gain_*gradient_x;
+      wrench.force.y = external_force_gain_*gradient_y;
+      wrench.force.z = 0.0;
+      wrench.torque.x = 0.0;
+      wrench.torque.y = 0.0;
+      // the distance does not depend on the orientation of the bubble
+      wrench.torque.z = 0.0;
+      forces.wrench = wrench;
+      return true;
+    }
+
 
     // calculate delta-poses (on upper edge of bubble) for x-direction
     edge = curr_bubble.center.pose;
@@ -1795,6 +1827,13 @@ namespace eband_local_planner{
       return false;
     }
 
+    // exact distance to nearest obstacle, less the inscribed radius so that it matches the estimate from the costs below
+    if(distance_layer_ && distance_layer_->getDistance(center_pose.position.x, center_pose.position.y, distance))
+    {
+      distance = std::max(0.0, distance - costmap_ros_->getLayeredCostmap()->getInscribedRadius());
+      return true;
+    }
+
     unsigned int cell_x, cell_y;
     unsigned char disc_cost;
     double weight = costmap_weight_;
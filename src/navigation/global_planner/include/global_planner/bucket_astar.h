@@ -0,0 +1,72 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+#ifndef _BUCKET_ASTAR_H
+#define _BUCKET_ASTAR_H
+
+#include <global_planner/planner_core.h>
+#include <global_planner/expander.h>
+#include <vector>
+
+namespace global_planner {
+
+/**
+ * @class BucketAStarExpansion
+ * @brief A* like AStarExpansion, with a ring of buckets of unit width as the priority queue.
+ *
+ * Cells are expanded in order of the integer part of their key. One step adds at most the 8 bit
+ * cost and the neutral cost to the potential, and the neutral cost to the heuristic, so no cell is
+ * ever queued more than 3 * 255 = 765 above the bucket being expanded, and a ring of BUCKETS
+ * buckets holds the whole queue.
+ */
+class BucketAStarExpansion : public Expander {
+    public:
+        BucketAStarExpansion(PotentialCalculator* p_calc, int nx, int ny);
+        bool calculatePotentials(unsigned char* costs, double start_x, double start_y, double end_x, double end_y,
+                                int cycles, float* potential);
+    private:
+        static const int BUCKETS = 1024;
+
+        void add(unsigned char* costs, float* potential, float prev_potential, int next_i, float heuristic);
+        void push(int i, float key);
+        int pop();
+
+        std::vector<std::vector<int> > buckets_;
+        int current_; /**< key of the bucket being expanded */
+        int queued_;
+        std::vector<float> heuristic_x_, heuristic_y_; /**< heuristic of each column and row, offset by one */
+};
+
+} //end namespace global_planner
+#endif
@@ -60,6 +60,15 @@ class DijkstraExpansion : public Expander {
         bool calculatePotentials(unsigned char* costs, double start_x, double start_y, double end_x, double end_y, int cycles,
                                 float* potential);
 
+        /**
+         * @brief  Expands from the start until the potential of every one of the goals is known, or
+         *         every reachable cell has been expanded
+         * @param goals Indices of the goal cells
+         * @return True if all the goals were reached
+         */
+        bool calculatePotentials(unsigned char* costs, double start_x, double start_y, const std::vector<int>& goals,
+                                 int cycles, float* potential);
+
         /**
          * @brief  Sets or resets the size of the map
          * @param nx The x size of the map
@@ -74,6 +83,8 @@ class DijkstraExpansion : public Expander {
 
         void setPreciseStart(bool precise){ precise_ = precise; }
     private:
+        bool propagate(unsigned char* costs, double start_x, double start_y, const int* goals, int num_goals,
+                       int cycles, float* potential);
 
         /**
          * @brief  Updates the cell at index n
@@ -83,6 +94,8 @@ class DijkstraExpansion : public Expander {
          */
         void updateCell(unsigned char* costs, float* potential, int n); /** updates the cell at index n */
 
+        void clearPending(); /** clears the pending_ flags of the cells left in the priority buffers */
+
         float getCost(unsigned char* costs, int n) {
             float c = costs[n];
             if (c < lethal_cost_ - 1 || (unknown_ && c==255)) {
@@ -0,0 +1,96 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+#ifndef _DSTAR_LITE_H
+#define _DSTAR_LITE_H
+
+#include <global_planner/planner_core.h>
+#include <global_planner/expander.h>
+#include <global_planner/astar.h>
+#include <vector>
+
+namespace global_planner {
+
+/**
+ * @class DStarLiteExpansion
+ * @brief Incremental expansion that repairs the potentials of the last call instead of starting over.
+ *
+ * The potential is the cost to the goal, so the robot can move between calls without invalidating
+ * it (D* Lite). Cells whose cost changed since the last call are found against a copy of the
+ * costmap, and the search state is repaired from them (LPA*, with no heuristic, so the potentials
+ * match a Dijkstra expansion from the goal). A new goal, map size or cost setting, or a different
+ * potential array, starts a new search.
+ */
+class DStarLiteExpansion : public Expander {
+    public:
+        DStarLiteExpansion(PotentialCalculator* p_calc, int nx, int ny);
+        bool calculatePotentials(unsigned char* costs, double start_x, double start_y, double end_x, double end_y,
+                                int cycles, float* potential);
+        bool expandsFromGoal() {
+            return true;
+        }
+
+    private:
+        void reset(unsigned char* costs, float* potential, int goal_i);
+        void updateCell(unsigned char* costs, float* potential, int n);
+        bool computePotentials(unsigned char* costs, float* potential, int start_i, int cycles);
+        void compactQueue(float* potential);
+
+        float getCost(unsigned char* costs, int n) {
+            float c = costs[n];
+            if (c < lethal_cost_ - 1 || (unknown_ && c==255)) {
+                c = c * factor_ + neutral_cost_;
+                if (c >= lethal_cost_)
+                    c = lethal_cost_ - 1;
+                return c;
+            }
+            return lethal_cost_;
+        }
+
+        inline bool isQueued(float* potential, const Index& entry) {
+            return potential[entry.i] != rhs_[entry.i] && std::min(potential[entry.i], rhs_[entry.i]) == entry.cost;
+        }
+
+        int goal_i_;
+        unsigned char last_lethal_cost_, last_neutral_cost_;
+        float last_factor_;
+        bool last_unknown_;
+        std::vector<unsigned char> costs_; /**< the costs the potentials are consistent with */
+        std::vector<float> rhs_; /**< one step lookahead potentials */
+        std::vector<Index> queue_; /**< inconsistent cells, may hold stale entries */
+        size_t compact_size_;
+};
+
+} //end namespace global_planner
+#endif
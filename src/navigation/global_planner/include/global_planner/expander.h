@@ -39,13 +39,16 @@
 #define _EXPANDER_H
 #include <global_planner/potential_calculator.h>
 #include <global_planner/planner_core.h>
+#include <algorithm>
+#include <vector>
 
 namespace global_planner {
 
 class Expander {
     public:
         Expander(PotentialCalculator* p_calc, int nx, int ny) :
-                unknown_(true), lethal_cost_(253), neutral_cost_(50), factor_(3.0), p_calc_(p_calc) {
+                nx_(0), ny_(0), ns_(0), unknown_(true), lethal_cost_(253), neutral_cost_(50), cells_visited_(0), factor_(3.0),
+                p_calc_(p_calc), last_potential_(NULL), workspace_growth_(0) {
             setSize(nx, ny);
         }
         virtual bool calculatePotentials(unsigned char* costs, double start_x, double start_y, double end_x, double end_y,
@@ -57,6 +60,8 @@ class Expander {
          * @param ny The y size of the map
          */
         virtual void setSize(int nx, int ny) {
+            if (nx != nx_ || ny != ny_)
+                last_potential_ = NULL;
             nx_ = nx;
             ny_ = ny;
             ns_ = nx * ny;
@@ -74,6 +79,14 @@ class Expander {
             unknown_ = unknown;
         }
 
+        /**
+         * @brief  Whether the potential is the cost to the goal rather than from the start, in
+         *         which case paths are traced from the start down to the goal
+         */
+        virtual bool expandsFromGoal() {
+            return false;
+        }
+
         void clearEndpoint(unsigned char* costs, float* potential, int gx, int gy, int s){
             int startCell = toIndex(gx, gy);
             for(int i=-s;i<=s;i++){
@@ -83,16 +96,57 @@ class Expander {
                     continue;
                 float c = costs[n]+neutral_cost_;
                 float pot = p_calc_->calculatePotential(potential, c, n);
-                potential[n] = pot;
+                setPotential(potential, n, pot);
             }
             }
         }
 
+        /**
+         * @brief  Number of times the expander had to grow its buffers, which stays constant
+         *         once they fit the expansions asked of it
+         */
+        unsigned int getWorkspaceGrowth() {
+            return workspace_growth_;
+        }
+
+        /** @brief  Number of cells expanded by the last calculatePotentials() */
+        int getCellsVisited() {
+            return cells_visited_;
+        }
+
     protected:
         inline int toIndex(int x, int y) {
             return x + nx_ * y;
         }
 
+        /**
+         * @brief  Reset the potential array to POT_HIGH. If it is the array of the last
+         *         expansion, only the cells that expansion set are reset.
+         */
+        void clearPotentials(float* potential) {
+            if (potential == last_potential_) {
+                for (unsigned int i = 0; i < touched_.size(); i++)
+                    potential[touched_[i]] = POT_HIGH;
+            } else
+                std::fill(potential, potential + ns_, POT_HIGH);
+            touched_.clear();
+            last_potential_ = potential;
+        }
+
+        /** @brief  Set the potential of a cell, remembering it for clearPotentials() */
+        inline void setPotential(float* potential, int n, float value) {
+            if (potential[n] >= POT_HIGH)
+                pushBack(touched_, n);
+            potential[n] = value;
+        }
+
+        template<typename T, typename V>
+        inline void pushBack(std::vector<T>& v, const V& value) {
+            if (v.size() == v.capacity())
+                workspace_growth_++;
+            v.push_back(value);
+        }
+
         int nx_, ny_, ns_; /**< size of grid, in pixels */
         bool unknown_;
         unsigned char lethal_cost_, neutral_cost_;
@@ -100,6 +154,10 @@ class Expander {
         float factor_;
         PotentialCalculator* p_calc_;
 
+        float* last_potential_;
+        std::vector<int> touched_; /**< cells of last_potential_ set since it was cleared */
+        unsigned int workspace_growth_;
+
 };
 
 } //end namespace global_planner
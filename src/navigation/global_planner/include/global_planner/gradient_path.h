@@ -69,6 +69,7 @@ class GradientPath : public Traceback {
         float gradCell(float* potential, int n);
 
         float *gradx_, *grady_; /**< gradient arrays, size of potential array */
+        std::vector<int> gradients_; /**< cells with a gradient set since the arrays were cleared */
 
         float pathStep_; /**< step size for following gradient */
 };
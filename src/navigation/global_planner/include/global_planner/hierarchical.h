@@ -0,0 +1,120 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+#ifndef _HIERARCHICAL_H
+#define _HIERARCHICAL_H
+
+#include <global_planner/planner_core.h>
+#include <global_planner/expander.h>
+#include <global_planner/astar.h>
+#include <costmap_2d/cost_values.h>
+#include <cstdlib>
+#include <vector>
+
+namespace global_planner {
+
+/**
+ * @class HierarchicalExpansion
+ * @brief A* on an abstraction of the costmap (HPA*), refined at full resolution.
+ *
+ * The map is split into square clusters. Each stretch of free cells along the border of two
+ * clusters is an entrance with one or two portals, and the costs of the paths between the
+ * portals of a cluster are cached. A plan first searches this graph of portals, then runs A*
+ * over only the clusters the abstract path passes through. The cache is rebuilt for the
+ * clusters whose costs changed since the last plan.
+ */
+class HierarchicalExpansion : public Expander {
+    public:
+        HierarchicalExpansion(PotentialCalculator* p_calc, int nx, int ny, int cluster_size);
+        bool calculatePotentials(unsigned char* costs, double start_x, double start_y, double end_x, double end_y,
+                                int cycles, float* potential);
+        void setSize(int nx, int ny);
+
+    private:
+        struct Cluster {
+            std::vector<int> portals; /**< portal cells, along the east, west, north then south border */
+            int west, north, south; /**< index of the first portal on each border after the east one */
+            std::vector<float> distances; /**< costs of the paths between portals, POT_HIGH if there is none */
+            int first_node;
+        };
+
+        void layoutClusters();
+        void updateAbstraction(unsigned char* costs);
+        void findEntrances(unsigned char* costs, int cell, int step, int across, int length,
+                           std::vector<int>& entrances);
+        void buildCluster(unsigned char* costs, int c);
+        void linkClusters();
+        void searchCluster(unsigned char* costs, int c, int source, const std::vector<int>& targets, float* distances);
+        bool searchAbstraction(unsigned char* costs, int start_i, int goal_i);
+        bool refine(unsigned char* costs, float* potential, int start_i, int goal_i, int cycles);
+        void add(unsigned char* costs, float* potential, float prev_potential, int next_i, int end_x, int end_y);
+
+        inline bool isTraversable(unsigned char cost) {
+            return cost < lethal_cost_ || (unknown_ && cost == costmap_2d::NO_INFORMATION);
+        }
+        inline int clusterOf(int i) {
+            return (i % nx_) / cluster_size_ + (i / nx_) / cluster_size_ * cx_;
+        }
+        inline float heuristic(int i, int goal_i) {
+            return (abs(i % nx_ - goal_i % nx_) + abs(i / nx_ - goal_i / nx_)) * neutral_cost_;
+        }
+
+        int cluster_size_, cx_, cy_;
+        bool valid_;
+        unsigned char last_lethal_cost_, last_neutral_cost_;
+        bool last_unknown_;
+        std::vector<unsigned char> costs_;
+        std::vector<Cluster> clusters_;
+        std::vector<char> dirty_;
+
+        // entrances across the border east of and north of each cluster, as pairs of cells
+        std::vector<std::vector<int> > east_entrances_, north_entrances_;
+
+        // the portals of all clusters as nodes of the abstract graph
+        std::vector<int> node_cells_, node_clusters_, node_links_;
+
+        // scratch space for the searches
+        std::vector<char> local_targets_;
+        std::vector<float> local_, start_distances_, goal_distances_, node_costs_;
+        std::vector<int> node_parents_;
+        std::vector<char> closed_;
+        std::vector<char> corridor_;
+        std::vector<int> corridor_clusters_;
+        std::vector<Index> queue_;
+        std::vector<int> targets_;
+        std::vector<std::pair<int, float> > edges_;
+};
+
+} //end namespace global_planner
+#endif
@@ -40,6 +40,7 @@
 #define POT_HIGH 1.0e10        // unassigned cell potential
 #include <ros/ros.h>
 #include <costmap_2d/costmap_2d.h>
+#include <costmap_2d/costmap_2d_ros.h>
 #include <geometry_msgs/PoseStamped.h>
 #include <geometry_msgs/Point.h>
 #include <nav_msgs/Path.h>
@@ -53,10 +54,12 @@
 #include <global_planner/traceback.h>
 #include <global_planner/orientation_filter.h>
 #include <global_planner/GlobalPlannerConfig.h>
+#include <global_planner/MakePlans.h>
 
 namespace global_planner {
 
 class Expander;
+class DijkstraExpansion;
 class GridPath;
 
 /**
@@ -114,6 +117,19 @@ class GlobalPlanner : public nav_core::BaseGlobalPlanner {
         bool makePlan(const geometry_msgs::PoseStamped& start, const geometry_msgs::PoseStamped& goal, double tolerance,
                       std::vector<geometry_msgs::PoseStamped>& plan);
 
+        /**
+         * @brief Given several goal poses in the world, compute the cost of reaching each of them, and
+         *        optionally a plan to each, from a single expansion of the potential from the start
+         * @param start The start pose
+         * @param goals The goal poses
+         * @param costs Filled with the potential at each goal, or -1.0 if it can't be reached
+         * @param plans If not NULL, filled with a plan to each goal, empty if it can't be reached
+         * @return True if at least one of the goals can be reached, false otherwise
+         */
+        bool makePlans(const geometry_msgs::PoseStamped& start, const std::vector<geometry_msgs::PoseStamped>& goals,
+                       std::vector<double>& costs,
+                       std::vector<std::vector<geometry_msgs::PoseStamped> >* plans = NULL);
+
         /**
          * @brief  Computes the full navigation function for the map given a point in the world to start from
          * @param world_point The point to use for seeding the navigation function
@@ -164,6 +180,16 @@ class GlobalPlanner : public nav_core::BaseGlobalPlanner {
 
         bool makePlanService(nav_msgs::GetPlan::Request& req, nav_msgs::GetPlan::Response& resp);
 
+        bool makePlansService(MakePlans::Request& req, MakePlans::Response& resp);
+
+        /**
+         * @brief  The number of times the planner grew its workspace (costmap copy, potential array,
+         *         queues and path buffers). Replanning on a costmap of the same size stops growing it
+         *         once the buffers fit the longest plan. This is not a count of all allocations: the
+         *         plans returned and the orientation filter still allocate on every plan.
+         */
+        unsigned int getWorkspaceGrowth();
+
     protected:
 
         /**
@@ -178,12 +204,16 @@ class GlobalPlanner : public nav_core::BaseGlobalPlanner {
         void mapToWorld(double mx, double my, double& wx, double& wy);
         bool worldToMap(double wx, double wy, double& mx, double& my);
         void clearRobotCell(const tf::Stamped<tf::Pose>& global_pose, unsigned int mx, unsigned int my);
+        void copyCostmapSnapshot();
         void publishPotential(float* potential);
+        bool getPlanFromPotential(float* potential, bool from_goal, double start_x, double start_y, double end_x,
+                                  double end_y, const geometry_msgs::PoseStamped& goal,
+                                  std::vector<geometry_msgs::PoseStamped>& plan);
 
         double planner_window_x_, planner_window_y_, default_tolerance_;
         std::string tf_prefix_;
         boost::mutex mutex_;
-        ros::ServiceServer make_plan_srv_;
+        ros::ServiceServer make_plan_srv_, make_plans_srv_;
 
         PotentialCalculator* p_calc_;
         Expander* planner_;
@@ -197,6 +227,16 @@ class GlobalPlanner : public nav_core::BaseGlobalPlanner {
         void outlineMap(unsigned char* costarr, int nx, int ny, unsigned char value);
         unsigned char* cost_array_;
         float* potential_array_;
+        int potential_size_;
+        std::vector<std::pair<float, float> > path_;
+
+        DijkstraExpansion* batch_planner_; /**< expands from the start for makePlans() */
+        std::vector<float> batch_potential_; /**< kept apart from potential_array_, which planner_ may reuse */
+        std::vector<int> batch_goals_;
+        unsigned int workspace_growth_;
+
+        costmap_2d::Costmap2DROS* costmap_ros_; /**< plans are made on snapshots of its costmap, if set */
+        costmap_2d::Costmap2D snapshot_copy_; /**< the latest snapshot, which the planner writes to */
         unsigned int start_x_, start_y_, end_x_, end_y_;
 
         bool old_navfn_behavior_;
@@ -44,7 +44,7 @@ namespace global_planner {
 
 class Traceback {
     public:
-        Traceback(PotentialCalculator* p_calc) : p_calc_(p_calc) {}
+        Traceback(PotentialCalculator* p_calc) : p_calc_(p_calc), workspace_growth_(0) {}
 
         virtual bool getPath(float* potential, double start_x, double start_y, double end_x, double end_y, std::vector<std::pair<float, float> >& path) = 0;
         virtual void setSize(int xs, int ys) {
@@ -57,10 +57,15 @@ class Traceback {
         void setLethalCost(unsigned char lethal_cost) {
             lethal_cost_ = lethal_cost;
         }
+        /** @brief Number of times the traceback had to grow its buffers */
+        unsigned int getWorkspaceGrowth() {
+            return workspace_growth_;
+        }
     protected:
         int xs_, ys_;
         unsigned char lethal_cost_;
         PotentialCalculator* p_calc_;
+        unsigned int workspace_growth_;
 };
 
 } //end namespace global_planner
@@ -46,12 +46,13 @@ AStarExpansion::AStarExpansion(PotentialCalculator* p_calc, int xs, int ys) :
 
 bool AStarExpansion::calculatePotentials(unsigned char* costs, double start_x, double start_y, double end_x, double end_y,
                                         int cycles, float* potential) {
+    cells_visited_ = 0;
     queue_.clear();
     int start_i = toIndex(start_x, start_y);
-    queue_.push_back(Index(start_i, 0));
+    pushBack(queue_, Index(start_i, 0));
 
-    std::fill(potential, potential + ns_, POT_HIGH);
-    potential[start_i] = 0;
+    clearPotentials(potential);
+    setPotential(potential, start_i, 0);
 
     int goal_i = toIndex(end_x, end_y);
     int cycle = 0;
@@ -62,6 +63,7 @@ bool AStarExpansion::calculatePotentials(unsigned char* costs, double start_x, d
         queue_.pop_back();
 
         int i = top.i;
+        cells_visited_++;
         if (i == goal_i)
             return true;
 
@@ -82,11 +84,12 @@ void AStarExpansion::add(unsigned char* costs, float* potential, float prev_pote
     if(costs[next_i]>=lethal_cost_ && !(unknown_ && costs[next_i]==costmap_2d::NO_INFORMATION))
         return;
 
-    potential[next_i] = p_calc_->calculatePotential(potential, costs[next_i] + neutral_cost_, next_i, prev_potential);
+    setPotential(potential, next_i,
+                 p_calc_->calculatePotential(potential, costs[next_i] + neutral_cost_, next_i, prev_potential));
     int x = next_i % nx_, y = next_i / nx_;
     float distance = abs(end_x - x) + abs(end_y - y);
 
-    queue_.push_back(Index(next_i, potential[next_i] + distance * neutral_cost_));
+    pushBack(queue_, Index(next_i, potential[next_i] + distance * neutral_cost_));
     std::push_heap(queue_.begin(), queue_.end(), greater1());
 }
 
@@ -0,0 +1,126 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+#include <global_planner/bucket_astar.h>
+#include <costmap_2d/cost_values.h>
+#include <cstdlib>
+
+namespace global_planner {
+
+BucketAStarExpansion::BucketAStarExpansion(PotentialCalculator* p_calc, int nx, int ny) :
+        Expander(p_calc, nx, ny), buckets_(BUCKETS), current_(0), queued_(0) {
+}
+
+bool BucketAStarExpansion::calculatePotentials(unsigned char* costs, double start_x, double start_y, double end_x,
+                                               double end_y, int cycles, float* potential) {
+    // the furthest a step queues a cell ahead of the bucket being expanded, which it is at most
+    // one above, has to stay within the ring
+    ROS_ASSERT(255 + 2 * neutral_cost_ + 1 < BUCKETS);
+
+    cells_visited_ = 0;
+    for (int b = 0; b < BUCKETS; b++)
+        buckets_[b].clear();
+    queued_ = 0;
+
+    // the heuristic of every column and row, so expanding a cell takes one division
+    int goal_x = end_x, goal_y = end_y;
+    if (heuristic_x_.size() != (size_t) nx_ + 2 || heuristic_y_.size() != (size_t) ny_ + 2)
+        workspace_growth_++;
+    heuristic_x_.resize(nx_ + 2);
+    heuristic_y_.resize(ny_ + 2);
+    for (int x = -1; x <= nx_; x++)
+        heuristic_x_[x + 1] = abs(goal_x - x) * neutral_cost_;
+    for (int y = -1; y <= ny_; y++)
+        heuristic_y_[y + 1] = abs(goal_y - y) * neutral_cost_;
+
+    int start_i = toIndex(start_x, start_y);
+    int goal_i = toIndex(end_x, end_y);
+
+    clearPotentials(potential);
+    setPotential(potential, start_i, 0);
+
+    current_ = heuristic_x_[(int) start_x + 1] + heuristic_y_[(int) start_y + 1];
+    push(start_i, current_);
+
+    int cycle = 0;
+
+    while (queued_ > 0 && cycle < cycles) {
+        int i = pop();
+        cells_visited_++;
+
+        if (i == goal_i)
+            return true;
+
+        int x = i % nx_ + 1, y = i / nx_ + 1;
+        float prev_potential = potential[i];
+        add(costs, potential, prev_potential, i + 1, heuristic_x_[x + 1] + heuristic_y_[y]);
+        add(costs, potential, prev_potential, i - 1, heuristic_x_[x - 1] + heuristic_y_[y]);
+        add(costs, potential, prev_potential, i + nx_, heuristic_x_[x] + heuristic_y_[y + 1]);
+        add(costs, potential, prev_potential, i - nx_, heuristic_x_[x] + heuristic_y_[y - 1]);
+    }
+
+    return false;
+}
+
+void BucketAStarExpansion::add(unsigned char* costs, float* potential, float prev_potential, int next_i,
+                               float heuristic) {
+    if (potential[next_i] < POT_HIGH)
+        return;
+
+    if(costs[next_i]>=lethal_cost_ && !(unknown_ && costs[next_i]==costmap_2d::NO_INFORMATION))
+        return;
+
+    setPotential(potential, next_i,
+                 p_calc_->calculatePotential(potential, costs[next_i] + neutral_cost_, next_i, prev_potential));
+    push(next_i, potential[next_i] + heuristic);
+}
+
+void BucketAStarExpansion::push(int i, float key) {
+    // keys below the current bucket, which the quadratic calculator can produce, are expanded next
+    int k = std::max((int) key, current_);
+    pushBack(buckets_[k & (BUCKETS - 1)], i);
+    queued_++;
+}
+
+int BucketAStarExpansion::pop() {
+    while (buckets_[current_ & (BUCKETS - 1)].empty())
+        current_++;
+    std::vector<int>& bucket = buckets_[current_ & (BUCKETS - 1)];
+    int i = bucket.back();
+    bucket.pop_back();
+    queued_--;
+    return i;
+}
+
+} //end namespace global_planner
@@ -45,6 +45,10 @@ DijkstraExpansion::DijkstraExpansion(PotentialCalculator* p_calc, int nx, int ny
     buffer1_ = new int[PRIORITYBUFSIZE];
     buffer2_ = new int[PRIORITYBUFSIZE];
     buffer3_ = new int[PRIORITYBUFSIZE];
+    currentBuffer_ = buffer1_;
+    nextBuffer_ = buffer2_;
+    overBuffer_ = buffer3_;
+    currentEnd_ = nextEnd_ = overEnd_ = 0;
 
     priorityIncrement_ = 2 * neutral_cost_;
 }
@@ -61,12 +65,29 @@ DijkstraExpansion::~DijkstraExpansion() {
 // Set/Reset map size
 //
 void DijkstraExpansion::setSize(int xs, int ys) {
+    if (pending_ && xs == nx_ && ys == ny_)
+        return;
     Expander::setSize(xs, ys);
     if (pending_)
         delete[] pending_;
 
     pending_ = new bool[ns_];
     memset(pending_, 0, ns_ * sizeof(bool));
+    currentEnd_ = nextEnd_ = overEnd_ = 0;
+    workspace_growth_++;
+}
+
+//
+// Clear the pending_ flags left by the last propagation, which are
+//   only ever set on the cells in the priority buffers
+//
+void DijkstraExpansion::clearPending() {
+    for (int i = 0; i < currentEnd_; i++)
+        pending_[currentBuffer_[i]] = false;
+    for (int i = 0; i < nextEnd_; i++)
+        pending_[nextBuffer_[i]] = false;
+    for (int i = 0; i < overEnd_; i++)
+        pending_[overBuffer_[i]] = false;
 }
 
 //
@@ -79,7 +100,21 @@ void DijkstraExpansion::setSize(int xs, int ys) {
 
 bool DijkstraExpansion::calculatePotentials(unsigned char* costs, double start_x, double start_y, double end_x, double end_y,
                                            int cycles, float* potential) {
+    int goal = toIndex(end_x, end_y);
+    return propagate(costs, start_x, start_y, &goal, 1, cycles, potential);
+}
+
+bool DijkstraExpansion::calculatePotentials(unsigned char* costs, double start_x, double start_y,
+                                           const std::vector<int>& goals, int cycles, float* potential) {
+    if (goals.empty())
+        return false;
+    return propagate(costs, start_x, start_y, &goals[0], goals.size(), cycles, potential);
+}
+
+bool DijkstraExpansion::propagate(unsigned char* costs, double start_x, double start_y, const int* goals,
+                                  int num_goals, int cycles, float* potential) {
     cells_visited_ = 0;
+    clearPending();
     // priority buffers
     threshold_ = lethal_cost_;
     currentBuffer_ = buffer1_;
@@ -88,8 +123,7 @@ bool DijkstraExpansion::calculatePotentials(unsigned char* costs, double start_x
     nextEnd_ = 0;
     overBuffer_ = buffer3_;
     overEnd_ = 0;
-    memset(pending_, 0, ns_ * sizeof(bool));
-    std::fill(potential, potential + ns_, POT_HIGH);
+    clearPotentials(potential);
 
     // set goal
     int k = toIndex(start_x, start_y);
@@ -99,10 +133,10 @@ bool DijkstraExpansion::calculatePotentials(unsigned char* costs, double start_x
         double dx = start_x - (int)start_x, dy = start_y - (int)start_y;
         dx = floorf(dx * 100 + 0.5) / 100;
         dy = floorf(dy * 100 + 0.5) / 100;
-        potential[k] = neutral_cost_ * 2 * dx * dy;
-        potential[k+1] = neutral_cost_ * 2 * (1-dx)*dy;
-        potential[k+nx_] = neutral_cost_*2*dx*(1-dy);
-        potential[k+nx_+1] = neutral_cost_*2*(1-dx)*(1-dy);//*/
+        setPotential(potential, k, neutral_cost_ * 2 * dx * dy);
+        setPotential(potential, k+1, neutral_cost_ * 2 * (1-dx)*dy);
+        setPotential(potential, k+nx_, neutral_cost_*2*dx*(1-dy));
+        setPotential(potential, k+nx_+1, neutral_cost_*2*(1-dx)*(1-dy));//*/
 
         push_cur(k+2);
         push_cur(k-1);
@@ -114,7 +148,7 @@ bool DijkstraExpansion::calculatePotentials(unsigned char* costs, double start_x
         push_cur(k+nx_*2);
         push_cur(k+nx_*2+1);
     }else{
-        potential[k] = 0;
+        setPotential(potential, k, 0);
         push_cur(k+1);
         push_cur(k-1);
         push_cur(k-nx_);
@@ -125,8 +159,8 @@ bool DijkstraExpansion::calculatePotentials(unsigned char* costs, double start_x
     int nc = 0;            // number of cells put into priority blocks
     int cycle = 0;        // which cycle we're on
 
-    // set up start cell
-    int startCell = toIndex(end_x, end_y);
+    // goals are only ever reached once, so those before reached have been
+    int reached = 0;
 
     for (; cycle < cycles; cycle++) // go for this many cycles, unless interrupted
             {
@@ -168,8 +202,10 @@ bool DijkstraExpansion::calculatePotentials(unsigned char* costs, double start_x
             overBuffer_ = pb;
         }
 
-        // check if we've hit the Start cell
-        if (potential[startCell] < POT_HIGH)
+        // check if we've hit all the Start cells
+        while (reached < num_goals && potential[goals[reached]] < POT_HIGH)
+            reached++;
+        if (reached == num_goals)
             break;
     }
     //ROS_INFO("CYCLES %d/%d ", cycle, cycles);
@@ -205,7 +241,7 @@ inline void DijkstraExpansion::updateCell(unsigned char* costs, float* potential
         float re = INVSQRT2 * (float)getCost(costs, n + 1);
         float ue = INVSQRT2 * (float)getCost(costs, n - nx_);
         float de = INVSQRT2 * (float)getCost(costs, n + nx_);
-        potential[n] = pot;
+        setPotential(potential, n, pot);
         //ROS_INFO("UPDATE %d %d %d %f", n, n%nx, n/nx, potential[n]);
         if (pot < threshold_)    // low-cost buffer block
                 {
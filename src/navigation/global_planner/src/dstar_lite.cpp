@@ -0,0 +1,171 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+#include <global_planner/dstar_lite.h>
+#include <algorithm>
+#include <cstring>
+
+namespace global_planner {
+
+DStarLiteExpansion::DStarLiteExpansion(PotentialCalculator* p_calc, int nx, int ny) :
+        Expander(p_calc, nx, ny), goal_i_(-1), compact_size_(1024) {
+}
+
+bool DStarLiteExpansion::calculatePotentials(unsigned char* costs, double start_x, double start_y, double end_x,
+                                             double end_y, int cycles, float* potential) {
+    int start_i = toIndex(start_x, start_y);
+    int goal_i = toIndex(end_x, end_y);
+
+    if (potential != last_potential_ || goal_i != goal_i_ || (int) costs_.size() != ns_ ||
+            lethal_cost_ != last_lethal_cost_ || neutral_cost_ != last_neutral_cost_ || factor_ != last_factor_ ||
+            unknown_ != last_unknown_) {
+        reset(costs, potential, goal_i);
+    } else {
+        // undo clearEndpoint(), which only sets cells that had no potential
+        for (unsigned int i = 0; i < touched_.size(); i++)
+            potential[touched_[i]] = POT_HIGH;
+        touched_.clear();
+
+        // repair from the cells whose cost changed since the last call
+        for (int row = 0; row < ns_; row += nx_) {
+            if (memcmp(costs + row, &costs_[row], nx_) == 0)
+                continue;
+            for (int n = row; n < row + nx_; n++) {
+                if (costs[n] != costs_[n]) {
+                    costs_[n] = costs[n];
+                    updateCell(costs, potential, n);
+                }
+            }
+        }
+    }
+
+    return computePotentials(costs, potential, start_i, cycles);
+}
+
+void DStarLiteExpansion::reset(unsigned char* costs, float* potential, int goal_i) {
+    if (rhs_.capacity() < (size_t) ns_)
+        workspace_growth_ += 2;
+    std::fill(potential, potential + ns_, POT_HIGH);
+    rhs_.assign(ns_, POT_HIGH);
+    costs_.assign(costs, costs + ns_);
+    queue_.clear();
+    touched_.clear();
+    last_potential_ = potential;
+
+    goal_i_ = goal_i;
+    last_lethal_cost_ = lethal_cost_;
+    last_neutral_cost_ = neutral_cost_;
+    last_factor_ = factor_;
+    last_unknown_ = unknown_;
+
+    rhs_[goal_i] = 0;
+    pushBack(queue_, Index(goal_i, 0));
+}
+
+//
+// Recompute the lookahead potential of a cell from its neighbors,
+//   and queue it if it no longer matches its potential
+//
+void DStarLiteExpansion::updateCell(unsigned char* costs, float* potential, int n) {
+    if (n != goal_i_) {
+        int x = n % nx_, y = n / nx_;
+        float c = getCost(costs, n);
+        // don't propagate into obstacles or off the edge of the map
+        if (c >= lethal_cost_ || x == 0 || x == nx_ - 1 || y == 0 || y == ny_ - 1)
+            rhs_[n] = POT_HIGH;
+        else
+            rhs_[n] = std::min(p_calc_->calculatePotential(potential, c, n), (float) POT_HIGH);
+    }
+
+    if (potential[n] != rhs_[n]) {
+        pushBack(queue_, Index(n, std::min(potential[n], rhs_[n])));
+        std::push_heap(queue_.begin(), queue_.end(), greater1());
+    }
+}
+
+bool DStarLiteExpansion::computePotentials(unsigned char* costs, float* potential, int start_i, int cycles) {
+    for (int cycle = 0; cycle < cycles; cycle++) {
+        while (queue_.size() > 0 && !isQueued(potential, queue_[0])) {
+            std::pop_heap(queue_.begin(), queue_.end(), greater1());
+            queue_.pop_back();
+        }
+
+        // done once the start is consistent and nothing queued can lower it
+        float start_key = std::min(potential[start_i], rhs_[start_i]);
+        if (queue_.size() == 0 || (queue_[0].cost >= start_key && potential[start_i] == rhs_[start_i]))
+            break;
+
+        int n = queue_[0].i;
+        std::pop_heap(queue_.begin(), queue_.end(), greater1());
+        queue_.pop_back();
+
+        if (potential[n] > rhs_[n]) {
+            potential[n] = rhs_[n];
+        } else {
+            potential[n] = POT_HIGH;
+            updateCell(costs, potential, n);
+        }
+
+        int x = n % nx_, y = n / nx_;
+        if (x > 0)
+            updateCell(costs, potential, n - 1);
+        if (x < nx_ - 1)
+            updateCell(costs, potential, n + 1);
+        if (y > 0)
+            updateCell(costs, potential, n - nx_);
+        if (y < ny_ - 1)
+            updateCell(costs, potential, n + nx_);
+    }
+
+    if (queue_.size() > compact_size_)
+        compactQueue(potential);
+
+    return potential[start_i] < POT_HIGH;
+}
+
+//
+// Drop the stale entries, which would otherwise pile up beyond the
+//   start from one call to the next
+//
+void DStarLiteExpansion::compactQueue(float* potential) {
+    unsigned int kept = 0;
+    for (unsigned int i = 0; i < queue_.size(); i++)
+        if (isQueued(potential, queue_[i]))
+            queue_[kept++] = queue_[i];
+    queue_.resize(kept, Index(0, 0));
+    std::make_heap(queue_.begin(), queue_.end(), greater1());
+    compact_size_ = std::max((size_t) 1024, 2 * queue_.size());
+}
+
+} //end namespace global_planner
@@ -56,6 +56,8 @@ GradientPath::~GradientPath() {
 }
 
 void GradientPath::setSize(int xs, int ys) {
+    if (gradx_ && xs == xs_ && ys == ys_)
+        return;
     Traceback::setSize(xs, ys);
     if (gradx_)
         delete[] gradx_;
@@ -63,6 +65,10 @@ void GradientPath::setSize(int xs, int ys) {
         delete[] grady_;
     gradx_ = new float[xs * ys];
     grady_ = new float[xs * ys];
+    memset(gradx_, 0, xs * ys * sizeof(float));
+    memset(grady_, 0, xs * ys * sizeof(float));
+    gradients_.clear();
+    workspace_growth_++;
 }
 
 bool GradientPath::getPath(float* potential, double start_x, double start_y, double goal_x, double goal_y, std::vector<std::pair<float, float> >& path) {
@@ -73,8 +79,9 @@ bool GradientPath::getPath(float* potential, double start_x, double start_y, dou
     float dx = goal_x - (int)goal_x;
     float dy = goal_y - (int)goal_y;
     int ns = xs_ * ys_;
-    memset(gradx_, 0, ns * sizeof(float));
-    memset(grady_, 0, ns * sizeof(float));
+    for (unsigned int i = 0; i < gradients_.size(); i++)
+        gradx_[gradients_[i]] = grady_[gradients_[i]] = 0;
+    gradients_.clear();
 
     int c = 0;
     while (c++<ns*4) {
@@ -307,6 +314,9 @@ float GradientPath::gradCell(float* potential, int n) {
         norm = 1.0 / norm;
         gradx_[n] = norm * dx;
         grady_[n] = norm * dy;
+        if (gradients_.size() == gradients_.capacity())
+            workspace_growth_++;
+        gradients_.push_back(n);
     }
     return norm;
 }
@@ -0,0 +1,428 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+#include <global_planner/hierarchical.h>
+#include <algorithm>
+#include <cstring>
+
+namespace global_planner {
+
+// entrances at least this wide get a portal at each end instead of one in the middle
+static const int WIDE_ENTRANCE = 6;
+
+HierarchicalExpansion::HierarchicalExpansion(PotentialCalculator* p_calc, int nx, int ny, int cluster_size) :
+        Expander(p_calc, nx, ny), cluster_size_(std::max(cluster_size, 2)), valid_(false), last_lethal_cost_(0),
+        last_neutral_cost_(0), last_unknown_(false) {
+    layoutClusters();
+}
+
+void HierarchicalExpansion::setSize(int nx, int ny) {
+    if (nx == nx_ && ny == ny_)
+        return;
+    Expander::setSize(nx, ny);
+    layoutClusters();
+}
+
+void HierarchicalExpansion::layoutClusters() {
+    cx_ = (nx_ + cluster_size_ - 1) / cluster_size_;
+    cy_ = (ny_ + cluster_size_ - 1) / cluster_size_;
+    int n = cx_ * cy_;
+    clusters_.assign(n, Cluster());
+    east_entrances_.assign(n, std::vector<int>());
+    north_entrances_.assign(n, std::vector<int>());
+    dirty_.assign(n, 1);
+    corridor_.assign(n, 0);
+    costs_.assign(ns_, 0);
+    valid_ = false;
+}
+
+bool HierarchicalExpansion::calculatePotentials(unsigned char* costs, double start_x, double start_y, double end_x,
+                                               double end_y, int cycles, float* potential) {
+    int start_i = toIndex(start_x, start_y);
+    int goal_i = toIndex(end_x, end_y);
+
+    updateAbstraction(costs);
+
+    if (searchAbstraction(costs, start_i, goal_i)) {
+        bool found = refine(costs, potential, start_i, goal_i, cycles);
+        for (unsigned int i = 0; i < corridor_clusters_.size(); i++)
+            corridor_[corridor_clusters_[i]] = 0;
+        if (found)
+            return true;
+    }
+
+    // no abstract path, or none within its clusters; search the whole map
+    std::fill(corridor_.begin(), corridor_.end(), 1);
+    bool found = refine(costs, potential, start_i, goal_i, cycles);
+    std::fill(corridor_.begin(), corridor_.end(), 0);
+    return found;
+}
+
+void HierarchicalExpansion::updateAbstraction(unsigned char* costs) {
+    if (lethal_cost_ != last_lethal_cost_ || neutral_cost_ != last_neutral_cost_ || unknown_ != last_unknown_)
+        valid_ = false;
+
+    // find the clusters whose costs changed since the last plan
+    bool any_dirty = !valid_;
+    if (!valid_) {
+        std::fill(dirty_.begin(), dirty_.end(), 1);
+        std::copy(costs, costs + ns_, costs_.begin());
+    } else {
+        for (int y = 0; y < ny_; y++) {
+            int row = y * nx_;
+            int c = (y / cluster_size_) * cx_;
+            for (int x = 0; x < nx_; x += cluster_size_, c++) {
+                int length = std::min(cluster_size_, nx_ - x);
+                if (memcmp(costs + row + x, &costs_[row + x], length) != 0) {
+                    memcpy(&costs_[row + x], costs + row + x, length);
+                    dirty_[c] = 1;
+                    any_dirty = true;
+                }
+            }
+        }
+    }
+    if (!any_dirty)
+        return;
+
+    // the entrances on the borders of changed clusters
+    for (int c = 0; c < cx_ * cy_; c++) {
+        if (!dirty_[c])
+            continue;
+        int x = c % cx_, y = c / cx_;
+        int x0 = x * cluster_size_, y0 = y * cluster_size_;
+        int width = std::min(cluster_size_, nx_ - x0), height = std::min(cluster_size_, ny_ - y0);
+        if (x + 1 < cx_)
+            findEntrances(costs, toIndex(x0 + width - 1, y0), nx_, 1, height, east_entrances_[c]);
+        if (x > 0)
+            findEntrances(costs, toIndex(x0 - 1, y0), nx_, 1, height, east_entrances_[c - 1]);
+        if (y + 1 < cy_)
+            findEntrances(costs, toIndex(x0, y0 + height - 1), 1, nx_, width, north_entrances_[c]);
+        if (y > 0)
+            findEntrances(costs, toIndex(x0, y0 - 1), 1, nx_, width, north_entrances_[c - cx_]);
+    }
+
+    // changed clusters and their neighbors, whose portals on the shared borders may have moved
+    for (int c = 0; c < cx_ * cy_; c++) {
+        int x = c % cx_, y = c / cx_;
+        if (dirty_[c] || (x > 0 && dirty_[c - 1]) || (x + 1 < cx_ && dirty_[c + 1]) ||
+                (y > 0 && dirty_[c - cx_]) || (y + 1 < cy_ && dirty_[c + cx_]))
+            buildCluster(costs, c);
+    }
+    std::fill(dirty_.begin(), dirty_.end(), 0);
+
+    linkClusters();
+
+    valid_ = true;
+    last_lethal_cost_ = lethal_cost_;
+    last_neutral_cost_ = neutral_cost_;
+    last_unknown_ = unknown_;
+}
+
+void HierarchicalExpansion::findEntrances(unsigned char* costs, int cell, int step, int across, int length,
+                                          std::vector<int>& entrances) {
+    entrances.clear();
+    int start = -1;
+    for (int i = 0; i <= length; i++, cell += step) {
+        bool open = i < length && isTraversable(costs[cell]) && isTraversable(costs[cell + across]);
+        if (open && start < 0)
+            start = i;
+        if (open || start < 0)
+            continue;
+
+        int first = cell - (i - start) * step, last = cell - step;
+        if (i - start >= WIDE_ENTRANCE) {
+            entrances.push_back(first);
+            entrances.push_back(last);
+        } else
+            entrances.push_back(first + (i - start) / 2 * step);
+        start = -1;
+    }
+}
+
+void HierarchicalExpansion::buildCluster(unsigned char* costs, int c) {
+    Cluster& cluster = clusters_[c];
+    std::vector<int>& portals = cluster.portals;
+    int x = c % cx_, y = c / cx_;
+
+    portals = east_entrances_[c];
+    cluster.west = portals.size();
+    if (x > 0)
+        for (unsigned int i = 0; i < east_entrances_[c - 1].size(); i++)
+            portals.push_back(east_entrances_[c - 1][i] + 1);
+    cluster.north = portals.size();
+    portals.insert(portals.end(), north_entrances_[c].begin(), north_entrances_[c].end());
+    cluster.south = portals.size();
+    if (y > 0)
+        for (unsigned int i = 0; i < north_entrances_[c - cx_].size(); i++)
+            portals.push_back(north_entrances_[c - cx_][i] + nx_);
+
+    // a path from j to k costs what the reversed path from k to j does, except that it enters
+    // k instead of j, so one search per pair of portals is enough
+    int n = portals.size();
+    cluster.distances.assign(n * n, 0);
+    for (int k = 0; k + 1 < n; k++) {
+        targets_.assign(portals.begin() + k + 1, portals.end());
+        float* distances = &cluster.distances[k * n + k + 1];
+        searchCluster(costs, c, portals[k], targets_, distances);
+        for (int j = k + 1; j < n; j++) {
+            float distance = distances[j - k - 1];
+            if (distance < POT_HIGH)
+                distance += (float) costs[portals[k]] - costs[portals[j]];
+            cluster.distances[j * n + k] = distance;
+        }
+    }
+}
+
+void HierarchicalExpansion::linkClusters() {
+    node_cells_.clear();
+    node_clusters_.clear();
+    for (int c = 0; c < cx_ * cy_; c++) {
+        clusters_[c].first_node = node_cells_.size();
+        node_cells_.insert(node_cells_.end(), clusters_[c].portals.begin(), clusters_[c].portals.end());
+        node_clusters_.resize(node_cells_.size(), c);
+    }
+
+    // both sides of a border list its entrances in the same order
+    node_links_.resize(node_cells_.size());
+    for (int c = 0; c < cx_ * cy_; c++) {
+        const Cluster& cluster = clusters_[c];
+        if (c % cx_ + 1 < cx_) {
+            const Cluster& east = clusters_[c + 1];
+            for (int k = 0; k < cluster.west; k++) {
+                node_links_[cluster.first_node + k] = east.first_node + east.west + k;
+                node_links_[east.first_node + east.west + k] = cluster.first_node + k;
+            }
+        }
+        if (c / cx_ + 1 < cy_) {
+            const Cluster& north = clusters_[c + cx_];
+            for (int k = 0; k < cluster.south - cluster.north; k++) {
+                node_links_[cluster.first_node + cluster.north + k] = north.first_node + north.south + k;
+                node_links_[north.first_node + north.south + k] = cluster.first_node + cluster.north + k;
+            }
+        }
+    }
+}
+
+void HierarchicalExpansion::searchCluster(unsigned char* costs, int c, int source, const std::vector<int>& targets,
+                                          float* distances) {
+    int x0 = c % cx_ * cluster_size_, y0 = c / cx_ * cluster_size_;
+    int width = std::min(cluster_size_, nx_ - x0), height = std::min(cluster_size_, ny_ - y0);
+
+    // Dijkstra over the cells of the cluster, in cluster coordinates, until all targets are reached
+    local_.assign(width * height, POT_HIGH);
+    local_targets_.assign(width * height, 0);
+    int remaining = 0;
+    for (unsigned int k = 0; k < targets.size(); k++) {
+        int i = targets[k] % nx_ - x0 + (targets[k] / nx_ - y0) * width;
+        remaining += !local_targets_[i];
+        local_targets_[i] = 1;
+    }
+
+    queue_.clear();
+    int local_source = source % nx_ - x0 + (source / nx_ - y0) * width;
+    local_[local_source] = 0;
+    pushBack(queue_, Index(local_source, 0));
+
+    while (queue_.size() > 0 && remaining > 0) {
+        Index top = queue_[0];
+        std::pop_heap(queue_.begin(), queue_.end(), greater1());
+        queue_.pop_back();
+        if (top.cost > local_[top.i])
+            continue;
+        if (local_targets_[top.i]) {
+            local_targets_[top.i] = 0;
+            remaining--;
+        }
+
+        int x = top.i % width, y = top.i / width;
+        int neighbors[4] = { x > 0 ? top.i - 1 : -1, x + 1 < width ? top.i + 1 : -1,
+                             y > 0 ? top.i - width : -1, y + 1 < height ? top.i + width : -1 };
+        for (int k = 0; k < 4; k++) {
+            int next = neighbors[k];
+            if (next < 0)
+                continue;
+            unsigned char cost = costs[x0 + next % width + (y0 + next / width) * nx_];
+            if (!isTraversable(cost))
+                continue;
+            float distance = top.cost + cost + neutral_cost_;
+            if (distance < local_[next]) {
+                local_[next] = distance;
+                pushBack(queue_, Index(next, distance));
+                std::push_heap(queue_.begin(), queue_.end(), greater1());
+            }
+        }
+    }
+
+    for (unsigned int k = 0; k < targets.size(); k++)
+        distances[k] = local_[targets[k] % nx_ - x0 + (targets[k] / nx_ - y0) * width];
+}
+
+bool HierarchicalExpansion::searchAbstraction(unsigned char* costs, int start_i, int goal_i) {
+    int start_cluster = clusterOf(start_i), goal_cluster = clusterOf(goal_i);
+    const Cluster& first = clusters_[start_cluster];
+    const Cluster& last = clusters_[goal_cluster];
+    int nodes = node_cells_.size();
+    int start_node = nodes, goal_node = nodes + 1;
+
+    // connect the start and the goal to the portals of their clusters
+    targets_ = first.portals;
+    if (start_cluster == goal_cluster)
+        pushBack(targets_, goal_i);
+    start_distances_.resize(targets_.size());
+    if (!targets_.empty())
+        searchCluster(costs, start_cluster, start_i, targets_, &start_distances_[0]);
+
+    // searching from the goal costs the portal instead of the goal cell
+    goal_distances_.resize(last.portals.size());
+    if (!last.portals.empty())
+        searchCluster(costs, goal_cluster, goal_i, last.portals, &goal_distances_[0]);
+    for (unsigned int k = 0; k < last.portals.size(); k++)
+        if (goal_distances_[k] < POT_HIGH)
+            goal_distances_[k] += (float) costs[goal_i] - costs[last.portals[k]];
+
+    node_costs_.assign(nodes + 2, POT_HIGH);
+    node_parents_.assign(nodes + 2, -1);
+    closed_.assign(nodes + 2, 0);
+    queue_.clear();
+    node_costs_[start_node] = 0;
+    pushBack(queue_, Index(start_node, 0));
+
+    bool found = false;
+    while (queue_.size() > 0) {
+        int u = queue_[0].i;
+        std::pop_heap(queue_.begin(), queue_.end(), greater1());
+        queue_.pop_back();
+        if (u == goal_node) {
+            found = true;
+            break;
+        }
+        if (closed_[u])
+            continue;
+        closed_[u] = 1;
+
+        // edges out of u, as (node, cost) pairs
+        edges_.clear();
+        if (u == start_node) {
+            for (unsigned int k = 0; k < first.portals.size(); k++)
+                pushBack(edges_, std::make_pair(first.first_node + k, start_distances_[k]));
+            if (start_cluster == goal_cluster)
+                pushBack(edges_, std::make_pair(goal_node, start_distances_.back()));
+        } else {
+            int c = node_clusters_[u];
+            const Cluster& cluster = clusters_[c];
+            int n = cluster.portals.size(), k = u - cluster.first_node;
+            for (int j = 0; j < n; j++)
+                if (j != k)
+                    pushBack(edges_, std::make_pair(cluster.first_node + j, cluster.distances[k * n + j]));
+            int link = node_links_[u];
+            pushBack(edges_, std::make_pair(link, (float) costs[node_cells_[link]] + neutral_cost_));
+            if (c == goal_cluster)
+                pushBack(edges_, std::make_pair(goal_node, goal_distances_[k]));
+        }
+
+        for (unsigned int e = 0; e < edges_.size(); e++) {
+            int v = edges_[e].first;
+            if (edges_[e].second >= POT_HIGH || closed_[v])
+                continue;
+            float cost = node_costs_[u] + edges_[e].second;
+            if (cost >= node_costs_[v])
+                continue;
+            node_costs_[v] = cost;
+            node_parents_[v] = u;
+            int cell = v == goal_node ? goal_i : node_cells_[v];
+            pushBack(queue_, Index(v, cost + heuristic(cell, goal_i)));
+            std::push_heap(queue_.begin(), queue_.end(), greater1());
+        }
+    }
+    if (!found)
+        return false;
+
+    // the corridor is every cluster the abstract path passes through
+    corridor_clusters_.clear();
+    for (int u = goal_node; u >= 0; u = node_parents_[u]) {
+        int c = u == goal_node ? goal_cluster : u == start_node ? start_cluster : node_clusters_[u];
+        if (!corridor_[c]) {
+            corridor_[c] = 1;
+            corridor_clusters_.push_back(c);
+        }
+    }
+    return true;
+}
+
+bool HierarchicalExpansion::refine(unsigned char* costs, float* potential, int start_i, int goal_i, int cycles) {
+    queue_.clear();
+    pushBack(queue_, Index(start_i, 0));
+
+    clearPotentials(potential);
+    setPotential(potential, start_i, 0);
+
+    int end_x = goal_i % nx_, end_y = goal_i / nx_;
+    int cycle = 0;
+
+    while (queue_.size() > 0 && cycle < cycles) {
+        Index top = queue_[0];
+        std::pop_heap(queue_.begin(), queue_.end(), greater1());
+        queue_.pop_back();
+
+        int i = top.i;
+        if (i == goal_i)
+            return true;
+
+        add(costs, potential, potential[i], i + 1, end_x, end_y);
+        add(costs, potential, potential[i], i - 1, end_x, end_y);
+        add(costs, potential, potential[i], i + nx_, end_x, end_y);
+        add(costs, potential, potential[i], i - nx_, end_x, end_y);
+    }
+
+    return false;
+}
+
+void HierarchicalExpansion::add(unsigned char* costs, float* potential, float prev_potential, int next_i, int end_x,
+                                int end_y) {
+    if (potential[next_i] < POT_HIGH)
+        return;
+
+    if (!isTraversable(costs[next_i]) || !corridor_[clusterOf(next_i)])
+        return;
+
+    setPotential(potential, next_i,
+                 p_calc_->calculatePotential(potential, costs[next_i] + neutral_cost_, next_i, prev_potential));
+    int x = next_i % nx_, y = next_i / nx_;
+    float distance = abs(end_x - x) + abs(end_y - y);
+
+    pushBack(queue_, Index(next_i, potential[next_i] + distance * neutral_cost_));
+    std::push_heap(queue_.begin(), queue_.end(), greater1());
+}
+
+} //end namespace global_planner
@@ -40,9 +40,13 @@
 #include <tf/transform_listener.h>
 #include <costmap_2d/cost_values.h>
 #include <costmap_2d/costmap_2d.h>
+#include <cstring>
 
 #include <global_planner/dijkstra.h>
 #include <global_planner/astar.h>
+#include <global_planner/bucket_astar.h>
+#include <global_planner/dstar_lite.h>
+#include <global_planner/hierarchical.h>
 #include <global_planner/grid_path.h>
 #include <global_planner/gradient_path.h>
 #include <global_planner/quadratic_calculator.h>
@@ -68,11 +72,13 @@ void GlobalPlanner::outlineMap(unsigned char* costarr, int nx, int ny, unsigned
 }
 
 GlobalPlanner::GlobalPlanner() :
-        costmap_(NULL), initialized_(false), allow_unknown_(true) {
+        costmap_(NULL), initialized_(false), allow_unknown_(true), potential_array_(NULL), potential_size_(0),
+        batch_planner_(NULL), workspace_growth_(0), costmap_ros_(NULL) {
 }
 
 GlobalPlanner::GlobalPlanner(std::string name, costmap_2d::Costmap2D* costmap, std::string frame_id) :
-        costmap_(NULL), initialized_(false), allow_unknown_(true) {
+        costmap_(NULL), initialized_(false), allow_unknown_(true), potential_array_(NULL), potential_size_(0),
+        batch_planner_(NULL), workspace_growth_(0), costmap_ros_(NULL) {
     //initialize the planner
     initialize(name, costmap, frame_id);
 }
@@ -84,11 +90,16 @@ GlobalPlanner::~GlobalPlanner() {
         delete planner_;
     if (path_maker_)
         delete path_maker_;
+    if (batch_planner_)
+        delete batch_planner_;
     if (dsrv_)
         delete dsrv_;
+    delete[] potential_array_;
 }
 
 void GlobalPlanner::initialize(std::string name, costmap_2d::Costmap2DROS* costmap_ros) {
+    if (!initialized_)
+        costmap_ros_ = costmap_ros;
     initialize(name, costmap_ros->getCostmap(), costmap_ros->getGlobalFrameID());
 }
 
@@ -113,9 +124,19 @@ void GlobalPlanner::initialize(std::string name, costmap_2d::Costmap2D* costmap,
         else
             p_calc_ = new PotentialCalculator(cx, cy);
 
-        bool use_dijkstra;
+        bool use_dijkstra, use_hierarchical, use_dstar_lite;
         private_nh.param("use_dijkstra", use_dijkstra, true);
-        if (use_dijkstra)
+        private_nh.param("use_hierarchical", use_hierarchical, false);
+        private_nh.param("use_dstar_lite", use_dstar_lite, false);
+        if (use_hierarchical)
+        {
+            int cluster_size;
+            private_nh.param("hierarchical_cluster_size", cluster_size, 32);
+            planner_ = new HierarchicalExpansion(p_calc_, cx, cy, cluster_size);
+        }
+        else if (use_dstar_lite)
+            planner_ = new DStarLiteExpansion(p_calc_, cx, cy);
+        else if (use_dijkstra)
         {
             DijkstraExpansion* de = new DijkstraExpansion(p_calc_, cx, cy);
             if(!old_navfn_behavior_)
@@ -123,7 +144,18 @@ void GlobalPlanner::initialize(std::string name, costmap_2d::Costmap2D* costmap,
             planner_ = de;
         }
         else
-            planner_ = new AStarExpansion(p_calc_, cx, cy);
+        {
+            bool use_bucket_queue;
+            private_nh.param("use_bucket_queue", use_bucket_queue, false);
+            if (use_bucket_queue)
+                planner_ = new BucketAStarExpansion(p_calc_, cx, cy);
+            else
+                planner_ = new AStarExpansion(p_calc_, cx, cy);
+        }
+
+        batch_planner_ = new DijkstraExpansion(p_calc_, cx, cy);
+        if(!old_navfn_behavior_)
+            batch_planner_->setPreciseStart(true);
 
         bool use_grid_path;
         private_nh.param("use_grid_path", use_grid_path, false);
@@ -139,6 +171,7 @@ void GlobalPlanner::initialize(std::string name, costmap_2d::Costmap2D* costmap,
 
         private_nh.param("allow_unknown", allow_unknown_, true);
         planner_->setHasUnknown(allow_unknown_);
+        batch_planner_->setHasUnknown(allow_unknown_);
         private_nh.param("planner_window_x", planner_window_x_, 0.0);
         private_nh.param("planner_window_y", planner_window_y_, 0.0);
         private_nh.param("default_tolerance", default_tolerance_, 0.0);
@@ -152,6 +185,7 @@ void GlobalPlanner::initialize(std::string name, costmap_2d::Costmap2D* costmap,
         tf_prefix_ = tf::getPrefixParam(prefix_nh);
 
         make_plan_srv_ = private_nh.advertiseService("make_plan", &GlobalPlanner::makePlanService, this);
+        make_plans_srv_ = private_nh.advertiseService("make_plans", &GlobalPlanner::makePlansService, this);
 
         dsrv_ = new dynamic_reconfigure::Server<global_planner::GlobalPlannerConfig>(ros::NodeHandle("~/" + name));
         dynamic_reconfigure::Server<global_planner::GlobalPlannerConfig>::CallbackType cb = boost::bind(
@@ -169,6 +203,9 @@ void GlobalPlanner::reconfigureCB(global_planner::GlobalPlannerConfig& config, u
     path_maker_->setLethalCost(config.lethal_cost);
     planner_->setNeutralCost(config.neutral_cost);
     planner_->setFactor(config.cost_factor);
+    batch_planner_->setLethalCost(config.lethal_cost);
+    batch_planner_->setNeutralCost(config.neutral_cost);
+    batch_planner_->setFactor(config.cost_factor);
     publish_potential_ = config.publish_potential;
     orientation_filter_->setMode(config.orientation_mode);
 }
@@ -184,6 +221,26 @@ void GlobalPlanner::clearRobotCell(const tf::Stamped<tf::Pose>& global_pose, uns
     costmap_->setCost(mx, my, costmap_2d::FREE_SPACE);
 }
 
+void GlobalPlanner::copyCostmapSnapshot() {
+    if (costmap_ros_ == NULL)
+        return;
+
+    // a copy of the costmap as of its last update, so that planning does not hold up updates
+    boost::shared_ptr<const costmap_2d::Costmap2D> snapshot = costmap_ros_->getCostmapSnapshot();
+    if (snapshot_copy_.getSizeInCellsX() == snapshot->getSizeInCellsX()
+            && snapshot_copy_.getSizeInCellsY() == snapshot->getSizeInCellsY()
+            && snapshot_copy_.getResolution() == snapshot->getResolution()
+            && snapshot_copy_.getOriginX() == snapshot->getOriginX()
+            && snapshot_copy_.getOriginY() == snapshot->getOriginY()) {
+        memcpy(snapshot_copy_.getCharMap(), snapshot->getCharMap(),
+               snapshot->getSizeInCellsX() * snapshot->getSizeInCellsY());
+    } else {
+        snapshot_copy_ = *snapshot;
+        workspace_growth_++;
+    }
+    costmap_ = &snapshot_copy_;
+}
+
 bool GlobalPlanner::makePlanService(nav_msgs::GetPlan::Request& req, nav_msgs::GetPlan::Response& resp) {
     makePlan(req.start, req.goal, resp.plan.poses);
 
@@ -193,6 +250,21 @@ bool GlobalPlanner::makePlanService(nav_msgs::GetPlan::Request& req, nav_msgs::G
     return true;
 }
 
+bool GlobalPlanner::makePlansService(MakePlans::Request& req, MakePlans::Response& resp) {
+    std::vector<std::vector<geometry_msgs::PoseStamped> > plans;
+    makePlans(req.start, req.goals, resp.costs, req.return_plans ? &plans : NULL);
+
+    resp.plans.resize(plans.size());
+    for (unsigned int i = 0; i < plans.size(); i++) {
+        resp.plans[i].header.stamp = ros::Time::now();
+        resp.plans[i].header.frame_id = frame_id_;
+        resp.plans[i].poses.swap(plans[i]);
+    }
+    resp.workspace_growth = getWorkspaceGrowth();
+
+    return true;
+}
+
 void GlobalPlanner::mapToWorld(double mx, double my, double& wx, double& wy) {
     wx = costmap_->getOriginX() + (mx+convert_offset_) * costmap_->getResolution();
     wy = costmap_->getOriginY() + (my+convert_offset_) * costmap_->getResolution();
@@ -228,10 +300,12 @@ bool GlobalPlanner::makePlan(const geometry_msgs::PoseStamped& start, const geom
         return false;
     }
 
+    copyCostmapSnapshot();
+
     //clear the plan, just in case
     plan.clear();
 
-    ros::NodeHandle n;
+    unsigned int growth_before = getWorkspaceGrowth();
     std::string global_frame = frame_id_;
 
     //until tf can handle transforming things that are way in the past... we'll require the goal to be in our global frame
@@ -291,16 +365,26 @@ bool GlobalPlanner::makePlan(const geometry_msgs::PoseStamped& start, const geom
     p_calc_->setSize(nx, ny);
     planner_->setSize(nx, ny);
     path_maker_->setSize(nx, ny);
-    potential_array_ = new float[nx * ny];
+    if (potential_size_ != nx * ny) {
+        delete[] potential_array_;
+        potential_array_ = new float[nx * ny];
+        potential_size_ = nx * ny;
+        workspace_growth_++;
+    }
 
     outlineMap(costmap_->getCharMap(), nx, ny, costmap_2d::LETHAL_OBSTACLE);
 
     bool found_legal = planner_->calculatePotentials(costmap_->getCharMap(), start_x, start_y, goal_x, goal_y,
                                                     nx * ny * 2, potential_array_);
 
-    if(!old_navfn_behavior_)
-        planner_->clearEndpoint(costmap_->getCharMap(), potential_array_, goal_x_i, goal_y_i, 2);
-    if(publish_potential_)
+    if(!old_navfn_behavior_) {
+        // the path is traced down the potential, starting from the end it was not expanded from
+        if (planner_->expandsFromGoal())
+            planner_->clearEndpoint(costmap_->getCharMap(), potential_array_, start_x_i, start_y_i, 2);
+        else
+            planner_->clearEndpoint(costmap_->getCharMap(), potential_array_, goal_x_i, goal_y_i, 2);
+    }
+    if(publish_potential_ && potential_pub_.getNumSubscribers() > 0)
         publishPotential(potential_array_);
 
     if (found_legal) {
@@ -322,10 +406,151 @@ bool GlobalPlanner::makePlan(const geometry_msgs::PoseStamped& start, const geom
     
     //publish the plan for visualization purposes
     publishPlan(plan);
-    delete potential_array_;
+
+    unsigned int grown = getWorkspaceGrowth() - growth_before;
+    if (grown > 0)
+        ROS_INFO("Planning grew the workspace %u times, %u since initialization", grown, getWorkspaceGrowth());
     return !plan.empty();
 }
 
+bool GlobalPlanner::makePlans(const geometry_msgs::PoseStamped& start,
+                              const std::vector<geometry_msgs::PoseStamped>& goals, std::vector<double>& costs,
+                              std::vector<std::vector<geometry_msgs::PoseStamped> >* plans) {
+    boost::mutex::scoped_lock lock(mutex_);
+    if (!initialized_) {
+        ROS_ERROR(
+                "This planner has not been initialized yet, but it is being used, please call initialize() before use");
+        return false;
+    }
+
+    copyCostmapSnapshot();
+
+    unsigned int growth_before = getWorkspaceGrowth();
+    costs.assign(goals.size(), -1.0);
+    if (plans) {
+        plans->resize(goals.size());
+        for (unsigned int i = 0; i < goals.size(); i++)
+            (*plans)[i].clear();
+    }
+
+    std::string global_frame = frame_id_;
+
+    if (tf::resolve(tf_prefix_, start.header.frame_id) != tf::resolve(tf_prefix_, global_frame)) {
+        ROS_ERROR(
+                "The start pose passed to this planner must be in the %s frame.  It is instead in the %s frame.", tf::resolve(tf_prefix_, global_frame).c_str(), tf::resolve(tf_prefix_, start.header.frame_id).c_str());
+        return false;
+    }
+
+    double wx = start.pose.position.x;
+    double wy = start.pose.position.y;
+
+    unsigned int start_x_i, start_y_i;
+    double start_x, start_y;
+
+    if (!costmap_->worldToMap(wx, wy, start_x_i, start_y_i)) {
+        ROS_WARN(
+                "The robot's start position is off the global costmap. Planning will always fail, are you sure the robot has been properly localized?");
+        return false;
+    }
+    if(old_navfn_behavior_){
+        start_x = start_x_i;
+        start_y = start_y_i;
+    }else{
+        worldToMap(wx, wy, start_x, start_y);
+    }
+
+    int nx = costmap_->getSizeInCellsX(), ny = costmap_->getSizeInCellsY();
+
+    // the goals on the costmap, which are all reached by a single expansion
+    std::vector<double> goal_x(goals.size()), goal_y(goals.size());
+    std::vector<int> goal_cells(goals.size(), -1);
+    batch_goals_.clear();
+    for (unsigned int i = 0; i < goals.size(); i++) {
+        if (tf::resolve(tf_prefix_, goals[i].header.frame_id) != tf::resolve(tf_prefix_, global_frame)) {
+            ROS_ERROR(
+                    "The goal pose passed to this planner must be in the %s frame.  It is instead in the %s frame.", tf::resolve(tf_prefix_, global_frame).c_str(), tf::resolve(tf_prefix_, goals[i].header.frame_id).c_str());
+            continue;
+        }
+
+        unsigned int goal_x_i, goal_y_i;
+        wx = goals[i].pose.position.x;
+        wy = goals[i].pose.position.y;
+        if (!costmap_->worldToMap(wx, wy, goal_x_i, goal_y_i)) {
+            ROS_WARN_THROTTLE(1.0,
+                    "The goal sent to the global planner is off the global costmap. Planning will always fail to this goal.");
+            continue;
+        }
+        if(old_navfn_behavior_){
+            goal_x[i] = goal_x_i;
+            goal_y[i] = goal_y_i;
+        }else{
+            worldToMap(wx, wy, goal_x[i], goal_y[i]);
+        }
+        goal_cells[i] = goal_x_i + nx * goal_y_i;
+        batch_goals_.push_back(goal_cells[i]);
+    }
+    if (batch_goals_.empty())
+        return false;
+
+    //clear the starting cell within the costmap because we know it can't be an obstacle
+    tf::Stamped<tf::Pose> start_pose;
+    tf::poseStampedMsgToTF(start, start_pose);
+    clearRobotCell(start_pose, start_x_i, start_y_i);
+
+    p_calc_->setSize(nx, ny);
+    batch_planner_->setSize(nx, ny);
+    path_maker_->setSize(nx, ny);
+    if (batch_potential_.size() != (size_t) nx * ny) {
+        batch_potential_.resize(nx * ny);
+        workspace_growth_++;
+    }
+    float* potential = &batch_potential_[0];
+
+    outlineMap(costmap_->getCharMap(), nx, ny, costmap_2d::LETHAL_OBSTACLE);
+
+    batch_planner_->calculatePotentials(costmap_->getCharMap(), start_x, start_y, batch_goals_, nx * ny * 2,
+                                        potential);
+
+    // read all the costs before clearing the endpoints of the plans changes the potential
+    bool found_legal = false;
+    for (unsigned int i = 0; i < goals.size(); i++) {
+        if (goal_cells[i] >= 0 && potential[goal_cells[i]] < POT_HIGH) {
+            costs[i] = potential[goal_cells[i]];
+            found_legal = true;
+        }
+    }
+
+    if (plans) {
+        for (unsigned int i = 0; i < goals.size(); i++) {
+            if (costs[i] < 0)
+                continue;
+
+            std::vector<geometry_msgs::PoseStamped>& plan = (*plans)[i];
+            if(!old_navfn_behavior_)
+                batch_planner_->clearEndpoint(costmap_->getCharMap(), potential, goal_cells[i] % nx,
+                                              goal_cells[i] / nx, 2);
+            if (getPlanFromPotential(potential, false, start_x, start_y, goal_x[i], goal_y[i], goals[i], plan)) {
+                geometry_msgs::PoseStamped goal_copy = goals[i];
+                goal_copy.header.stamp = ros::Time::now();
+                plan.push_back(goal_copy);
+            } else {
+                ROS_ERROR("Failed to get a plan from potential when a legal potential was found. This shouldn't happen.");
+            }
+            orientation_filter_->processPath(start, plan);
+        }
+    }
+
+    unsigned int grown = getWorkspaceGrowth() - growth_before;
+    if (grown > 0)
+        ROS_INFO("Planning grew the workspace %u times, %u since initialization", grown, getWorkspaceGrowth());
+    return found_legal;
+}
+
+unsigned int GlobalPlanner::getWorkspaceGrowth() {
+    return workspace_growth_ + planner_->getWorkspaceGrowth() + batch_planner_->getWorkspaceGrowth() +
+           path_maker_->getWorkspaceGrowth();
+}
+
 void GlobalPlanner::publishPlan(const std::vector<geometry_msgs::PoseStamped>& path) {
     if (!initialized_) {
         ROS_ERROR(
@@ -333,6 +558,9 @@ void GlobalPlanner::publishPlan(const std::vector<geometry_msgs::PoseStamped>& p
         return;
     }
 
+    if (plan_pub_.getNumSubscribers() == 0)
+        return;
+
     //create a message for the plan
     nav_msgs::Path gui_path;
     gui_path.poses.resize(path.size());
@@ -353,6 +581,13 @@ void GlobalPlanner::publishPlan(const std::vector<geometry_msgs::PoseStamped>& p
 bool GlobalPlanner::getPlanFromPotential(double start_x, double start_y, double goal_x, double goal_y,
                                       const geometry_msgs::PoseStamped& goal,
                                        std::vector<geometry_msgs::PoseStamped>& plan) {
+    return getPlanFromPotential(potential_array_, planner_->expandsFromGoal(), start_x, start_y, goal_x, goal_y, goal,
+                                plan);
+}
+
+bool GlobalPlanner::getPlanFromPotential(float* potential, bool from_goal, double start_x, double start_y,
+                                         double goal_x, double goal_y, const geometry_msgs::PoseStamped& goal,
+                                         std::vector<geometry_msgs::PoseStamped>& plan) {
     if (!initialized_) {
         ROS_ERROR(
                 "This planner has not been initialized yet, but it is being used, please call initialize() before use");
@@ -364,16 +599,27 @@ bool GlobalPlanner::getPlanFromPotential(double start_x, double start_y, double
     //clear the plan, just in case
     plan.clear();
 
-    std::vector<std::pair<float, float> > path;
-
-    if (!path_maker_->getPath(potential_array_, start_x, start_y, goal_x, goal_y, path)) {
+    std::vector<std::pair<float, float> >& path = path_;
+    path.clear();
+    size_t capacity = path.capacity();
+
+    // trace down the potential to the end it was expanded from
+    bool found;
+    if (from_goal)
+        found = path_maker_->getPath(potential, goal_x, goal_y, start_x, start_y, path);
+    else
+        found = path_maker_->getPath(potential, start_x, start_y, goal_x, goal_y, path);
+    if (path.capacity() != capacity)
+        workspace_growth_++;
+    if (!found) {
         ROS_ERROR("NO PATH!");
         return false;
     }
+    plan.reserve(path.size() + 2);
 
     ros::Time plan_time = ros::Time::now();
-    for (int i = path.size() -1; i>=0; i--) {
-        std::pair<float, float> point = path[i];
+    for (int k = 0; k < (int) path.size(); k++) {
+        std::pair<float, float> point = path[from_goal ? k : path.size() - 1 - k];
         //convert the plan to world coordinates
         double world_x, world_y;
         mapToWorld(point.first, point.second, world_x, world_y);
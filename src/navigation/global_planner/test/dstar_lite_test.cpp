@@ -0,0 +1,142 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2013, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of Willow Garage, Inc. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+#include <gtest/gtest.h>
+#include <global_planner/dijkstra.h>
+#include <global_planner/dstar_lite.h>
+#include <costmap_2d/cost_values.h>
+#include <cstdlib>
+#include <vector>
+
+using namespace global_planner;
+
+static const int NX = 60, NY = 50;
+
+// Random costs behind a wall with two doors, outlined with obstacles as GlobalPlanner does
+std::vector<unsigned char> makeCosts()
+{
+    std::vector<unsigned char> costs(NX * NY);
+    srand(42);
+    for (int i = 0; i < NX * NY; i++)
+        costs[i] = rand() % 40;
+    for (int y = 0; y < NY; y++)
+        if (y != 8 && y != 40)
+            costs[30 + y * NX] = costmap_2d::LETHAL_OBSTACLE;
+    for (int x = 0; x < NX; x++)
+        costs[x] = costs[x + (NY - 1) * NX] = costmap_2d::LETHAL_OBSTACLE;
+    for (int y = 0; y < NY; y++)
+        costs[y * NX] = costs[NX - 1 + y * NX] = costmap_2d::LETHAL_OBSTACLE;
+    return costs;
+}
+
+class DStarLiteTest : public testing::Test {
+    protected:
+        DStarLiteTest() :
+                calc_(NX, NY), dstar_(&calc_, NX, NY), dijkstra_(&calc_, NX, NY), costs_(makeCosts()),
+                potential_(NX * NY), expected_(NX * NY), goal_x_(50), goal_y_(25) {
+            dijkstra_.setSize(NX, NY);
+        }
+
+        // Plans with D* Lite, then checks it against a Dijkstra expansion from the goal run to
+        // exhaustion, which gives the exact cost to the goal of every cell
+        void planAndCompare(int start_x, int start_y) {
+            bool found = dstar_.calculatePotentials(&costs_[0], start_x, start_y, goal_x_, goal_y_, NX * NY * 2,
+                                                    &potential_[0]);
+            // the border is lethal, so the expansion never reaches its end
+            dijkstra_.calculatePotentials(&costs_[0], goal_x_, goal_y_, 0, 0, NX * NY * 2, &expected_[0]);
+
+            int start = start_x + start_y * NX;
+            ASSERT_EQ(expected_[start] < POT_HIGH, found);
+            if (!found) {
+                EXPECT_GE(potential_[start], POT_HIGH);
+                return;
+            }
+
+            // the cost of the plan, and the potentials it is traced down
+            EXPECT_EQ(expected_[start], potential_[start]);
+            for (int i = 0; i < NX * NY; i++) {
+                if (expected_[i] < expected_[start]) {
+                    EXPECT_EQ(expected_[i], potential_[i]) << "at " << i % NX << ", " << i / NX;
+                }
+            }
+        }
+
+        void setCosts(int x0, int y0, int x1, int y1, unsigned char cost) {
+            for (int y = y0; y < y1; y++)
+                for (int x = x0; x < x1; x++)
+                    costs_[x + y * NX] = cost;
+        }
+
+        PotentialCalculator calc_;
+        DStarLiteExpansion dstar_;
+        DijkstraExpansion dijkstra_;
+        std::vector<unsigned char> costs_;
+        std::vector<float> potential_, expected_;
+        int goal_x_, goal_y_;
+};
+
+TEST_F(DStarLiteTest, raisedCosts)
+{
+    planAndCompare(5, 10);
+    setCosts(25, 5, 35, 12, 200);
+    planAndCompare(8, 12);
+    setCosts(29, 38, 32, 43, costmap_2d::LETHAL_OBSTACLE);
+    planAndCompare(12, 30);
+}
+
+TEST_F(DStarLiteTest, loweredCosts)
+{
+    setCosts(29, 38, 32, 43, costmap_2d::LETHAL_OBSTACLE);
+    setCosts(10, 20, 25, 30, 120);
+    planAndCompare(5, 45);
+    setCosts(29, 38, 32, 43, 0);
+    planAndCompare(6, 44);
+    setCosts(10, 20, 25, 30, 0);
+    planAndCompare(15, 25);
+}
+
+TEST_F(DStarLiteTest, lethalStart)
+{
+    planAndCompare(5, 10);
+    costs_[10 + 12 * NX] = costmap_2d::LETHAL_OBSTACLE;
+    planAndCompare(10, 12);
+    costs_[10 + 12 * NX] = 0;
+    planAndCompare(10, 12);
+}
+
+int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,166 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2013, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of Willow Garage, Inc. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+#include <gtest/gtest.h>
+#include <global_planner/dijkstra.h>
+#include <global_planner/hierarchical.h>
+#include <costmap_2d/cost_values.h>
+#include <cstdlib>
+#include <vector>
+
+using namespace global_planner;
+
+static const int NX = 100, NY = 80, CLUSTER_SIZE = 16;
+
+// how much more the refined plan may cost than the cheapest one
+static const float COST_BOUND = 1.25;
+
+// Random costs with a few walls, outlined with obstacles as GlobalPlanner does
+std::vector<unsigned char> makeCosts()
+{
+    std::vector<unsigned char> costs(NX * NY);
+    srand(7);
+    for (int i = 0; i < NX * NY; i++)
+        costs[i] = rand() % 10 == 0 ? costmap_2d::LETHAL_OBSTACLE : rand() % 40;
+    for (int y = 5; y < NY; y++)
+        costs[40 + y * NX] = costmap_2d::LETHAL_OBSTACLE;
+    for (int x = 20; x < 90; x++)
+        costs[x + 50 * NX] = costmap_2d::LETHAL_OBSTACLE;
+    for (int x = 0; x < NX; x++)
+        costs[x] = costs[x + (NY - 1) * NX] = costmap_2d::LETHAL_OBSTACLE;
+    for (int y = 0; y < NY; y++)
+        costs[y * NX] = costs[NX - 1 + y * NX] = costmap_2d::LETHAL_OBSTACLE;
+    return costs;
+}
+
+class HierarchicalTest : public testing::Test {
+    protected:
+        HierarchicalTest() :
+                calc_(NX, NY), hpa_(&calc_, NX, NY, CLUSTER_SIZE), dijkstra_(&calc_, NX, NY), costs_(makeCosts()),
+                potential_(NX * NY), expected_(NX * NY) {
+            // the abstraction costs a step as the cost of the cell it enters plus the neutral cost
+            dijkstra_.setFactor(1.0);
+            dijkstra_.setSize(NX, NY);
+        }
+
+        // The cheapest cost from the start to the goal, POT_HIGH if there is no path
+        float cheapestCost(int start_x, int start_y, int goal_x, int goal_y) {
+            // the border is lethal, so the expansion never reaches its end
+            dijkstra_.calculatePotentials(&costs_[0], start_x, start_y, 0, 0, NX * NY * 2, &expected_[0]);
+            return expected_[goal_x + goal_y * NX];
+        }
+
+        bool plan(int start_x, int start_y, int goal_x, int goal_y) {
+            costs_[start_x + start_y * NX] = costs_[goal_x + goal_y * NX] = 0;
+            return hpa_.calculatePotentials(&costs_[0], start_x, start_y, goal_x, goal_y, NX * NY * 2, &potential_[0]);
+        }
+
+        void setCosts(int x0, int y0, int x1, int y1, unsigned char cost) {
+            for (int y = y0; y < y1; y++)
+                for (int x = x0; x < x1; x++)
+                    costs_[x + y * NX] = cost;
+        }
+
+        PotentialCalculator calc_;
+        HierarchicalExpansion hpa_;
+        DijkstraExpansion dijkstra_;
+        std::vector<unsigned char> costs_;
+        std::vector<float> potential_, expected_;
+};
+
+TEST_F(HierarchicalTest, refinedCostIsBounded)
+{
+    int plans[][4] = { { 5, 5, 90, 70 }, { 90, 70, 5, 5 }, { 30, 60, 60, 60 }, { 10, 40, 20, 45 },
+                       { 45, 10, 45, 70 }, { 3, 75, 95, 3 } };
+    for (unsigned int k = 0; k < sizeof(plans) / sizeof(plans[0]); k++) {
+        int* p = plans[k];
+        ASSERT_TRUE(plan(p[0], p[1], p[2], p[3])) << "plan " << k;
+        float cheapest = cheapestCost(p[0], p[1], p[2], p[3]);
+        float cost = potential_[p[2] + p[3] * NX];
+        EXPECT_GE(cost, cheapest) << "plan " << k;
+        EXPECT_LE(cost, cheapest * COST_BOUND) << "plan " << k;
+    }
+}
+
+TEST_F(HierarchicalTest, wholeMapFallback)
+{
+    // a goal the abstraction reaches, but the refinement can't enter, takes the fallback over
+    // the whole map, which has to fail the same way
+    ASSERT_TRUE(plan(5, 5, 90, 70));
+    costs_[90 + 70 * NX] = costmap_2d::LETHAL_OBSTACLE;
+    EXPECT_FALSE(hpa_.calculatePotentials(&costs_[0], 5, 5, 90, 70, NX * NY * 2, &potential_[0]));
+    EXPECT_GE(cheapestCost(5, 5, 90, 70), POT_HIGH);
+
+    // a goal walled off has no abstract path either
+    setCosts(80, 60, 99, 61, costmap_2d::LETHAL_OBSTACLE);
+    setCosts(80, 60, 81, 80, costmap_2d::LETHAL_OBSTACLE);
+    EXPECT_FALSE(plan(5, 5, 90, 70));
+    EXPECT_GE(cheapestCost(5, 5, 90, 70), POT_HIGH);
+
+    // and is planned to as soon as a door opens
+    costs_[80 + 75 * NX] = 0;
+    ASSERT_TRUE(plan(5, 5, 90, 70));
+    float cheapest = cheapestCost(5, 5, 90, 70);
+    ASSERT_LT(cheapest, POT_HIGH);
+    EXPECT_LE(potential_[90 + 70 * NX], cheapest * COST_BOUND);
+}
+
+TEST_F(HierarchicalTest, editedClusterMatchesFreshAbstraction)
+{
+    ASSERT_TRUE(plan(5, 5, 90, 70));
+
+    // costs changed inside a single cluster: a door opens in the wall, behind new obstacles
+    setCosts(36, 58, 45, 63, 20);
+    setCosts(40, 59, 41, 62, 0);
+    setCosts(36, 55, 45, 56, costmap_2d::LETHAL_OBSTACLE);
+
+    int plans[][4] = { { 5, 5, 90, 70 }, { 10, 60, 60, 60 }, { 35, 52, 45, 40 } };
+    for (unsigned int k = 0; k < sizeof(plans) / sizeof(plans[0]); k++) {
+        int* p = plans[k];
+        bool found = plan(p[0], p[1], p[2], p[3]);
+
+        HierarchicalExpansion fresh(&calc_, NX, NY, CLUSTER_SIZE);
+        std::vector<float> fresh_potential(NX * NY);
+        ASSERT_EQ(fresh.calculatePotentials(&costs_[0], p[0], p[1], p[2], p[3], NX * NY * 2, &fresh_potential[0]),
+                  found) << "plan " << k;
+        for (int i = 0; i < NX * NY; i++)
+            ASSERT_EQ(fresh_potential[i], potential_[i]) << "plan " << k << " at " << i % NX << ", " << i / NX;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
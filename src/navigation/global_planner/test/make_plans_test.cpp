@@ -0,0 +1,158 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2013, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of Willow Garage, Inc. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+#include <global_planner/planner_core.h>
+#include <costmap_2d/costmap_2d.h>
+#include <costmap_2d/cost_values.h>
+#include <gtest/gtest.h>
+#include <ros/ros.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+using namespace global_planner;
+
+static const double RESOLUTION = 0.1;
+
+geometry_msgs::PoseStamped makePose(double x, double y)
+{
+    geometry_msgs::PoseStamped pose;
+    pose.header.frame_id = "map";
+    pose.pose.position.x = x;
+    pose.pose.position.y = y;
+    pose.pose.orientation.w = 1.0;
+    return pose;
+}
+
+// A wall with a ramp of costs along it, and a room with no door
+void makeCosts(costmap_2d::Costmap2D& costmap)
+{
+    for (unsigned int y = 0; y < 70; y++) {
+        for (unsigned int x = 44; x < 56; x++) {
+            int distance = std::min(abs((int) x - 49), abs((int) x - 50));
+            costmap.setCost(x, y, std::max(0, 200 - 40 * distance));
+        }
+    }
+    for (unsigned int y = 0; y < 60; y++)
+        for (unsigned int x = 48; x < 52; x++)
+            costmap.setCost(x, y, costmap_2d::LETHAL_OBSTACLE);
+    for (unsigned int x = 75; x < 95; x++) {
+        costmap.setCost(x, 10, costmap_2d::LETHAL_OBSTACLE);
+        costmap.setCost(x, 25, costmap_2d::LETHAL_OBSTACLE);
+    }
+    for (unsigned int y = 10; y < 26; y++) {
+        costmap.setCost(75, y, costmap_2d::LETHAL_OBSTACLE);
+        costmap.setCost(94, y, costmap_2d::LETHAL_OBSTACLE);
+    }
+}
+
+TEST(GlobalPlanner, makePlansMatchesMakePlan)
+{
+    costmap_2d::Costmap2D costmap(100, 80, RESOLUTION, 0.0, 0.0, costmap_2d::FREE_SPACE);
+    makeCosts(costmap);
+    GlobalPlanner planner("planner", &costmap, "map");
+
+    geometry_msgs::PoseStamped start = makePose(1.05, 1.05);
+    std::vector<geometry_msgs::PoseStamped> goals;
+    goals.push_back(makePose(9.05, 7.05));
+    goals.push_back(makePose(7.05, 1.55));
+    goals.push_back(makePose(2.05, 7.55));
+    goals.push_back(makePose(4.55, 4.55));
+    goals.push_back(makePose(8.55, 1.75)); // in the room
+    goals.push_back(makePose(3.05, 0.55));
+
+    std::vector<double> costs;
+    std::vector<std::vector<geometry_msgs::PoseStamped> > plans;
+    ASSERT_TRUE(planner.makePlans(start, goals, costs, &plans));
+    ASSERT_EQ(goals.size(), costs.size());
+    ASSERT_EQ(goals.size(), plans.size());
+
+    for (unsigned int i = 0; i < goals.size(); i++) {
+        std::vector<geometry_msgs::PoseStamped> plan;
+        bool found = planner.makePlan(start, goals[i], plan);
+        EXPECT_EQ(found, costs[i] >= 0) << "goal " << i;
+        EXPECT_EQ(found, !plans[i].empty()) << "goal " << i;
+        if (!found)
+            continue;
+
+        // both end on the goal, and trace down the same potentials but for the cells around the
+        // goal which a single expansion stops short of
+        EXPECT_GT(costs[i], 0.0);
+        EXPECT_EQ(plan.back().pose.position.x, plans[i].back().pose.position.x) << "goal " << i;
+        EXPECT_EQ(plan.back().pose.position.y, plans[i].back().pose.position.y) << "goal " << i;
+        EXPECT_NEAR(plan.size(), plans[i].size(), 2) << "goal " << i;
+        for (unsigned int k = 0; k < plans[i].size(); k++) {
+            const geometry_msgs::Point& p = plans[i][k].pose.position;
+            double nearest = HUGE_VAL;
+            for (unsigned int j = 0; j < plan.size(); j++)
+                nearest = std::min(nearest, hypot(plan[j].pose.position.x - p.x, plan[j].pose.position.y - p.y));
+            EXPECT_LT(nearest, RESOLUTION) << "goal " << i << " pose " << k;
+        }
+    }
+    EXPECT_EQ(-1.0, costs[4]);
+    EXPECT_TRUE(plans[4].empty());
+}
+
+TEST(GlobalPlanner, replanningReusesWorkspace)
+{
+    costmap_2d::Costmap2D costmap(100, 80, RESOLUTION, 0.0, 0.0, costmap_2d::FREE_SPACE);
+    makeCosts(costmap);
+    GlobalPlanner planner("planner", &costmap, "map");
+
+    geometry_msgs::PoseStamped start = makePose(1.05, 1.05);
+    std::vector<geometry_msgs::PoseStamped> goals;
+    goals.push_back(makePose(9.05, 7.05));
+    goals.push_back(makePose(2.05, 7.55));
+
+    std::vector<geometry_msgs::PoseStamped> plan;
+    std::vector<double> costs;
+    std::vector<std::vector<geometry_msgs::PoseStamped> > plans;
+    for (unsigned int i = 0; i < goals.size(); i++)
+        ASSERT_TRUE(planner.makePlan(start, goals[i], plan));
+    ASSERT_TRUE(planner.makePlans(start, goals, costs, &plans));
+    unsigned int growth = planner.getWorkspaceGrowth();
+    EXPECT_GT(growth, 0u);
+
+    // the same plans again fit in the workspace as it is
+    for (unsigned int i = 0; i < goals.size(); i++)
+        ASSERT_TRUE(planner.makePlan(start, goals[i], plan));
+    ASSERT_TRUE(planner.makePlans(start, goals, costs, &plans));
+    EXPECT_EQ(growth, planner.getWorkspaceGrowth());
+}
+
+int main(int argc, char** argv){
+    ros::init(argc, argv, "make_plans_test");
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,144 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2009, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of Willow Garage, Inc. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+#include <global_planner/astar.h>
+#include <global_planner/bucket_astar.h>
+#include <global_planner/dijkstra.h>
+#include <global_planner/quadratic_calculator.h>
+#include <costmap_2d/cost_values.h>
+#include <ros/package.h>
+#include <ros/ros.h>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+/**
+ * Measures how many cells per second the expanders of the global planner
+ * expand when planning between random free cells of the willow costmap
+ * used by the navfn tests. The map may also be given as the first argument.
+ */
+
+using namespace global_planner;
+
+static bool readCostmap(const std::string& path, std::vector<unsigned char>& costs, int& nx, int& ny)
+{
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file)
+        return false;
+    int maxval;
+    bool ok = fscanf(file, "P5 %d %d %d", &nx, &ny, &maxval) == 3 && maxval < 256 && fgetc(file) != EOF;
+    if (ok)
+    {
+        costs.resize(nx * ny);
+        ok = fread(&costs[0], 1, costs.size(), file) == costs.size();
+    }
+    fclose(file);
+    return ok;
+}
+
+static void plan(Expander& expander, std::vector<unsigned char>& costs, std::vector<float>& potential,
+                 const std::vector<int>& cells, int nx, const char* name)
+{
+    // the first plan only sizes the buffers of the expander
+    int cycles = potential.size() * 2;
+    expander.calculatePotentials(&costs[0], cells[0] % nx, cells[0] / nx, cells[1] % nx, cells[1] / nx, cycles,
+                                 &potential[0]);
+
+    int plans = 0, found = 0;
+    double expansions = 0.0;
+    ros::WallTime start = ros::WallTime::now();
+    for (unsigned int k = 0; k + 1 < cells.size(); k += 2, ++plans)
+    {
+        int s = cells[k], g = cells[k + 1];
+        if (expander.calculatePotentials(&costs[0], s % nx, s / nx, g % nx, g / nx, cycles, &potential[0]))
+            ++found;
+        expansions += expander.getCellsVisited();
+    }
+    double time = (ros::WallTime::now() - start).toSec();
+    printf("%-12s %d/%d plans found, %.1f plans/s, %.2f Mexpansions/s\n", name, found, plans, plans / time,
+           expansions / time / 1e6);
+}
+
+int main(int argc, char** argv)
+{
+    std::string path = argc > 1 ? argv[1] : ros::package::getPath("navfn") + "/test/willow_costmap.pgm";
+    std::vector<unsigned char> costs;
+    int nx, ny;
+    if (!readCostmap(path, costs, nx, ny))
+    {
+        printf("Can't read costmap %s\n", path.c_str());
+        return 1;
+    }
+
+    // as in GlobalPlanner::outlineMap()
+    for (int x = 0; x < nx; x++)
+        costs[x] = costs[(ny - 1) * nx + x] = costmap_2d::LETHAL_OBSTACLE;
+    for (int y = 0; y < ny; y++)
+        costs[y * nx] = costs[y * nx + nx - 1] = costmap_2d::LETHAL_OBSTACLE;
+
+    std::vector<int> free_cells;
+    for (int i = 0; i < nx * ny; i++)
+        if (costs[i] < costmap_2d::INSCRIBED_INFLATED_OBSTACLE)
+            free_cells.push_back(i);
+
+    srand(0);
+    std::vector<int> cells;
+    for (int k = 0; k < 200; k++)
+        cells.push_back(free_cells[rand() % free_cells.size()]);
+    printf("%d x %d costmap, %d free cells, %d plans\n", nx, ny, (int) free_cells.size(), (int) cells.size() / 2);
+
+    std::vector<float> potential(nx * ny);
+    const char* calculators[] = { "linear", "quadratic" };
+    for (int quadratic = 0; quadratic < 2; ++quadratic)
+    {
+        PotentialCalculator* p_calc = quadratic ? new QuadraticCalculator(nx, ny) : new PotentialCalculator(nx, ny);
+        printf("%s potential:\n", calculators[quadratic]);
+
+        // as in GlobalPlanner::makePlan(), which sizes the expander before every plan
+        AStarExpansion astar(p_calc, nx, ny);
+        astar.setSize(nx, ny);
+        plan(astar, costs, potential, cells, nx, "AStar");
+        BucketAStarExpansion bucket_astar(p_calc, nx, ny);
+        bucket_astar.setSize(nx, ny);
+        plan(bucket_astar, costs, potential, cells, nx, "BucketAStar");
+        DijkstraExpansion dijkstra(p_calc, nx, ny);
+        dijkstra.setSize(nx, ny);
+        plan(dijkstra, costs, potential, cells, nx, "Dijkstra");
+
+        delete p_calc;
+    }
+
+    return 0;
+}
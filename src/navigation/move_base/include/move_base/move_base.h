@@ -194,6 +194,7 @@ namespace move_base {
       ros::Subscriber goal_sub_;
       ros::ServiceServer make_plan_srv_, clear_costmaps_srv_;
       bool shutdown_costmaps_, clearing_rotation_allowed_, recovery_behavior_enabled_;
+      bool planner_uses_costmap_snapshot_;
       double oscillation_timeout_, oscillation_distance_;
 
       MoveBaseState state_;
@@ -107,6 +107,9 @@ namespace move_base {
     private_nh.param("clearing_rotation_allowed", clearing_rotation_allowed_, true);
     private_nh.param("recovery_behavior_enabled", recovery_behavior_enabled_, true);
 
+    //global planners that plan on snapshots of the costmap don't need it locked while they plan
+    private_nh.param("planner_uses_costmap_snapshot", planner_uses_costmap_snapshot_, false);
+
     //create the ros wrapper for the planner's costmap... and initializer a pointer we'll use with the underlying map
     planner_costmap_ros_ = new costmap_2d::Costmap2DROS("global_costmap", tf_);
     planner_costmap_ros_->pause();
@@ -296,6 +299,7 @@ namespace move_base {
     clear_poly.push_back(pt);
 
     planner_costmap_ros_->getCostmap()->setConvexPolygonCost(clear_poly, costmap_2d::FREE_SPACE);
+    planner_costmap_ros_->getLayeredCostmap()->invalidateSnapshot();
 
     //clear the controller's costmap
     controller_costmap_ros_->getRobotPose(global_pose);
@@ -321,6 +325,7 @@ namespace move_base {
     clear_poly.push_back(pt);
 
     controller_costmap_ros_->getCostmap()->setConvexPolygonCost(clear_poly, costmap_2d::FREE_SPACE);
+    controller_costmap_ros_->getLayeredCostmap()->invalidateSnapshot();
   }
 
   bool MoveBase::clearCostmapsService(std_srvs::Empty::Request &req, std_srvs::Empty::Response &resp){
@@ -447,7 +452,9 @@ namespace move_base {
   }
 
   bool MoveBase::makePlan(const geometry_msgs::PoseStamped& goal, std::vector<geometry_msgs::PoseStamped>& plan){
-    boost::unique_lock<costmap_2d::Costmap2D::mutex_t> lock(*(planner_costmap_ros_->getCostmap()->getMutex()));
+    boost::unique_lock<costmap_2d::Costmap2D::mutex_t> lock(*(planner_costmap_ros_->getCostmap()->getMutex()), boost::defer_lock);
+    if(!planner_uses_costmap_snapshot_)
+      lock.lock();
 
     //make sure to set the plan to be empty initially
     plan.clear();
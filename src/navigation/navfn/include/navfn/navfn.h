@@ -45,6 +45,7 @@
 #include <stdint.h>
 #include <string.h>
 #include <stdio.h>
+#include <vector>
 
 // cost defs
 #define COST_UNKNOWN_ROS 255		// 255 is unknown cost
@@ -131,6 +132,21 @@ positions at about 1/2 cell resolution; else returns 0.
        */
       void setCostmap(const COSTTYPE *cmap, bool isROS=true, bool allow_unknown = true); /**< sets up the cost map */
 
+      /**
+       * @brief  Set up the cost array from a ROS costmap, translating only the rows that changed since the last call
+       * @param cmap The costmap
+       * @param allow_unknown Whether or not the planner should be allowed to plan through unknown space
+       *
+       * The cost array must not have been written to since the last call, other than through clearCell().
+       */
+      void updateCostmap(const COSTTYPE *cmap, bool allow_unknown = true);
+
+      /**
+       * @brief  Set a cell of the cost array to free space until the next updateCostmap()
+       * @param n The index of the cell
+       */
+      void clearCell(int n);
+
       /**
        * @brief  Calculates a plan using the A* heuristic, returns true if one is found
        * @return True if a plan is found, false otherwise
@@ -170,6 +186,9 @@ positions at about 1/2 cell resolution; else returns 0.
       COSTTYPE *costarr;		/**< cost array in 2D configuration space */
       float   *potarr;		/**< potential array, navigation function potential */
       bool    *pending;		/**< pending cells during propagation */
+      COSTTYPE *lastcmap;		/**< the costmap the cost array was last translated from by updateCostmap() */
+      bool lastAllowUnknown;	/**< allow_unknown of that translation */
+      std::vector<int> clearedCells; /**< cells set to free space by clearCell() since then */
       int nobs;			/**< number of obstacle cells */
 
       /** block priority buffers */
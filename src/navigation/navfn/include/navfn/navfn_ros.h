@@ -164,6 +164,13 @@ namespace navfn {
 
       void mapToWorld(double mx, double my, double& wx, double& wy);
       void clearRobotCell(const tf::Stamped<tf::Pose>& global_pose, unsigned int mx, unsigned int my);
+
+      /**
+       * @brief  The snapshot of the costmap the potential was last computed on, or the costmap itself before that
+       */
+      const costmap_2d::Costmap2D* getPlanningCostmap();
+
+      boost::shared_ptr<const costmap_2d::Costmap2D> costmap_snapshot_;
       double planner_window_x_, planner_window_y_, default_tolerance_;
       std::string tf_prefix_;
       boost::mutex mutex_;
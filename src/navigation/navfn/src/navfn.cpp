@@ -45,6 +45,9 @@
 
 #include <navfn/navfn.h>
 #include <ros/console.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 namespace navfn {
 
@@ -114,6 +117,8 @@ namespace navfn {
     potarr = NULL;
     pending = NULL;
     gradx = grady = NULL;
+    lastcmap = NULL;
+    lastAllowUnknown = true;
     setNavArr(xs,ys);
 
     // priority buffers
@@ -152,6 +157,8 @@ namespace navfn {
       delete[] gradx;
     if(grady)
       delete[] grady;
+    if(lastcmap)
+      delete[] lastcmap;
     if(pathx)
       delete[] pathx;
     if(pathy)
@@ -210,6 +217,12 @@ namespace navfn {
       if(grady)
         delete[] grady;
 
+      // the next updateCostmap() translates the whole map
+      if(lastcmap)
+        delete[] lastcmap;
+      lastcmap = NULL;
+      clearedCells.clear();
+
       costarr = new COSTTYPE[ns]; // cost array, 2d config space
       memset(costarr, 0, ns*sizeof(COSTTYPE));
       potarr = new float[ns];	// navigation potential array
@@ -220,6 +233,65 @@ namespace navfn {
     }
 
 
+  //
+  // translate <n> ROS costs into cost array values:
+  // COST_OBS                 -> COST_OBS (incoming "lethal obstacle")
+  // COST_OBS_ROS             -> COST_OBS (incoming "inscribed inflated obstacle")
+  // COST_UNKNOWN_ROS         -> COST_OBS-1 if allowed, else COST_OBS
+  // values in range 0 to 252 -> values from COST_NEUTRAL to COST_OBS_ROS.
+  //
+
+  static void
+    translateCosts(const COSTTYPE *cmap, COSTTYPE *cm, int n, bool allow_unknown)
+    {
+      int k = 0;
+#if defined(__SSE2__)
+      // 16 cells at a time, (int)(COST_NEUTRAL+COST_FACTOR*v) is exactly COST_NEUTRAL+(4*v)/5
+      if (sizeof(COSTTYPE) == 1 && COST_NEUTRAL == 50 && COST_FACTOR == 0.8)
+      {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i fifth = _mm_set1_epi16(52429); // (x*52429)>>18 == x/5 for x < 2^16/4
+        const __m128i neutral = _mm_set1_epi16(COST_NEUTRAL);
+        const __m128i free_max = _mm_set1_epi8((char)(COST_OBS_ROS-1));
+        const __m128i unknown = _mm_set1_epi8((char)COST_UNKNOWN_ROS);
+        const __m128i obs = _mm_set1_epi8((char)COST_OBS);
+        const __m128i unknown_cost = _mm_set1_epi8((char)(allow_unknown ? COST_OBS-1 : COST_OBS));
+        for (; k+16 <= n; k += 16)
+        {
+          __m128i v = _mm_loadu_si128((const __m128i *)(cmap+k));
+          __m128i lo = _mm_slli_epi16(_mm_unpacklo_epi8(v, zero), 2);
+          __m128i hi = _mm_slli_epi16(_mm_unpackhi_epi8(v, zero), 2);
+          lo = _mm_add_epi16(_mm_srli_epi16(_mm_mulhi_epu16(lo, fifth), 2), neutral);
+          hi = _mm_add_epi16(_mm_srli_epi16(_mm_mulhi_epu16(hi, fifth), 2), neutral);
+          __m128i scaled = _mm_packus_epi16(lo, hi);
+          __m128i is_free = _mm_cmpeq_epi8(_mm_min_epu8(v, free_max), v);
+          __m128i is_unknown = _mm_cmpeq_epi8(v, unknown);
+          __m128i out = _mm_or_si128(_mm_and_si128(is_unknown, unknown_cost), _mm_andnot_si128(is_unknown, obs));
+          out = _mm_or_si128(_mm_and_si128(is_free, scaled), _mm_andnot_si128(is_free, out));
+          _mm_storeu_si128((__m128i *)(cm+k), out);
+        }
+      }
+#endif
+      for (; k<n; k++)
+      {
+        int v = cmap[k];
+        cm[k] = COST_OBS;
+        if (v < COST_OBS_ROS)
+        {
+          v = COST_NEUTRAL+COST_FACTOR*v;
+          if (v >= COST_OBS)
+            v = COST_OBS-1;
+          cm[k] = v;
+        }
+        else if(v == COST_UNKNOWN_ROS && allow_unknown)
+        {
+          v = COST_OBS-1;
+          cm[k] = v;
+        }
+      }
+    }
+
+
   //
   // set up cost array, usually from ROS
   //
@@ -230,31 +302,13 @@ namespace navfn {
       COSTTYPE *cm = costarr;
       if (isROS)			// ROS-type cost array
       {
-        for (int i=0; i<ny; i++)
-        {
-          int k=i*nx;
-          for (int j=0; j<nx; j++, k++, cmap++, cm++)
-          {
-            // This transforms the incoming cost values:
-            // COST_OBS                 -> COST_OBS (incoming "lethal obstacle")
-            // COST_OBS_ROS             -> COST_OBS (incoming "inscribed inflated obstacle")
-            // values in range 0 to 252 -> values from COST_NEUTRAL to COST_OBS_ROS.
-            *cm = COST_OBS;
-            int v = *cmap;
-            if (v < COST_OBS_ROS)
-            {
-              v = COST_NEUTRAL+COST_FACTOR*v;
-              if (v >= COST_OBS)
-                v = COST_OBS-1;
-              *cm = v;
-            }
-            else if(v == COST_UNKNOWN_ROS && allow_unknown)
-            {
-              v = COST_OBS-1;
-              *cm = v;
-            }
-          }
-        }
+        translateCosts(cmap, cm, ns, allow_unknown);
+
+        // the cost array no longer matches the costmap kept by updateCostmap()
+        if (lastcmap)
+          delete[] lastcmap;
+        lastcmap = NULL;
+        clearedCells.clear();
       }
 
       else				// not a ROS map, just a PGM
@@ -286,6 +340,55 @@ namespace navfn {
       }
     }
 
+
+  //
+  // set up cost array from a ROS costmap, re-translating only the rows
+  //   that differ from the costmap of the last call
+  //
+
+  void
+    NavFn::updateCostmap(const COSTTYPE *cmap, bool allow_unknown)
+    {
+      if (lastcmap == NULL || allow_unknown != lastAllowUnknown)
+      {
+        if (lastcmap == NULL)
+          lastcmap = new COSTTYPE[ns];
+        memcpy(lastcmap, cmap, ns*sizeof(COSTTYPE));
+        lastAllowUnknown = allow_unknown;
+        clearedCells.clear();
+        translateCosts(cmap, costarr, ns, allow_unknown);
+        return;
+      }
+
+      // cells cleared for the last plan, and the borders set by setupNavFn()
+      for (size_t i=0; i<clearedCells.size(); i++)
+        translateCosts(cmap+clearedCells[i], costarr+clearedCells[i], 1, allow_unknown);
+      clearedCells.clear();
+      translateCosts(cmap, costarr, nx, allow_unknown);
+      translateCosts(cmap+(ny-1)*nx, costarr+(ny-1)*nx, nx, allow_unknown);
+      for (int i=1; i<ny-1; i++)
+      {
+        translateCosts(cmap+i*nx, costarr+i*nx, 1, allow_unknown);
+        translateCosts(cmap+i*nx+nx-1, costarr+i*nx+nx-1, 1, allow_unknown);
+      }
+
+      for (int i=0; i<ny; i++)
+      {
+        int k = i*nx;
+        if (memcmp(cmap+k, lastcmap+k, nx*sizeof(COSTTYPE)) == 0)
+          continue;
+        memcpy(lastcmap+k, cmap+k, nx*sizeof(COSTTYPE));
+        translateCosts(cmap+k, costarr+k, nx, allow_unknown);
+      }
+    }
+
+  void
+    NavFn::clearCell(int n)
+    {
+      costarr[n] = COST_NEUTRAL;
+      clearedCells.push_back(n);
+    }
+
   bool
     NavFn::calcNavFnDijkstra(bool atStart)
     {
@@ -99,7 +99,7 @@ namespace navfn {
       return false;
     }
 
-    double resolution = costmap_ros_->getCostmap()->getResolution();
+    double resolution = getPlanningCostmap()->getResolution();
     geometry_msgs::Point p;
     p = world_point;
 
@@ -127,7 +127,7 @@ namespace navfn {
     }
 
     unsigned int mx, my;
-    if(!costmap_ros_->getCostmap()->worldToMap(world_point.x, world_point.y, mx, my))
+    if(!getPlanningCostmap()->worldToMap(world_point.x, world_point.y, mx, my))
       return DBL_MAX;
 
     unsigned int index = my * planner_->nx + mx;
@@ -140,11 +140,14 @@ namespace navfn {
       return false;
     }
     
-    costmap_2d::Costmap2D* costmap = costmap_ros_->getCostmap();
+    // the costmap as of its last update, so that computing the potential does not hold up updates
+    costmap_snapshot_ = costmap_ros_->getCostmapSnapshot();
+    const costmap_2d::Costmap2D* costmap = costmap_snapshot_.get();
 
-    //make sure to resize the underlying array that Navfn uses
-    planner_->setNavArr(costmap->getSizeInCellsX(), costmap->getSizeInCellsY());
-    planner_->setCostmap(costmap->getCharMap(), true, allow_unknown_);
+    //make sure to resize the underlying array that Navfn uses, only the rows that changed since the last plan are translated
+    if(planner_->nx != (int)costmap->getSizeInCellsX() || planner_->ny != (int)costmap->getSizeInCellsY())
+      planner_->setNavArr(costmap->getSizeInCellsX(), costmap->getSizeInCellsY());
+    planner_->updateCostmap(costmap->getCharMap(), allow_unknown_);
 
     unsigned int mx, my;
     if(!costmap->worldToMap(world_point.x, world_point.y, mx, my))
@@ -170,8 +173,14 @@ namespace navfn {
       return;
     }
 
-    //set the associated costs in the cost map to be free
-    costmap_ros_->getCostmap()->setCost(mx, my, costmap_2d::FREE_SPACE);
+    //set the associated cost in navfn's copy of the cost map to that of free space, the snapshot is shared
+    planner_->clearCell(my * planner_->nx + mx);
+  }
+
+  const costmap_2d::Costmap2D* NavfnROS::getPlanningCostmap(){
+    if(costmap_snapshot_)
+      return costmap_snapshot_.get();
+    return costmap_ros_->getCostmap();
   }
 
   bool NavfnROS::makePlanService(nav_msgs::GetPlan::Request& req, nav_msgs::GetPlan::Response& resp){
@@ -184,7 +193,7 @@ namespace navfn {
   } 
 
   void NavfnROS::mapToWorld(double mx, double my, double& wx, double& wy) {
-    costmap_2d::Costmap2D* costmap = costmap_ros_->getCostmap();
+    const costmap_2d::Costmap2D* costmap = getPlanningCostmap();
     wx = costmap->getOriginX() + mx * costmap->getResolution();
     wy = costmap->getOriginY() + my * costmap->getResolution();
   }
@@ -206,7 +215,9 @@ namespace navfn {
     plan.clear();
 
     ros::NodeHandle n;
-    costmap_2d::Costmap2D* costmap = costmap_ros_->getCostmap();
+    // plan on the costmap as of its last update, so that planning does not hold up updates
+    costmap_snapshot_ = costmap_ros_->getCostmapSnapshot();
+    const costmap_2d::Costmap2D* costmap = costmap_snapshot_.get();
     std::string global_frame = costmap_ros_->getGlobalFrameID();
 
     //until tf can handle transforming things that are way in the past... we'll require the goal to be in our global frame
@@ -231,11 +242,6 @@ namespace navfn {
       return false;
     }
 
-    //clear the starting cell within the costmap because we know it can't be an obstacle
-    tf::Stamped<tf::Pose> start_pose;
-    tf::poseStampedMsgToTF(start, start_pose);
-    clearRobotCell(start_pose, mx, my);
-
 #if 0
     {
       static int n = 0;
@@ -245,9 +251,15 @@ namespace navfn {
     }
 #endif
 
-    //make sure to resize the underlying array that Navfn uses
-    planner_->setNavArr(costmap->getSizeInCellsX(), costmap->getSizeInCellsY());
-    planner_->setCostmap(costmap->getCharMap(), true, allow_unknown_);
+    //make sure to resize the underlying array that Navfn uses, only the rows that changed since the last plan are translated
+    if(planner_->nx != (int)costmap->getSizeInCellsX() || planner_->ny != (int)costmap->getSizeInCellsY())
+      planner_->setNavArr(costmap->getSizeInCellsX(), costmap->getSizeInCellsY());
+    planner_->updateCostmap(costmap->getCharMap(), allow_unknown_);
+
+    //clear the starting cell within the costmap because we know it can't be an obstacle
+    tf::Stamped<tf::Pose> start_pose;
+    tf::poseStampedMsgToTF(start, start_pose);
+    clearRobotCell(start_pose, mx, my);
 
 #if 0
     {
@@ -385,7 +397,7 @@ namespace navfn {
       return false;
     }
     
-    costmap_2d::Costmap2D* costmap = costmap_ros_->getCostmap();
+    const costmap_2d::Costmap2D* costmap = getPlanningCostmap();
     std::string global_frame = costmap_ros_->getGlobalFrameID();
 
     //clear the plan, just in case
@@ -153,6 +153,80 @@ TEST(PathCalc, easy_nav_should_always_work)
   EXPECT_TRUE( nav->calcNavFnDijkstra( true ));
 }
 
+TEST(PathCalc, update_costmap_matches_set_costmap)
+{
+  int sx = 53, sy = 41;
+  navfn::NavFn inc(sx,sy);
+  navfn::NavFn full(sx,sy);
+
+  // every ROS cost value, and some cells changing between plans
+  COSTTYPE *cmap = new COSTTYPE[sx*sy];
+  for( int i = 0; i < sx*sy; i++ )
+  {
+    cmap[ i ] = (i * 7) & 255;
+  }
+
+  int goal[2] = { sx/2, sy/2 };
+  for( int n = 0; n < 20; n++ )
+  {
+    cmap[ (n * 389) % (sx*sy) ] = (n * 37) & 255;
+    bool allow_unknown = n % 5 != 4;
+
+    inc.updateCostmap( cmap, allow_unknown );
+    full.setCostmap( cmap, true, allow_unknown );
+    inc.clearCell( n * 97 );
+    full.costarr[ n * 97 ] = COST_NEUTRAL;
+    for( int i = 0; i < sx*sy; i++ )
+    {
+      ASSERT_EQ( full.costarr[ i ], inc.costarr[ i ] );
+    }
+
+    // sets the borders of the cost array to obstacles
+    inc.setGoal( goal );
+    inc.setupNavFn( true );
+  }
+  delete[] cmap;
+}
+
+TEST(PathCalc, set_costmap_translates_every_cost)
+{
+  // long enough for every cost value to go through every lane of the vectorized
+  // translation, with a remainder that is translated one cell at a time
+  int sx = 263, sy = 17;
+  navfn::NavFn nav(sx,sy);
+  COSTTYPE *cmap = new COSTTYPE[sx*sy];
+  for( int i = 0; i < sx*sy; i++ )
+  {
+    cmap[ i ] = (i + i / 256) & 255;
+  }
+  for( int v = 0; v < 8; v++ )
+  {
+    cmap[ sx*sy - 1 - v ] = 255 - v;
+  }
+
+  for( int allow_unknown = 0; allow_unknown < 2; allow_unknown++ )
+  {
+    nav.setCostmap( cmap, true, allow_unknown );
+    for( int i = 0; i < sx*sy; i++ )
+    {
+      int v = cmap[ i ];
+      int expected = COST_OBS;
+      if( v < COST_OBS_ROS )
+      {
+        expected = COST_NEUTRAL+COST_FACTOR*v;
+        if( expected >= COST_OBS )
+          expected = COST_OBS-1;
+      }
+      else if( v == COST_UNKNOWN_ROS && allow_unknown )
+      {
+        expected = COST_OBS-1;
+      }
+      ASSERT_EQ( expected, nav.costarr[ i ] ) << "cost " << v << ", allow_unknown " << allow_unknown;
+    }
+  }
+  delete[] cmap;
+}
+
 int main(int argc, char **argv)
 {
   testing::InitGoogleTest(&argc, argv);
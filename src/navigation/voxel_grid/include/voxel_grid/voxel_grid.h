@@ -86,6 +86,9 @@ public:
   void reset();
   uint32_t* getData() { return data_; }
 
+  /** @brief The value of a column whose voxels are all unknown, as reset() leaves them */
+  uint32_t getUnknownColumn() const { return ~((uint32_t)0)>>16; }
+
   inline void markVoxel(unsigned int x, unsigned int y, unsigned int z)
   {
     if (x >= size_x_ || y >= size_y_ || z >= size_z_)
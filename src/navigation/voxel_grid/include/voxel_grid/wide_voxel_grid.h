@@ -0,0 +1,431 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the Willow Garage nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+#ifndef VOXEL_GRID_WIDE_VOXEL_GRID_H
+#define VOXEL_GRID_WIDE_VOXEL_GRID_H
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+#include <limits.h>
+#include <algorithm>
+#include <ros/console.h>
+#include <ros/assert.h>
+#include <voxel_grid/voxel_grid.h>
+
+namespace voxel_grid
+{
+
+/**
+ * @class WideVoxelGrid
+ * @brief A VoxelGrid with 64 bit columns, giving a limit of 32 vertical cells.
+ *        The low 32 bits of a column hold the voxels that are unknown or
+ *        marked and the high 32 bits the voxels that are marked. Unlike
+ *        VoxelGrid, only the size_z levels of a column start out unknown.
+ *
+ * Steps of a mostly vertical line that stay within one column are applied
+ * to that column with a single mask, so those lines clear several z levels
+ * per column update.
+ */
+class WideVoxelGrid
+{
+public:
+  static const unsigned int MAX_SIZE_Z = 32;
+
+  /**
+   * @brief  Constructor for a voxel grid
+   * @param size_x The x size of the grid
+   * @param size_y The y size of the grid
+   * @param size_z The z size of the grid, only sizes <= 32 are supported
+   */
+  WideVoxelGrid(unsigned int size_x, unsigned int size_y, unsigned int size_z);
+
+  ~WideVoxelGrid();
+
+  /**
+   * @brief  Resizes a voxel grid to the desired size
+   * @param size_x The x size of the grid
+   * @param size_y The y size of the grid
+   * @param size_z The z size of the grid, only sizes <= 32 are supported
+   */
+  void resize(unsigned int size_x, unsigned int size_y, unsigned int size_z);
+
+  void reset();
+  uint64_t* getData() { return data_; }
+
+  /** @brief The value of a column whose voxels are all unknown, as reset() leaves them */
+  uint64_t getUnknownColumn() const { return size_z_ ? ~((uint64_t)0)>>(64 - size_z_) : 0; }
+
+  inline void markVoxel(unsigned int x, unsigned int y, unsigned int z)
+  {
+    if (x >= size_x_ || y >= size_y_ || z >= size_z_)
+    {
+      ROS_DEBUG("Error, voxel out of bounds.\n");
+      return;
+    }
+    data_[y * size_x_ + x] |= fullMask(z); //clear unknown and mark cell
+  }
+
+  inline bool markVoxelInMap(unsigned int x, unsigned int y, unsigned int z, unsigned int marked_threshold)
+  {
+    if (x >= size_x_ || y >= size_y_ || z >= size_z_)
+    {
+      ROS_DEBUG("Error, voxel out of bounds.\n");
+      return false;
+    }
+
+    uint64_t* col = &data_[y * size_x_ + x];
+    *col |= fullMask(z); //clear unknown and mark cell
+
+    //make sure the number of bits in each is below our thesholds
+    return !bitsBelowThreshold(markedBits(*col), marked_threshold);
+  }
+
+  inline void clearVoxel(unsigned int x, unsigned int y, unsigned int z)
+  {
+    if (x >= size_x_ || y >= size_y_ || z >= size_z_)
+    {
+      ROS_DEBUG("Error, voxel out of bounds.\n");
+      return;
+    }
+    data_[y * size_x_ + x] &= ~(fullMask(z)); //clear unknown and clear cell
+  }
+
+  inline void clearVoxelColumn(unsigned int index)
+  {
+    ROS_ASSERT(index < size_x_ * size_y_);
+    data_[index] = 0;
+  }
+
+  static inline bool bitsBelowThreshold(uint32_t n, unsigned int bit_threshold)
+  {
+    unsigned int bit_count;
+    for (bit_count = 0; n;)
+    {
+      ++bit_count;
+      if (bit_count > bit_threshold)
+      {
+        return false;
+      }
+      n &= n - 1; //clear the least significant bit set
+    }
+    return true;
+  }
+
+  static inline uint64_t fullMask(unsigned int z)
+  {
+    return ((uint64_t)1 << z << 32) | ((uint64_t)1 << z);
+  }
+
+  static inline uint32_t unknownBits(uint64_t col)
+  {
+    return uint32_t(col >> 32) ^ uint32_t(col);
+  }
+
+  static inline uint32_t markedBits(uint64_t col)
+  {
+    return uint32_t(col >> 32);
+  }
+
+  static VoxelStatus getVoxel(
+    unsigned int x, unsigned int y, unsigned int z,
+    unsigned int size_x, unsigned int size_y, unsigned int size_z, const uint64_t* data)
+  {
+    if (x >= size_x || y >= size_y || z >= size_z)
+    {
+      ROS_DEBUG("Error, voxel out of bounds. (%d, %d, %d)\n", x, y, z);
+      return UNKNOWN;
+    }
+    uint64_t result = data[y * size_x + x] & fullMask(z);
+
+    // known marked: 11, unknown: 01, known free: 00
+    if (result >> 32)
+      return MARKED;
+    if (result)
+      return UNKNOWN;
+    return FREE;
+  }
+
+  /**
+   * @brief  Converts a column to the layout of VoxelGrid, dropping the levels above 16
+   */
+  static inline uint32_t toNarrowColumn(uint64_t col)
+  {
+    return ((uint32_t)(col >> 32) << 16) | (uint32_t)(col & 0xffff);
+  }
+
+  void markVoxelLine(double x0, double y0, double z0, double x1, double y1, double z1, unsigned int max_length = UINT_MAX);
+  void clearVoxelLine(double x0, double y0, double z0, double x1, double y1, double z1, unsigned int max_length = UINT_MAX);
+  void clearVoxelLineInMap(double x0, double y0, double z0, double x1, double y1, double z1, unsigned char *map_2d,
+                           unsigned int unknown_threshold, unsigned int mark_threshold,
+                           unsigned char free_cost = 0, unsigned char unknown_cost = 255, unsigned int max_length = UINT_MAX);
+
+  VoxelStatus getVoxel(unsigned int x, unsigned int y, unsigned int z);
+
+  //Are there any obstacles at that (x, y) location in the grid?
+  VoxelStatus getVoxelColumn(unsigned int x, unsigned int y,
+                             unsigned int unknown_threshold = 0, unsigned int marked_threshold = 0);
+
+  void printVoxelGrid();
+  void printColumnGrid();
+  unsigned int sizeX();
+  unsigned int sizeY();
+  unsigned int sizeZ();
+
+  template <class ActionType>
+  inline void raytraceLine(
+    ActionType at, double x0, double y0, double z0,
+    double x1, double y1, double z1, unsigned int max_length = UINT_MAX)
+  {
+    int dx = int(x1) - int(x0);
+    int dy = int(y1) - int(y0);
+    int dz = int(z1) - int(z0);
+
+    unsigned int abs_dx = abs(dx);
+    unsigned int abs_dy = abs(dy);
+    unsigned int abs_dz = abs(dz);
+
+    int offset_dx = sign(dx);
+    int offset_dy = sign(dy) * size_x_;
+    int offset_dz = sign(dz);
+
+    uint64_t z_mask = fullMask((unsigned int)z0);
+    unsigned int offset = (unsigned int)y0 * size_x_ + (unsigned int)x0;
+
+    GridOffset grid_off(offset);
+    ZOffset z_off(z_mask);
+
+    //we need to chose how much to scale our dominant dimension, based on the maximum length of the line
+    double dist = sqrt((x0 - x1) * (x0 - x1) + (y0 - y1) * (y0 - y1) + (z0 - z1) * (z0 - z1));
+    double scale = std::min(1.0,  max_length / dist);
+
+    //is x dominant
+    if (abs_dx >= std::max(abs_dy, abs_dz))
+    {
+      int error_y = abs_dx / 2;
+      int error_z = abs_dx / 2;
+
+      bresenham3D(at, grid_off, grid_off, z_off, abs_dx, abs_dy, abs_dz, error_y, error_z, offset_dx, offset_dy, offset_dz, offset, z_mask, (unsigned int)(scale * abs_dx));
+      return;
+    }
+
+    //y is dominant
+    if (abs_dy >= abs_dz)
+    {
+      int error_x = abs_dy / 2;
+      int error_z = abs_dy / 2;
+
+      bresenham3D(at, grid_off, grid_off, z_off, abs_dy, abs_dx, abs_dz, error_x, error_z, offset_dy, offset_dx, offset_dz, offset, z_mask, (unsigned int)(scale * abs_dy));
+      return;
+    }
+
+    //otherwise, z is dominant and consecutive steps share a column
+    int error_x = abs_dz / 2;
+    int error_y = abs_dz / 2;
+
+    bresenham3DVertical(at, abs_dz, abs_dx, abs_dy, error_x, error_y, offset_dz, offset_dx, offset_dy, offset, z_mask, (unsigned int)(scale * abs_dz));
+  }
+
+private:
+  //3D bresenham implementation that moves to a new column on every step
+  template <class ActionType, class OffA, class OffB, class OffC>
+  inline void bresenham3D(
+    ActionType at, OffA off_a, OffB off_b, OffC off_c,
+    unsigned int abs_da, unsigned int abs_db, unsigned int abs_dc,
+    int error_b, int error_c, int offset_a, int offset_b, int offset_c, unsigned int &offset,
+    uint64_t &z_mask, unsigned int max_length = UINT_MAX)
+  {
+    unsigned int end = std::min(max_length, abs_da);
+    for (unsigned int i = 0; i < end; ++i)
+    {
+      at(offset, z_mask);
+      off_a(offset_a);
+      error_b += abs_db;
+      error_c += abs_dc;
+      if ((unsigned int)error_b >= abs_da)
+      {
+        off_b(offset_b);
+        error_b -= abs_da;
+      }
+      if ((unsigned int)error_c >= abs_da)
+      {
+        off_c(offset_c);
+        error_c -= abs_da;
+      }
+    }
+    at(offset, z_mask);
+  }
+
+  //3D bresenham for z dominant lines, collects the voxels of a column in one mask and applies them when the line leaves it
+  template <class ActionType>
+  inline void bresenham3DVertical(
+    ActionType at, unsigned int abs_dz, unsigned int abs_dx, unsigned int abs_dy,
+    int error_x, int error_y, int offset_dz, int offset_dx, int offset_dy, unsigned int offset,
+    uint64_t z_mask, unsigned int max_length = UINT_MAX)
+  {
+    unsigned int end = std::min(max_length, abs_dz);
+    uint64_t column_mask = 0;
+    for (unsigned int i = 0; i < end; ++i)
+    {
+      column_mask |= z_mask;
+      offset_dz > 0 ? z_mask <<= 1 : z_mask >>= 1;
+      error_x += abs_dx;
+      error_y += abs_dy;
+      bool moved = false;
+      if ((unsigned int)error_x >= abs_dz)
+      {
+        at(offset, column_mask);
+        offset += offset_dx;
+        error_x -= abs_dz;
+        column_mask = 0;
+        moved = true;
+      }
+      if ((unsigned int)error_y >= abs_dz)
+      {
+        if (!moved)
+        {
+          at(offset, column_mask);
+          column_mask = 0;
+        }
+        offset += offset_dy;
+        error_y -= abs_dz;
+      }
+    }
+    at(offset, column_mask | z_mask);
+  }
+
+  inline int sign(int i)
+  {
+    return i > 0 ? 1 : -1;
+  }
+
+  unsigned int size_x_, size_y_, size_z_;
+  uint64_t *data_;
+
+  class MarkVoxel
+  {
+  public:
+    MarkVoxel(uint64_t* data): data_(data){}
+    inline void operator()(unsigned int offset, uint64_t z_mask)
+    {
+      data_[offset] |= z_mask; //clear unknown and mark cells
+    }
+  private:
+    uint64_t* data_;
+  };
+
+  class ClearVoxel
+  {
+  public:
+    ClearVoxel(uint64_t* data): data_(data){}
+    inline void operator()(unsigned int offset, uint64_t z_mask)
+    {
+      data_[offset] &= ~(z_mask); //clear unknown and clear cells
+    }
+  private:
+    uint64_t* data_;
+  };
+
+  /**
+   * Same as VoxelGrid::ClearVoxelInMap. Clearing several bits of a column at
+   * once leaves the costmap as clearing them one by one would, since the
+   * column only loses bits and the last evaluation is the one that counts.
+   */
+  class ClearVoxelInMap
+  {
+  public:
+    ClearVoxelInMap(
+      uint64_t* data, unsigned char *costmap,
+      unsigned int unknown_clear_threshold, unsigned int marked_clear_threshold,
+      unsigned char free_cost = 0, unsigned char unknown_cost = 255): data_(data), costmap_(costmap),
+      unknown_clear_threshold_(unknown_clear_threshold), marked_clear_threshold_(marked_clear_threshold),
+      free_cost_(free_cost), unknown_cost_(unknown_cost)
+    {
+    }
+
+    inline void operator()(unsigned int offset, uint64_t z_mask)
+    {
+      uint64_t* col = &data_[offset];
+      *col &= ~(z_mask); //clear unknown and clear cells
+
+      //make sure the number of bits in each is below our thesholds
+      if (bitsBelowThreshold(markedBits(*col), marked_clear_threshold_))
+      {
+        if (bitsBelowThreshold(unknownBits(*col), unknown_clear_threshold_))
+        {
+          costmap_[offset] = free_cost_;
+        }
+        else
+        {
+          costmap_[offset] = unknown_cost_;
+        }
+      }
+    }
+  private:
+    uint64_t* data_;
+    unsigned char *costmap_;
+    unsigned int unknown_clear_threshold_, marked_clear_threshold_;
+    unsigned char free_cost_, unknown_cost_;
+  };
+
+  class GridOffset
+  {
+  public:
+    GridOffset(unsigned int &offset) : offset_(offset) {}
+    inline void operator()(int offset_val)
+    {
+      offset_ += offset_val;
+    }
+  private:
+    unsigned int &offset_;
+  };
+
+  class ZOffset
+  {
+  public:
+    ZOffset(uint64_t &z_mask) : z_mask_(z_mask) {}
+    inline void operator()(int offset_val)
+    {
+      offset_val > 0 ? z_mask_ <<= 1 : z_mask_ >>= 1;
+    }
+  private:
+    uint64_t & z_mask_;
+  };
+};
+
+}  // namespace voxel_grid
+
+#endif  // VOXEL_GRID_WIDE_VOXEL_GRID_H
@@ -92,7 +92,7 @@ namespace voxel_grid {
   }
 
   void VoxelGrid::reset(){
-    uint32_t unknown_col = ~((uint32_t)0)>>16;
+    uint32_t unknown_col = getUnknownColumn();
     uint32_t* col = data_;
     for(unsigned int i = 0; i < size_x_ * size_y_; ++i){
       *col = unknown_col;
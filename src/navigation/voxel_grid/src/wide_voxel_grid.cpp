@@ -0,0 +1,186 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2008, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+* Author: Eitan Marder-Eppstein
+*********************************************************************/
+#include <voxel_grid/wide_voxel_grid.h>
+#include <ros/console.h>
+
+namespace voxel_grid {
+  WideVoxelGrid::WideVoxelGrid(unsigned int size_x, unsigned int size_y, unsigned int size_z)
+  {
+    size_x_ = size_x; 
+    size_y_ = size_y; 
+    size_z_ = size_z; 
+
+    if(size_z_ > MAX_SIZE_Z){
+      ROS_INFO("Error, this implementation can only support up to %u z values (%d)", MAX_SIZE_Z, size_z_); 
+      size_z_ = MAX_SIZE_Z;
+    }
+
+    data_ = new uint64_t[size_x_ * size_y_];
+    reset();
+  }
+
+  void WideVoxelGrid::resize(unsigned int size_x, unsigned int size_y, unsigned int size_z)
+  {
+    //if we're not actually changing the size, we can just reset things
+    if(size_x == size_x_ && size_y == size_y_ && size_z == size_z_){
+      reset();
+      return;
+    }
+
+    delete[] data_;
+    size_x_ = size_x; 
+    size_y_ = size_y; 
+    size_z_ = size_z; 
+
+    if(size_z_ > MAX_SIZE_Z){
+      ROS_INFO("Error, this implementation can only support up to %u z values (%d)", MAX_SIZE_Z, size_z); 
+      size_z_ = MAX_SIZE_Z;
+    }
+
+    data_ = new uint64_t[size_x_ * size_y_];
+    reset();
+  }
+
+  WideVoxelGrid::~WideVoxelGrid()
+  {
+    delete [] data_;
+  }
+
+  void WideVoxelGrid::reset(){
+    //only the levels that exist start out unknown, so thresholds on unknown cells need no offset
+    std::fill(data_, data_ + size_x_ * size_y_, getUnknownColumn());
+  }
+
+  void WideVoxelGrid::markVoxelLine(double x0, double y0, double z0, double x1, double y1, double z1, unsigned int max_length){
+    if(x0 >= size_x_ || y0 >= size_y_ || z0 >= size_z_ || x1>=size_x_ || y1>=size_y_ || z1>=size_z_){
+      ROS_DEBUG("Error, line endpoint out of bounds. (%.2f, %.2f, %.2f) to (%.2f, %.2f, %.2f),  size: (%d, %d, %d)", x0, y0, z0, x1, y1, z1, 
+          size_x_, size_y_, size_z_);
+      return;
+    }
+
+    MarkVoxel mv(data_);
+    raytraceLine(mv, x0, y0, z0, x1, y1, z1, max_length);
+  }
+
+  void WideVoxelGrid::clearVoxelLine(double x0, double y0, double z0, double x1, double y1, double z1, unsigned int max_length){
+    if(x0 >= size_x_ || y0 >= size_y_ || z0 >= size_z_ || x1>=size_x_ || y1>=size_y_ || z1>=size_z_){
+      ROS_DEBUG("Error, line endpoint out of bounds. (%.2f, %.2f, %.2f) to (%.2f, %.2f, %.2f),  size: (%d, %d, %d)", x0, y0, z0, x1, y1, z1, 
+          size_x_, size_y_, size_z_);
+      return;
+    }
+
+    ClearVoxel cv(data_);
+    raytraceLine(cv, x0, y0, z0, x1, y1, z1, max_length);
+  }
+
+  void WideVoxelGrid::clearVoxelLineInMap(double x0, double y0, double z0, double x1, double y1, double z1, unsigned char *map_2d, 
+      unsigned int unknown_threshold, unsigned int mark_threshold, unsigned char free_cost, unsigned char unknown_cost, unsigned int max_length){
+    if(map_2d == NULL){
+      clearVoxelLine(x0, y0, z0, x1, y1, z1, max_length);
+      return;
+    }
+
+    if(x0 >= size_x_ || y0 >= size_y_ || z0 >= size_z_ || x1>=size_x_ || y1>=size_y_ || z1>=size_z_){
+      ROS_DEBUG("Error, line endpoint out of bounds. (%.2f, %.2f, %.2f) to (%.2f, %.2f, %.2f),  size: (%d, %d, %d)", x0, y0, z0, x1, y1, z1, 
+          size_x_, size_y_, size_z_);
+      return;
+    }
+
+    ClearVoxelInMap cvm(data_, map_2d, unknown_threshold, mark_threshold, free_cost, unknown_cost);
+    raytraceLine(cvm, x0, y0, z0, x1, y1, z1, max_length);
+  }
+
+  VoxelStatus WideVoxelGrid::getVoxel(unsigned int x, unsigned int y, unsigned int z)
+  {
+    return getVoxel(x, y, z, size_x_, size_y_, size_z_, data_);
+  }
+
+  VoxelStatus WideVoxelGrid::getVoxelColumn(unsigned int x, unsigned int y, unsigned int unknown_threshold, unsigned int marked_threshold)
+  {
+    if(x >= size_x_ || y >= size_y_){
+      ROS_DEBUG("Error, voxel out of bounds. (%d, %d)\n", x, y);
+      return UNKNOWN;
+    }
+    
+    uint64_t col = data_[y * size_x_ + x];
+
+    //check if the number of marked bits qualifies the col as marked
+    if(!bitsBelowThreshold(markedBits(col), marked_threshold)){
+      return MARKED;
+    }
+
+    //check if the number of unkown bits qualifies the col as unknown
+    if(!bitsBelowThreshold(unknownBits(col), unknown_threshold))
+      return UNKNOWN;
+
+    return FREE;
+  }
+
+  unsigned int WideVoxelGrid::sizeX(){
+    return size_x_;
+  }
+
+  unsigned int WideVoxelGrid::sizeY(){
+    return size_y_;
+  }
+
+  unsigned int WideVoxelGrid::sizeZ(){
+    return size_z_;
+  }
+
+  void WideVoxelGrid::printVoxelGrid(){
+    for(unsigned int z = 0; z < size_z_; z++){
+      printf("Layer z = %u:\n",z);
+      for(unsigned int y = 0; y < size_y_; y++){
+        for(unsigned int x = 0 ; x < size_x_; x++){
+          printf((getVoxel(x, y, z)) == voxel_grid::MARKED? "#" : " ");
+        }
+        printf("|\n");
+      } 
+    }
+  }
+
+  void WideVoxelGrid::printColumnGrid(){
+    printf("Column view:\n");
+    for(unsigned int y = 0; y < size_y_; y++){
+      for(unsigned int x = 0 ; x < size_x_; x++){
+        printf((getVoxelColumn(x, y, MAX_SIZE_Z, 0) == voxel_grid::MARKED)? "#" : " ");
+      }
+      printf("|\n");
+    } 
+  }
+};
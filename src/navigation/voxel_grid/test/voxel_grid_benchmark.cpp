@@ -0,0 +1,113 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2009, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of Willow Garage, Inc. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+#include <voxel_grid/voxel_grid.h>
+#include <voxel_grid/wide_voxel_grid.h>
+#include <ros/ros.h>
+#include <vector>
+
+/**
+ * Measures clearVoxelLineInMap throughput of VoxelGrid and WideVoxelGrid
+ * for the rays of a laser scanning the horizon and of a depth camera
+ * looking at the floor in front of the robot.
+ */
+
+struct Ray
+{
+  double x0, y0, z0, x1, y1, z1;
+};
+
+static void scanRays(std::vector<Ray>& rays, unsigned int size_x, unsigned int size_y, unsigned int size_z, bool steep)
+{
+  double cx = size_x / 2.0, cy = size_y / 2.0, cz = steep ? size_z - 0.5 : size_z / 2.0;
+  for (unsigned int i = 0; i < 640 * 48; ++i)
+  {
+    double angle = (i % 640) * 2.0 * M_PI / 640;
+    double range = steep ? 2.0 + (i % 7) : cx - 1.0 - (i % 13);
+    Ray r;
+    r.x0 = cx;
+    r.y0 = cy;
+    r.z0 = cz;
+    r.x1 = cx + range * cos(angle);
+    r.y1 = cy + range * sin(angle);
+    r.z1 = steep ? 0.5 : cz + (i % 48) / 48.0 * (size_z / 2.0 - 1.0);
+    rays.push_back(r);
+  }
+}
+
+template <class Grid>
+static double clearRays(Grid& grid, const std::vector<Ray>& rays, std::vector<unsigned char>& costmap, int repetitions)
+{
+  ros::WallTime start = ros::WallTime::now();
+  for (int k = 0; k < repetitions; ++k)
+  {
+    for (unsigned int i = 0; i < rays.size(); ++i)
+    {
+      const Ray& r = rays[i];
+      grid.clearVoxelLineInMap(r.x0, r.y0, r.z0, r.x1, r.y1, r.z1, &costmap[0], 0, 0);
+    }
+  }
+  return (ros::WallTime::now() - start).toSec();
+}
+
+int main(int argc, char** argv)
+{
+  unsigned int size_x = 200, size_y = 200;
+  int repetitions = 20;
+  const char* names[] = { "horizontal", "steep" };
+
+  for (int steep = 0; steep < 2; ++steep)
+  {
+    std::vector<unsigned char> costmap(size_x * size_y, 254);
+    std::vector<Ray> rays;
+    scanRays(rays, size_x, size_y, 16, steep);
+
+    voxel_grid::VoxelGrid narrow(size_x, size_y, 16);
+    voxel_grid::WideVoxelGrid wide(size_x, size_y, 16);
+    double narrow_time = clearRays(narrow, rays, costmap, repetitions);
+    double wide_time = clearRays(wide, rays, costmap, repetitions);
+
+    double num_rays = double(rays.size()) * repetitions;
+    printf("%s rays, 16 levels: VoxelGrid %.2f Mrays/s, WideVoxelGrid %.2f Mrays/s\n", names[steep],
+           num_rays / narrow_time / 1e6, num_rays / wide_time / 1e6);
+
+    rays.clear();
+    scanRays(rays, size_x, size_y, 32, steep);
+    voxel_grid::WideVoxelGrid tall(size_x, size_y, 32);
+    double tall_time = clearRays(tall, rays, costmap, repetitions);
+    printf("%s rays, 32 levels: WideVoxelGrid %.2f Mrays/s\n", names[steep], num_rays / tall_time / 1e6);
+  }
+
+  return 0;
+}
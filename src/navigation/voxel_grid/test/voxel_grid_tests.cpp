@@ -35,7 +35,9 @@
 * Author: Eitan Marder-Eppstein
 *********************************************************************/
 #include <voxel_grid/voxel_grid.h>
+#include <voxel_grid/wide_voxel_grid.h>
 #include <gtest/gtest.h>
+#include <vector>
 
 TEST(voxel_grid, basicMarkingAndClearing){
   int size_x = 50, size_y = 10, size_z = 16;
@@ -140,6 +142,66 @@ TEST(voxel_grid, basicMarkingAndClearing){
      */
 }
 
+TEST(voxel_grid, wideGridSupportsTallColumns){
+  voxel_grid::WideVoxelGrid vg(10, 10, 32);
+  ASSERT_EQ(vg.sizeZ(), 32u);
+
+  for(unsigned int i = 0; i < vg.sizeZ(); ++i){
+    ASSERT_EQ(vg.getVoxel(3, 4, i), voxel_grid::UNKNOWN);
+    vg.markVoxel(3, 4, i);
+    ASSERT_EQ(vg.getVoxel(3, 4, i), voxel_grid::MARKED);
+  }
+  ASSERT_EQ(vg.getVoxelColumn(3, 4, 0, 31), voxel_grid::MARKED);
+
+  //a vertical ray touches a single column and clears all of it at once
+  unsigned char costmap[100];
+  memset(costmap, 254, sizeof(costmap));
+  vg.clearVoxelLineInMap(3, 4, 0, 3, 4, vg.sizeZ() - 1, costmap, 0, 0);
+
+  for(unsigned int i = 0; i < vg.sizeZ() - 1; ++i){
+    ASSERT_EQ(vg.getVoxel(3, 4, i), voxel_grid::FREE);
+  }
+  //the end point itself is cleared too
+  ASSERT_EQ(vg.getVoxel(3, 4, vg.sizeZ() - 1), voxel_grid::FREE);
+  ASSERT_EQ(costmap[4 * 10 + 3], 0);
+}
+
+TEST(voxel_grid, wideGridMatchesNarrowGrid){
+  unsigned int size_x = 40, size_y = 30, size_z = 16;
+  voxel_grid::VoxelGrid narrow(size_x, size_y, size_z);
+  voxel_grid::WideVoxelGrid wide(size_x, size_y, size_z);
+  std::vector<unsigned char> narrow_map(size_x * size_y, 254), wide_map(size_x * size_y, 254);
+
+  srand(7);
+  for(unsigned int i = 0; i < 500; ++i){
+    unsigned int x = rand() % size_x, y = rand() % size_y, z = rand() % size_z;
+    narrow.markVoxel(x, y, z);
+    wide.markVoxel(x, y, z);
+  }
+
+  for(unsigned int i = 0; i < 2000; ++i){
+    double x0 = (rand() % (size_x * 10)) / 10.0, y0 = (rand() % (size_y * 10)) / 10.0, z0 = (rand() % (size_z * 10)) / 10.0;
+    double x1 = (rand() % (size_x * 10)) / 10.0, y1 = (rand() % (size_y * 10)) / 10.0, z1 = (rand() % (size_z * 10)) / 10.0;
+    //make every other line mostly vertical
+    if(i % 2){
+      x1 = std::min(std::max(x0 + (rand() % 9) - 4.0, 0.0), size_x - 0.5);
+      y1 = std::min(std::max(y0 + (rand() % 9) - 4.0, 0.0), size_y - 0.5);
+    }
+    narrow.clearVoxelLineInMap(x0, y0, z0, x1, y1, z1, &narrow_map[0], 2, 0, 0, 255, 25);
+    wide.clearVoxelLineInMap(x0, y0, z0, x1, y1, z1, &wide_map[0], 2, 0, 0, 255, 25);
+  }
+
+  for(unsigned int j = 0; j < size_y; ++j){
+    for(unsigned int i = 0; i < size_x; ++i){
+      ASSERT_EQ(narrow_map[j * size_x + i], wide_map[j * size_x + i]);
+      ASSERT_EQ(voxel_grid::WideVoxelGrid::toNarrowColumn(wide.getData()[j * size_x + i]), narrow.getData()[j * size_x + i]);
+      for(unsigned int k = 0; k < size_z; ++k){
+        ASSERT_EQ(narrow.getVoxel(i, j, k), wide.getVoxel(i, j, k));
+      }
+    }
+  }
+}
+
 int main(int argc, char** argv){
   testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();